@@ -26,6 +26,7 @@
 #define TIM_LITE_EXECUTION_H_
 
 #include <cstdint>
+#include <string>
 #include <vector>
 #include <memory>
 #include "tim/lite/handle.h"
@@ -35,8 +36,17 @@ namespace lite {
 
 class Execution {
  public:
+  /// Hand executable to the driver without copying it. The driver may patch
+  /// the binary in place, executable has to be writable and stay valid until
+  /// the network is prepared, which is done when Create returns
+  static std::shared_ptr<Execution> Create(void* executable,
+                                           size_t executable_size);
+  /// Fallback for read-only memory, executable is copied for the driver and
+  /// only has to stay valid until Create returns
   static std::shared_ptr<Execution> Create(const void* executable,
                                            size_t executable_size);
+  /// Map the executable file copy-on-write instead of reading it into memory
+  static std::shared_ptr<Execution> Create(const std::string& path);
   virtual std::shared_ptr<Handle> CreateInputHandle(uint32_t in_idx,
                                                     uint8_t* buffer,
                                                     size_t size) = 0;
@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_CONSTANT_FOLDING_H_
+#define TIM_CONSTANT_FOLDING_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace tim {
+
+namespace vx {
+    class Context;
+    class Graph;
+    class Tensor;
+}
+
+namespace transform {
+
+struct ConstantFoldingStats {
+  /// Ops evaluated on the host and removed from the graph
+  uint32_t folded_ops{0};
+  /// Constants created for folded results consumed by the remaining ops
+  uint32_t constants{0};
+};
+
+/**
+ * @brief Evaluate ops whose inputs are all constant once on the host
+ *
+ * Rebuilds `src_graph` with Reshape, Squeeze, Transpose, Concat,
+ * DataConvert and elementwise Add/Sub/Mul/Div/Maximum/Minimum on constant
+ * inputs, or on results folded before them, replaced by CONSTANT tensors
+ * holding their results. Ops producing a graph output, and types the host
+ * implementation doesn't cover, are kept.
+ *
+ * @return folded graph and the mapping from inputs/outputs of `src_graph`
+ * to its own, or nullptr if `src_graph` has a cycle
+ */
+std::pair<
+    /*folded graph*/
+    std::shared_ptr<vx::Graph>,
+    /* tensor mapping between original graph and folded graph*/
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+ConstantFolding(const std::shared_ptr<vx::Graph>& src_graph,
+                std::shared_ptr<vx::Context>& ctx,
+                ConstantFoldingStats* stats = nullptr);
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
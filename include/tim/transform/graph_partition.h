@@ -0,0 +1,86 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_GRAPH_PARTITION_H_
+#define TIM_GRAPH_PARTITION_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tim {
+
+namespace vx {
+    class Context;
+    class Graph;
+    class Tensor;
+}
+
+namespace transform {
+
+/// One stage of a partitioned graph
+struct GraphPartition {
+  std::shared_ptr<vx::Graph> graph;
+  /// Tensors of the source graph this stage reads, `src_inputs[i]` is fed
+  /// through `graph->InputsTensor()[i]`
+  std::vector<std::shared_ptr<vx::Tensor>> src_inputs;
+  /// Tensors of the source graph this stage produces for later stages or as
+  /// graph output, `src_outputs[i]` is `graph->OutputsTensor()[i]`
+  std::vector<std::shared_ptr<vx::Tensor>> src_outputs;
+};
+
+/**
+ * @brief Split a graph into stages at the given tensors
+ *
+ * Ops producing the tensors of `boundaries[i]` and everything they depend on
+ * go to a stage before the ops consuming them, so stage i + 1 starts after
+ * the tensors of `boundaries[i]`. A tensor crossing stages becomes an OUTPUT
+ * of its producing stage and an INPUT of every stage reading it. Stage i is
+ * built in `contexts[i % contexts.size()]`, constants share the source's data.
+ *
+ * @return non-empty stages in execution order, or an empty vector if
+ * `src_graph` has a cycle
+ */
+std::vector<GraphPartition> PartitionGraph(
+    const std::shared_ptr<vx::Graph>& src_graph,
+    const std::vector<std::vector<std::shared_ptr<vx::Tensor>>>& boundaries,
+    const std::vector<std::shared_ptr<vx::Context>>& contexts);
+
+/**
+ * @brief Split a graph into `stage_count` stages of similar cost
+ *
+ * Ops are cut in topological order where the running cost estimate crosses
+ * multiples of total / stage_count. The estimate of an op is the number of
+ * its output elements, scaled by the weights per output channel for ops with
+ * a constant weight.
+ *
+ * @return same as PartitionGraph above
+ */
+std::vector<GraphPartition> PartitionGraphByCost(
+    const std::shared_ptr<vx::Graph>& src_graph, uint32_t stage_count,
+    const std::vector<std::shared_ptr<vx::Context>>& contexts);
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
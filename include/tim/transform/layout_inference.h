@@ -25,6 +25,7 @@
 #define TIM_LAYOUT_INFERENCE_H_
 
 #include <map>
+#include <memory>
 #include <vector>
 
 
@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_OP_ELIMINATION_H_
+#define TIM_OP_ELIMINATION_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace tim {
+
+namespace vx {
+    class Context;
+    class Graph;
+    class Tensor;
+}
+
+namespace transform {
+
+/**
+ * @brief Drop ops whose results never reach a graph output
+ *
+ * @param removed_ops number of ops dropped, optional
+ * @return rebuilt graph and the mapping from inputs/outputs of `src_graph`
+ * to its own, or nullptr if `src_graph` has a cycle
+ */
+std::pair<
+    /*rebuilt graph*/
+    std::shared_ptr<vx::Graph>,
+    /* tensor mapping between original graph and rebuilt graph*/
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+DeadOpElimination(const std::shared_ptr<vx::Graph>& src_graph,
+                  std::shared_ptr<vx::Context>& ctx,
+                  uint32_t* removed_ops = nullptr);
+
+/**
+ * @brief Compute ops of the same kind, parameters and inputs only once
+ *
+ * An op is identical to an earlier one if it has the same kind, creation
+ * parameters, inputs and output specs. Its consumers read the outputs of the
+ * earlier op instead. Ops writing a graph output are kept.
+ *
+ * @param removed_ops number of ops dropped, optional
+ * @return rebuilt graph and the mapping from inputs/outputs of `src_graph`
+ * to its own, or nullptr if `src_graph` has a cycle
+ */
+std::pair<
+    /*rebuilt graph*/
+    std::shared_ptr<vx::Graph>,
+    /* tensor mapping between original graph and rebuilt graph*/
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+CommonSubexpressionElimination(const std::shared_ptr<vx::Graph>& src_graph,
+                               std::shared_ptr<vx::Context>& ctx,
+                               uint32_t* removed_ops = nullptr);
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
@@ -0,0 +1,68 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_PATTERN_FUSION_H_
+#define TIM_PATTERN_FUSION_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace tim {
+
+namespace vx {
+    class Context;
+    class Graph;
+    class Tensor;
+}
+
+namespace transform {
+
+/**
+ * @brief Fuse decomposed subgraphs into fused ops
+ *
+ * Rebuilds `src_graph` with the op sequences exporters such as ONNX emit for
+ * GELU (erf and tanh forms), LayerNorm, RMSNorm, SiLU, HardSwish and softmax
+ * replaced by Gelu, LayerNormalization, RMSNormalization, Swish, HardSwish and
+ * Softmax. A subgraph is only fused if nothing outside of it reads its
+ * intermediate results.
+ *
+ * @param fused_count if not null, receives the number of fused subgraphs per
+ * fusion rule
+ * @return fused graph and the mapping from inputs/outputs of `src_graph` to
+ * its own, or nullptr if `src_graph` has a cycle
+ */
+std::pair<
+    /*fused graph*/
+    std::shared_ptr<vx::Graph>,
+    /* tensor mapping between original graph and fused graph*/
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+PatternFusion(const std::shared_ptr<vx::Graph>& src_graph,
+              std::shared_ptr<vx::Context>& ctx,
+              std::map<std::string, uint32_t>* fused_count = nullptr);
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
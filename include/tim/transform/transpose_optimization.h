@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_TRANSPOSE_OPTIMIZATION_H_
+#define TIM_TRANSPOSE_OPTIMIZATION_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace tim {
+
+namespace vx {
+    class Context;
+    class Graph;
+    class Tensor;
+}
+
+namespace transform {
+
+struct TransposeOptimizationStats {
+  /// Transpose ops in the source graph
+  uint32_t transposes_before{0};
+  /// Transpose ops in the optimized graph
+  uint32_t transposes_after{0};
+  /// Layout agnostic ops a pending transpose was pushed through
+  uint32_t sunk_ops{0};
+
+  uint32_t Removed() const {
+    return transposes_before > transposes_after
+               ? transposes_before - transposes_after
+               : 0;
+  }
+};
+
+/**
+ * @brief Clean up transposes left by LayoutInference
+ *
+ * Rebuilds `src_graph` with back-to-back transposes composed into one,
+ * identity transposes dropped and transposes pushed through layout agnostic
+ * elementwise ops toward graph outputs, where they meet the next transpose or
+ * the output itself.
+ *
+ * @return optimized graph and the mapping from inputs/outputs of `src_graph`
+ * to its own, or nullptr if `src_graph` has a cycle
+ */
+std::pair<
+    /*optimized graph*/
+    std::shared_ptr<vx::Graph>,
+    /* tensor mapping between original graph and optimized graph*/
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+TransposeOptimization(const std::shared_ptr<vx::Graph>& src_graph,
+                      std::shared_ptr<vx::Context>& ctx,
+                      TransposeOptimizationStats* stats = nullptr);
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_WEIGHT_FOLDING_H_
+#define TIM_WEIGHT_FOLDING_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace tim {
+
+namespace vx {
+    class Context;
+    class Graph;
+    class Tensor;
+}
+
+namespace transform {
+
+struct WeightFoldingStats {
+  /// BatchNorm ops folded away
+  uint32_t batchnorms{0};
+  /// Mul, Div, Add and Sub ops with a per channel constant folded away
+  uint32_t elementwise{0};
+
+  uint32_t Removed() const { return batchnorms + elementwise; }
+};
+
+/**
+ * @brief Fold per channel affine ops into the weights before them
+ *
+ * Rebuilds `src_graph` with BatchNorm and Mul/Div/Add/Sub by a per channel
+ * or scalar constant that follow Conv2d, GroupedConv2d, DeConv2d or
+ * FullyConnected folded into its constant weights and bias. Quantized
+ * weights are requantized to the range of the folded values, the bias to
+ * input scale times weight scale.
+ *
+ * @return folded graph and the mapping from inputs/outputs of `src_graph`
+ * to its own, or nullptr if `src_graph` has a cycle
+ */
+std::pair<
+    /*folded graph*/
+    std::shared_ptr<vx::Graph>,
+    /* tensor mapping between original graph and folded graph*/
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+WeightFolding(const std::shared_ptr<vx::Graph>& src_graph,
+              std::shared_ptr<vx::Context>& ctx,
+              WeightFoldingStats* stats = nullptr);
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
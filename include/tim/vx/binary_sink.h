@@ -0,0 +1,98 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_BINARY_SINK_H_
+#define TIM_VX_BINARY_SINK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tim {
+namespace vx {
+
+/// Destination of a compiled binary graph (NBG).
+/// Graph::CompileToBinary asks the sink for storage once the binary size is
+/// known and generates the binary straight into it.
+class BinarySink {
+ public:
+  virtual ~BinarySink() {}
+  /// Return writable storage of at least size bytes, nullptr on failure.
+  /// The storage must stay valid until Commit.
+  virtual void* Reserve(size_t size) = 0;
+  /// Called once the binary is written, size is its final byte count.
+  virtual bool Commit(size_t size) = 0;
+};
+
+/// Grow a std::vector to hold the binary.
+class VectorBinarySink : public BinarySink {
+ public:
+  explicit VectorBinarySink(std::vector<char>& buf) : buf_(buf) {}
+  void* Reserve(size_t size) override;
+  bool Commit(size_t size) override;
+
+ private:
+  std::vector<char>& buf_;
+};
+
+/// Write the binary into a caller provided memory region, e.g. a mapped
+/// file or device buffer. Fails if the region is too small.
+class MemoryBinarySink : public BinarySink {
+ public:
+  MemoryBinarySink(void* base, size_t capacity)
+      : base_(base), capacity_(capacity) {}
+  void* Reserve(size_t size) override;
+  bool Commit(size_t size) override;
+  size_t Size() const { return size_; }
+
+ private:
+  void* base_;
+  size_t capacity_;
+  size_t size_{0};
+};
+
+/// Write the binary to a file descriptor at offset. The file is grown and
+/// mapped, so the binary is generated directly into the page cache.
+class FileBinarySink : public BinarySink {
+ public:
+  explicit FileBinarySink(int fd, uint64_t offset = 0)
+      : fd_(fd), offset_(offset) {}
+  ~FileBinarySink();
+  void* Reserve(size_t size) override;
+  bool Commit(size_t size) override;
+
+ private:
+  void Unmap();
+
+  int fd_;
+  uint64_t offset_;
+  void* map_{nullptr};
+  size_t map_size_{0};
+  size_t map_delta_{0};
+  uint64_t file_size_{0};
+};
+
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_BINARY_SINK_H_ */
@@ -24,8 +24,11 @@
 #ifndef TIM_VX_COMPILE_OPTION_H_
 #define TIM_VX_COMPILE_OPTION_H_
 
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #if defined(ENABLE_PLATFORM)
 #include "platform/platform.h"
@@ -34,6 +37,41 @@
 namespace tim {
 namespace vx {
 struct CompileOptionImpl;
+
+/// Counters of the compiled graph cache, shared by all graphs in the process
+struct CompileCacheStats {
+  uint64_t hits{0};
+  uint64_t misses{0};
+  uint64_t stores{0};
+  uint64_t evictions{0};
+};
+
+CompileCacheStats GetCompileCacheStats();
+void ResetCompileCacheStats();
+
+class Operation;
+
+/// Outcome of batch splitting for a compiled graph, see
+/// CompileOption::setBatchSplit
+struct BatchSplitReport {
+  struct Node {
+    /// Operation the low-level node was created for, nullptr if unknown
+    const Operation* op{nullptr};
+    /// Low-level operation name
+    std::string name;
+    /// Parts the batch dimension is split into
+    uint32_t split{1};
+  };
+
+  /// False if the driver can't split nodes on batch
+  bool supported{false};
+  bool enabled{false};
+  /// Low-level nodes of the graph
+  uint32_t node_count{0};
+  /// Nodes split into more than one part
+  std::vector<Node> split_nodes;
+};
+
 class CompileOption {
  public:
   CompileOption();
@@ -42,6 +80,27 @@ class CompileOption {
   bool isRelaxMode() const;
   bool setRelaxMode(bool enable = false);
 
+  /// Directory of the persistent compiled graph cache, empty disables it.
+  /// On a hit Graph::Compile loads the stored binary graph (NBG) instead of
+  /// setting up and verifying the graph again.
+  const std::string& getCacheDir() const;
+  void setCacheDir(const std::string& dir);
+
+  /// Byte budget of the cache directory, least recently used binaries are
+  /// evicted first. 0 means unlimited.
+  uint64_t getCacheMaxBytes() const;
+  void setCacheMaxBytes(uint64_t max_bytes);
+
+  /// Split nodes with batch > 1 on the batch dimension so the parts run on
+  /// different NPU cores. Needs driver support, the VSI_VX_ENABLE_BATCH_OPT
+  /// environment variable takes precedence if set.
+  bool isBatchSplit() const;
+  void setBatchSplit(bool enable);
+
+  /// Max parts a node is split into, 0 means the core count of the device
+  uint32_t getMaxBatchSplit() const;
+  void setMaxBatchSplit(uint32_t max_split);
+
 #if defined(ENABLE_PLATFORM)
   void setDeviceId(::tim::vx::platform::IDevice::device_id_t device);
   ::tim::vx::platform::IDevice::device_id_t getDeviceId();
@@ -27,23 +27,23 @@
 #ifdef BUILD_WITH_BAZEL
 #include "vsi_feat_ops_def.h"
 #endif
-#ifdef ENABLE_TENSOR_CACHE
-#include <openssl/evp.h>
-#include <string>
-#endif
+#include <future>
 #include <memory>
 #include <vector>
 #include <map>
+#include <unordered_map>
+
+#include "tim/vx/binary_sink.h"
+#include "tim/vx/param_hash.h"
 namespace tim {
 namespace vx {
-#ifdef ENABLE_TENSOR_CACHE
-const std::string calculateMd5Secret32(const std::string& src);
-#endif
 class Tensor;
 struct TensorSpec;
 struct DmaBufferDesc;
+struct BorrowedBufferDesc;
 class Operation;
 class CompileOption;
+struct BatchSplitReport;
 
 class Graph {
  public:
@@ -59,6 +59,11 @@ class Graph {
   virtual std::shared_ptr<Tensor> CreateTensor(const TensorSpec& spec,
                                                const DmaBufferDesc& dmafd) = 0;
 
+  /// Create a CONSTANT tensor backed by caller's memory without copying it.
+  /// The memory must stay valid and unmodified until `buffer.release` is called
+  virtual std::shared_ptr<Tensor> CreateTensor(
+      const TensorSpec& spec, const BorrowedBufferDesc& buffer) = 0;
+
   /// Create a tensor with given `TensorSpec`.
   /// spec.attr_ must be TensorAttribute::Input or Output
   virtual std::shared_ptr<Tensor> CreateIOTensor(const TensorSpec& spec,
@@ -73,12 +78,32 @@ class Graph {
   /// Compile to BinaryGraph
   virtual bool CompileToBinary(void* buf, size_t* size) = 0;
 
+  /// Compile to BinaryGraph, the binary is written straight into the
+  /// storage reserved from sink. The driver reports the binary size by
+  /// generating it, so generation still runs twice
+  virtual bool CompileToBinary(BinarySink& sink);
+
+  /// Nodes split on batch by CompileOption::setBatchSplit, valid once the
+  /// graph is compiled
+  virtual BatchSplitReport GetBatchSplitReport() const;
+
   virtual bool Run() = 0;
 
+  /// Schedule the graph on the device and return without waiting for it.
+  /// The returned future yields the run status, get() or wait() blocks until
+  /// the device is done. Inputs must not be modified and outputs must not be
+  /// read before that. A graph runs once at a time: Run() and RunAsync() wait
+  /// for an unfinished asynchronous run first, even if its future was
+  /// dropped.
+  virtual std::future<bool> RunAsync() = 0;
+
   template <typename OpType, typename... Params>
   std::shared_ptr<OpType> CreateOperation(Params... parameters) {
     auto op = std::make_shared<OpType>(this, parameters...);
     op_vector_.push_back(op);
+    detail::ParamHasher hasher;
+    hasher.AddAll(parameters...);
+    op_index_[op.get()] = {op, hasher.Value(), hasher.IsReproducible()};
     return op;
   }
 
@@ -103,6 +128,9 @@ class Graph {
   virtual void PrintGraph() const = 0;
 
   const std::vector<std::shared_ptr<Tensor>> GetConstantInputs() const;
+  /// Digest of the parameters `op` was created with by CreateOperation.
+  /// Returns false for ops this graph didn't create
+  bool GetOpParamDigest(const Operation* op, uint64_t& digest) const;
   virtual std::vector<std::shared_ptr<Operation>>& OpVector() = 0;
   virtual std::map<std::shared_ptr<Tensor>,
                    std::vector<std::shared_ptr<Operation>>>&
@@ -112,6 +140,14 @@ class Graph {
 
  protected:
   std::vector<std::shared_ptr<tim::vx::Operation>> op_vector_;
+  struct OpEntry {
+    std::weak_ptr<Operation> op;
+    /// Digest of the parameters passed to CreateOperation
+    uint64_t param_digest;
+    bool param_reproducible;
+  };
+  /// Look up the owning handle of an op created by CreateOperation
+  std::unordered_map<const Operation*, OpEntry> op_index_;
 };
 
 }  // namespace vx
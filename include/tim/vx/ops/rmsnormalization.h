@@ -0,0 +1,64 @@
+/****************************************************************************
+*
+*    Copyright (c) 2020-2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_OPS_RMSNORMALIZATION_H_
+#define TIM_VX_OPS_RMSNORMALIZATION_H_
+
+#include "tim/vx/builtin_op.h"
+
+#ifdef VSI_FEAT_OP_RMSNORM
+
+namespace tim {
+namespace vx {
+namespace ops {
+
+/**
+ * ## RMSNormalization
+ *
+ * Normalize the input by its root mean square along the given axis and scale it
+ * by gamma:
+ *
+ *   output = input / sqrt(mean(input^2, axis) + eps) * gamma
+ *
+ * - axis : the axis to normalize along. Default = 0.
+ * - eps : added to the mean square for numerical stability. Default = 1e-5.
+ *
+ * Inputs are the input tensor and a 1-D float32 gamma.
+ */
+
+class RMSNormalization : public BuiltinOp {
+ public:
+  RMSNormalization(Graph* graph, int32_t axis = 0, float eps = 1e-5f);
+
+  std::shared_ptr<Operation> Clone(std::shared_ptr<Graph>& graph) const override;
+
+ protected:
+  int32_t axis_;
+  float eps_;
+};
+
+}  // namespace ops
+}  // namespace vx
+}  // namespace tim
+#endif  //(VSI_FEAT_OP_RMSNORM)
+#endif /* TIM_VX_OPS_RMSNORMALIZATION_H_ */
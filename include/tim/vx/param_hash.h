@@ -0,0 +1,120 @@
+/****************************************************************************
+*
+*    Copyright (c) 2020-2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_PARAM_HASH_H_
+#define TIM_VX_PARAM_HASH_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace tim {
+namespace vx {
+namespace detail {
+
+/// Accumulate a digest over the parameters an operation was created with.
+/// Values are hashed by content, so the digest is stable across processes.
+/// Pointers and types without a known layout can only be hashed by address,
+/// such digests are flagged as not reproducible.
+class ParamHasher {
+ public:
+  static constexpr uint64_t kSeed = 0xcbf29ce484222325ULL;
+
+  void Update(const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      value_ = (value_ ^ bytes[i]) * 0x100000001b3ULL;
+    }
+  }
+
+  template <typename T>
+  typename std::enable_if<std::is_arithmetic<T>::value ||
+                          std::is_enum<T>::value>::type
+  Add(const T& v) {
+    Update(&v, sizeof(v));
+  }
+
+  void Add(const std::string& v) {
+    Add(v.size());
+    Update(v.data(), v.size());
+  }
+
+  template <typename T>
+  void Add(T* v) {
+    Update(&v, sizeof(v));
+    reproducible_ = false;
+  }
+
+  template <typename T>
+  void Add(const std::shared_ptr<T>& v) {
+    Add(v.get());
+  }
+
+  template <typename T>
+  void Add(const std::vector<T>& v) {
+    Add(v.size());
+    for (const auto& e : v) {
+      Add(e);
+    }
+  }
+
+  template <typename T, size_t N>
+  void Add(const std::array<T, N>& v) {
+    for (const auto& e : v) {
+      Add(e);
+    }
+  }
+
+  template <typename T>
+  typename std::enable_if<!std::is_arithmetic<T>::value &&
+                          !std::is_enum<T>::value>::type
+  Add(const T& v) {
+    Update(&v, sizeof(v));
+    reproducible_ = false;
+  }
+
+  void AddAll() {}
+
+  template <typename T, typename... Rest>
+  void AddAll(const T& first, const Rest&... rest) {
+    Add(first);
+    AddAll(rest...);
+  }
+
+  uint64_t Value() const { return value_; }
+  bool IsReproducible() const { return reproducible_; }
+
+ private:
+  uint64_t value_{kSeed};
+  bool reproducible_{true};
+};
+
+}  // namespace detail
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_PARAM_HASH_H_ */
@@ -0,0 +1,103 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_PLATFORM_DISPATCHER_H_
+#define TIM_VX_PLATFORM_DISPATCHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace tim {
+namespace vx {
+
+class Graph;
+
+namespace platform {
+
+class IExecutor;
+
+/// Request level parallelism over several executors.
+///
+/// Every executor gets its own compiled copy of the graph and a worker
+/// thread. Requests are queued on the executor with the shortest queue, a
+/// worker whose queue ran dry steals the newest request of the longest one.
+/// Carve a device into sub-devices with IDevice::CreateExecutor(core_index,
+/// core_count) and throughput scales with the cores under bursty load.
+class Dispatcher {
+ public:
+  /// Host buffers of one inference, in the order of Graph::InputsTensor()
+  /// and Graph::OutputsTensor(). They must stay valid until `done` is called
+  struct Request {
+    std::vector<const void*> inputs;
+    std::vector<uint32_t> input_bytes;
+    std::vector<void*> outputs;
+    /// Called with the run status on the worker thread which ran it
+    std::function<void(bool)> done;
+  };
+
+  struct ExecutorStats {
+    uint64_t completed{0};
+    uint64_t failed{0};
+    /// Requests taken from the queue of another executor
+    uint64_t stolen{0};
+    /// Time spent copying and running requests
+    uint64_t busy_us{0};
+    /// busy_us over the lifetime of the dispatcher, 0 to 1
+    double utilization{0};
+  };
+
+  struct Stats {
+    /// Requests waiting for an executor
+    size_t queue_depth{0};
+    size_t max_queue_depth{0};
+    uint64_t submitted{0};
+    /// In the order of the executors given to Create
+    std::vector<ExecutorStats> executors;
+  };
+
+  virtual ~Dispatcher() {}
+
+  /// Queue a request, false after Close() or if buffers don't match graph IO
+  virtual bool Submit(const Request& request) = 0;
+  /// Block until every submitted request completed, return false if any
+  /// failed since the last Wait(). Must not be called from a `done` callback.
+  virtual bool Wait() = 0;
+  /// Stop accepting requests, queued ones are still executed.
+  virtual void Close() = 0;
+
+  virtual Stats GetStats() const = 0;
+
+  /// Compile `graph` once per executor, returns nullptr on failure.
+  static std::shared_ptr<Dispatcher> Create(
+      const std::shared_ptr<Graph>& graph,
+      const std::vector<std::shared_ptr<IExecutor>>& executors);
+};
+
+}  // namespace platform
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_PLATFORM_DISPATCHER_H_ */
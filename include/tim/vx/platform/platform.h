@@ -25,6 +25,7 @@
 #define TIM_VX_PLATFORM_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 #include <functional>
 #include <iostream>
@@ -49,6 +50,44 @@ class IExecutable;
 class IExecutor;
 class ITensorHandle;
 
+/// Immutable network binary graph (NBG). Executables created from the same
+/// buffer share it instead of holding a copy each.
+class NBGBuffer {
+ public:
+  /// Take binary over without copying it
+  static std::shared_ptr<const NBGBuffer> Create(std::vector<char> binary) {
+    auto storage = std::make_shared<std::vector<char>>(std::move(binary));
+    return std::shared_ptr<const NBGBuffer>(
+        new NBGBuffer(storage->data(), storage->size(), storage));
+  }
+  /// Map the binary file copy-on-write, pages are loaded on first access and
+  /// shared with the page cache until written. Returns nullptr if it can't be
+  /// mapped
+  static std::shared_ptr<const NBGBuffer> Load(const std::string& path);
+  /// Reference data without copying it, data has to stay valid until the
+  /// last executable created from it is gone. owner, if given, is held as
+  /// long as the buffer to keep data alive. The driver may patch the binary
+  /// in place, data has to be writable
+  static std::shared_ptr<const NBGBuffer> Borrow(
+      const void* data, size_t size,
+      std::shared_ptr<const void> owner = nullptr) {
+    return std::shared_ptr<const NBGBuffer>(new NBGBuffer(
+        static_cast<const char*>(data), size, std::move(owner)));
+  }
+  const char* Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+ protected:
+  /// data stays valid as long as storage is referenced
+  NBGBuffer(const char* data, size_t size, std::shared_ptr<const void> storage)
+      : data_(data), size_(size), storage_(std::move(storage)) {}
+
+ private:
+  const char* data_;
+  size_t size_;
+  std::shared_ptr<const void> storage_;
+};
+
 std::shared_ptr<IExecutable> Compile(
     const std::shared_ptr<Graph>& graph,
     const std::shared_ptr<IExecutor>& executor);
@@ -89,9 +128,54 @@ class IExecutor {
   virtual bool Submit(const std::shared_ptr<IExecutable>& executable,
                       const std::shared_ptr<IExecutable>& ref,
                       bool after = true) = 0;
-  virtual bool Trigger(bool async = false) = 0;  // todo: async=true
+  /// Submit executable to run once every executable of depends_on finished.
+  /// Dependencies must be submitted to this executor first. Executables
+  /// without a path between them may run concurrently, also ones compiled
+  /// by another executor which run on the cores of that executor. The
+  /// default runs in submission order, which satisfies every dependency.
+  virtual bool SubmitAfter(
+      const std::shared_ptr<IExecutable>& executable,
+      const std::vector<std::shared_ptr<IExecutable>>& depends_on) {
+    (void)depends_on;
+    return Submit(executable, executable);
+  }
+  /// Run the submitted executables. Ones submitted with Submit run in their
+  /// submission order, ones submitted with SubmitAfter as soon as their
+  /// dependencies finished. With async=true they are handed to workers of
+  /// the executor and Trigger returns at once, use Wait() or
+  /// IExecutable::Wait() to join them.
+  virtual bool Trigger(bool async = false) = 0;
+  /// Block until all asynchronously triggered work finished, return false
+  /// if any of it failed since the last Wait(). Must not be called from a
+  /// completion callback.
+  virtual bool Wait() { return true; }
   virtual std::shared_ptr<IExecutable> Compile(
       const std::shared_ptr<Graph>& graph) = 0;
+  /// Create another executable running nbg, e.g. IExecutable::Binary() of a
+  /// compiled one. It shares the binary and has its own IO bindings.
+  /// Returns nullptr if the executor can't share binaries.
+  virtual std::shared_ptr<IExecutable> CreateExecutable(
+      const std::shared_ptr<const NBGBuffer>& nbg, size_t input_count,
+      size_t output_count) {
+    (void)nbg;
+    (void)input_count;
+    (void)output_count;
+    return nullptr;
+  }
+  /// Take an IO handle of tensor_spec for executable from the pool of this
+  /// executor, or allocate one if none is free. Free handles are handed out
+  /// in allocation order and keep the bindings of their earlier request, so
+  /// acquiring the IO of every request in the same order reuses them as is.
+  /// The default allocates a new handle every time.
+  virtual std::shared_ptr<ITensorHandle> AcquireTensor(
+      const std::shared_ptr<IExecutable>& executable,
+      const TensorSpec& tensor_spec);
+  /// Give a handle taken by AcquireTensor back to the pool, return false if
+  /// it didn't come from the pool
+  virtual bool ReleaseTensor(const std::shared_ptr<ITensorHandle>& handle) {
+    (void)handle;
+    return false;
+  }
   virtual std::shared_ptr<IDevice> Device() const {return device_;};
   virtual std::shared_ptr<Context> Contex() const {return context_;};
   virtual uint32_t CoreIndex() const {return core_index_; };
@@ -107,6 +191,8 @@ class IExecutor {
 
 class IExecutable : public std::enable_shared_from_this<IExecutable> {
  public:
+  /// Called with the run status each time the executable finished running
+  using completion_callback = std::function<void(bool)>;
   virtual ~IExecutable(){};
   virtual void SetInput(const std::shared_ptr<ITensorHandle>& th) = 0;
   virtual void SetOutput(const std::shared_ptr<ITensorHandle>& th) = 0;
@@ -116,18 +202,34 @@ class IExecutable : public std::enable_shared_from_this<IExecutable> {
   virtual std::vector<std::shared_ptr<ITensorHandle>> Getinputs() { return input_handles_;};
   virtual bool Submit(const std::shared_ptr<IExecutable>& ref,
                       bool after = true) = 0;
-  virtual bool Trigger(bool async = false) = 0;  // todo: async=true
+  virtual bool Trigger(bool async = false) = 0;
+  /// Block until the last triggered run of this executable finished and
+  /// return its status
+  virtual bool Wait() { return true; }
+  void SetCompletionCallback(const completion_callback& cb) { callback_ = cb; }
   virtual bool Verify() = 0;
   std::shared_ptr<Graph> NBGraph() const {return nb_graph_;};
+  /// Binary run by this executable, nullptr if it isn't kept on the host
+  std::shared_ptr<const NBGBuffer> Binary() const { return nbg_; }
   virtual std::shared_ptr<ITensorHandle> AllocateTensor(const TensorSpec& tensor_spec ,
                                                         void* data = nullptr, uint32_t size = 0) = 0;
+  /// Create an IO tensor on the dma-buf dmabuf.fd, which stays owned by the
+  /// caller. Returns nullptr if the driver can't import dma-bufs.
+  virtual std::shared_ptr<ITensorHandle> AllocateDmaBufTensor(
+      const TensorSpec& tensor_spec, const DmaBufferDesc& dmabuf) {
+    (void)tensor_spec;
+    (void)dmabuf;
+    return nullptr;
+  }
 
  protected:
   std::weak_ptr<IExecutor> executor_;
   std::shared_ptr<Context> context_;
   std::shared_ptr<Graph> nb_graph_;
+  std::shared_ptr<const NBGBuffer> nbg_;
   std::vector<std::shared_ptr<ITensorHandle>> input_handles_;
   std::vector<std::shared_ptr<ITensorHandle>> output_handles_;
+  completion_callback callback_;
 };
 
 class ITensorHandle {
@@ -135,6 +237,12 @@ class ITensorHandle {
   virtual ~ITensorHandle(){};
   virtual bool CopyDataToTensor(const void* data, uint32_t size_in_bytes) = 0;
   virtual bool CopyDataFromTensor(void* data) = 0;
+  /// Direct CPU access to the tensor memory instead of copying it, nullptr
+  /// if the handle can't be mapped. Data written by the device is visible
+  /// once mapped, data written by the CPU once unmapped, so Unmap before
+  /// the next run uses the tensor.
+  virtual void* Map() { return nullptr; }
+  virtual void Unmap() {}
   virtual std::shared_ptr<Tensor> GetTensor() const { return tensor_;};
   virtual TensorSpec& GetSpec() { return spec_;};
 
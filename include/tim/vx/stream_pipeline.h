@@ -0,0 +1,115 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_STREAM_PIPELINE_H_
+#define TIM_VX_STREAM_PIPELINE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tim {
+namespace vx {
+
+class Graph;
+
+/// Streaming inference over a compiled graph.
+///
+/// The pipeline owns `depth` sets of input/output buffers and binds one set
+/// per frame to the graph IO tensors with Tensor::SwapHandle, so frames are
+/// never copied. While the device runs frame N the producer fills frame N+1
+/// and the consumer reads frame N-1 back:
+///
+///   producer: AcquireInput -> fill -> SubmitInput
+///   pipeline: bind buffers -> run graph (own thread)
+///   consumer: AcquireOutput -> read -> ReleaseOutput
+///
+/// Graph inputs and outputs must be created from handle (ENABLE_TENSOR_HNDL).
+class StreamPipeline {
+ public:
+  /// Buffers of one frame, in the order of Graph::InputsTensor() and
+  /// Graph::OutputsTensor()
+  struct Frame {
+    std::vector<void*> inputs;
+    std::vector<void*> outputs;
+    std::vector<size_t> input_bytes;
+    std::vector<size_t> output_bytes;
+    /// Submission order, starting from 0
+    uint64_t sequence{0};
+    /// Run status of the graph, valid after AcquireOutput
+    bool status{false};
+  };
+
+  /// Latency of one pipeline stage in microseconds
+  struct StageLatency {
+    uint64_t count{0};
+    uint64_t total_us{0};
+    uint64_t max_us{0};
+    uint64_t AverageUs() const { return count ? total_us / count : 0; }
+  };
+
+  struct Stats {
+    /// AcquireInput blocked because every buffer set was in flight
+    StageLatency producer_stall;
+    /// AcquireInput to SubmitInput, host side fill
+    StageLatency fill;
+    /// SubmitInput until the device picked the frame up
+    StageLatency queue;
+    /// Graph run
+    StageLatency execute;
+    /// Run finished until the consumer acquired the frame
+    StageLatency drain;
+    /// AcquireOutput blocked because no frame was finished
+    StageLatency consumer_stall;
+    /// AcquireOutput to ReleaseOutput, host side readback
+    StageLatency readback;
+  };
+
+  virtual ~StreamPipeline() {}
+
+  /// Return a free frame to fill, blocks while all frames are in flight.
+  /// nullptr after Close().
+  virtual Frame* AcquireInput() = 0;
+  /// Queue a filled frame for execution.
+  virtual bool SubmitInput(Frame* frame) = 0;
+  /// Return the oldest finished frame, blocks until one is available.
+  /// nullptr once closed and every submitted frame was handed out.
+  virtual Frame* AcquireOutput() = 0;
+  /// Give a consumed frame back to the producer side.
+  virtual void ReleaseOutput(Frame* frame) = 0;
+  /// Stop accepting input, frames already submitted are still executed.
+  virtual void Close() = 0;
+
+  virtual Stats GetStats() const = 0;
+
+  /// depth: number of buffer sets, 2 for double buffering.
+  /// Compiles the graph if needed, returns nullptr on failure.
+  static std::shared_ptr<StreamPipeline> Create(
+      const std::shared_ptr<Graph>& graph, size_t depth = 2);
+};
+
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_STREAM_PIPELINE_H_ */
@@ -25,6 +25,7 @@
 #define TIM_VX_TENSOR_H_
 
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -140,6 +141,16 @@ struct DmaBufferDesc {
   int64_t fd;
 };
 
+/// Memory lent to a CONSTANT tensor, e.g. weights in an mmapped model file.
+/// The tensor references `data` instead of copying it; `release`, if set, is
+/// invoked once neither the tensor nor its graph references `data` any more.
+/// `data` should be aligned to 64 bytes, otherwise it's copied and released
+/// right away.
+struct BorrowedBufferDesc {
+  const void* data;
+  std::function<void(const void* data)> release;
+};
+
 class Tensor {
  public:
   virtual ~Tensor() {}
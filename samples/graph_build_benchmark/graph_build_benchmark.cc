@@ -0,0 +1,97 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+/*
+ * Measure the host-side cost of building a tim::vx::Graph.
+ *
+ * A chain of elementwise ops is built node by node, every op consumes the
+ * previous op's output and a constant, so each step exercises tensor
+ * creation, operation creation and input/output binding. Build time should
+ * scale linearly with the node count.
+ *
+ * Usage: graph_build_benchmark [node_count ...]
+ *        defaults to 1000 10000 100000
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops/elementwise.h"
+#include "tim/vx/tensor.h"
+
+namespace {
+
+double BuildChain(uint32_t node_count) {
+  tim::vx::ShapeType shape({4, 4});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  std::vector<float> const_data(16, 1.0f);
+
+  auto context = tim::vx::Context::Create();
+  auto start = std::chrono::steady_clock::now();
+  auto graph = context->CreateGraph();
+  auto prev = graph->CreateTensor(input_spec);
+  for (uint32_t i = 0; i < node_count; ++i) {
+    auto bias = graph->CreateTensor(const_spec, const_data.data());
+    auto next = graph->CreateTensor(i + 1 == node_count ? output_spec
+                                                        : transient_spec);
+    graph->CreateOperation<tim::vx::ops::Add>()
+        ->BindInputs({prev, bias})
+        .BindOutput(next);
+    prev = next;
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<uint32_t> node_counts;
+  for (int i = 1; i < argc; ++i) {
+    node_counts.push_back(static_cast<uint32_t>(std::atoi(argv[i])));
+  }
+  if (node_counts.empty()) {
+    node_counts = {1000, 10000, 100000};
+  }
+
+  std::cout << std::setw(10) << "nodes" << std::setw(14) << "build(ms)"
+            << std::setw(14) << "us/node" << std::endl;
+  for (auto count : node_counts) {
+    double ms = BuildChain(count);
+    std::cout << std::setw(10) << count << std::setw(14) << std::fixed
+              << std::setprecision(2) << ms << std::setw(14)
+              << ms * 1000.0 / count << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,123 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+/*
+ * Measure the host-side cost of the layout inference pass.
+ *
+ * A deep residual chain is built from CWHN blocks of
+ * conv2d(1x1) -> relu -> add(block input), so every op of the graph goes
+ * through permute propagation and the tensor map. Only the pass itself is
+ * timed, it should scale linearly with the op count.
+ *
+ * Usage: layout_inference_benchmark [block_count ...]
+ *        defaults to 1000 5000 20000, each block is three ops
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "tim/transform/layout_inference.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops/activations.h"
+#include "tim/vx/ops/conv2d.h"
+#include "tim/vx/ops/elementwise.h"
+#include "tim/vx/tensor.h"
+
+namespace {
+
+std::shared_ptr<tim::vx::Graph> BuildResidualChain(
+    const std::shared_ptr<tim::vx::Context>& context, uint32_t block_count,
+    const std::vector<float>& kernel_data) {
+  const uint32_t channels = 8;
+  tim::vx::ShapeType shape({channels, 16, 16, 1});  // CWHN
+  tim::vx::ShapeType kernel_shape({channels, 1, 1, channels});  // IcWHOc
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec kernel_spec(tim::vx::DataType::FLOAT32, kernel_shape,
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+
+  auto graph = context->CreateGraph();
+  auto block_in = graph->CreateTensor(input_spec);
+  for (uint32_t i = 0; i < block_count; ++i) {
+    auto kernel = graph->CreateTensor(kernel_spec, kernel_data.data());
+    auto conv_out = graph->CreateTensor(transient_spec);
+    auto relu_out = graph->CreateTensor(transient_spec);
+    auto block_out = graph->CreateTensor(
+        i + 1 == block_count ? output_spec : transient_spec);
+    graph
+        ->CreateOperation<tim::vx::ops::Conv2d>(
+            tim::vx::PadType::VALID, std::array<uint32_t, 2>({1, 1}),
+            std::array<uint32_t, 2>({1, 1}), 0, tim::vx::DataLayout::CWHN,
+            tim::vx::DataLayout::IcWHOc)
+        ->BindInputs({block_in, kernel})
+        .BindOutput(conv_out);
+    graph->CreateOperation<tim::vx::ops::Relu>()
+        ->BindInput(conv_out)
+        .BindOutput(relu_out);
+    graph->CreateOperation<tim::vx::ops::Add>()
+        ->BindInputs({relu_out, block_in})
+        .BindOutput(block_out);
+    block_in = block_out;
+  }
+  return graph;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<uint32_t> block_counts;
+  for (int i = 1; i < argc; ++i) {
+    block_counts.push_back(static_cast<uint32_t>(std::atoi(argv[i])));
+  }
+  if (block_counts.empty()) {
+    block_counts = {1000, 5000, 20000};
+  }
+  std::vector<float> kernel_data(8 * 8, 0.125f);
+
+  std::cout << std::setw(10) << "ops" << std::setw(14) << "infer(ms)"
+            << std::setw(14) << "us/op" << std::setw(14) << "out ops"
+            << std::endl;
+  for (auto count : block_counts) {
+    auto context = tim::vx::Context::Create();
+    auto graph = BuildResidualChain(context, count, kernel_data);
+    auto op_count = graph->OpVector().size();
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = tim::transform::LayoutInference(graph, context);
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::cout << std::setw(10) << op_count << std::setw(14) << std::fixed
+              << std::setprecision(2) << ms << std::setw(14)
+              << ms * 1000.0 / op_count << std::setw(14)
+              << result.first->OpVector().size() << std::endl;
+  }
+  return 0;
+}
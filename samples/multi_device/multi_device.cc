@@ -30,7 +30,6 @@
 #include <vector>
 #include <assert.h>
 #include <chrono>
-#include <thread>
 
 #include "tim/vx/context.h"
 #include "tim/vx/graph.h"
@@ -88,10 +87,6 @@ std::vector<std::vector<char>> load_input_data(std::vector<std::string> filename
     return Data;
 }
 
-void executor_trigger(std::shared_ptr<tim::vx::platform::IExecutor> executor) {
-  executor->Trigger();
-}
-
 auto context = tim::vx::Context::Create();
 std::pair<std::shared_ptr<tim::vx::platform::IExecutable>, std::shared_ptr<tim::vx::platform::ITensorHandle>>
   generate_executable(
@@ -103,7 +98,13 @@ std::pair<std::shared_ptr<tim::vx::platform::IExecutable>, std::shared_ptr<tim::
   const char* weight_file_c = weight_file.c_str();
   construct_func(graph, weight_file_c);
   auto input_data = load_input_data(input_files, input_size_bytes);
+  auto compile_start = std::chrono::high_resolution_clock::now();
   auto executable = tim::vx::platform::Compile(graph, executor);  // compile to nbg
+  auto compile_end = std::chrono::high_resolution_clock::now();
+  std::cout << "Compile " << weight_file << " cost: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   compile_end - compile_start).count()
+            << "ms" << std::endl;
   auto input_handle = executable->AllocateTensor(graph->InputsTensor()[0]->GetSpec());
   auto output_handle = executable->AllocateTensor(graph->OutputsTensor()[0]->GetSpec());
   executable->SetInput(input_handle);
@@ -184,12 +185,14 @@ int main(int argc, char** argv) {
       executors[i]->Submit(nets.back().first, nets.back().first);
     }
   }
-  std::vector<std::thread> threads;
+  // one host thread keeps all sub-devices busy
   for(auto executor:executors) {
-        threads.push_back(std::thread(executor_trigger, executor));
+    executor->Trigger(true);
   }
-  for(std::thread &t : threads) {
-     t.join();
+  for(auto executor:executors) {
+    if (!executor->Wait()) {
+      std::cout << "Executor run fail." << std::endl;
+    }
   }
 
 for (auto net : nets) {
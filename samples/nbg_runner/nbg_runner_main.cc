@@ -39,6 +39,13 @@
 #include <windows.h>
 #endif
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 static uint64_t get_perf_count()
@@ -98,19 +105,45 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+#ifndef _WIN32
+    // Map the binary instead of reading it, only touched pages are loaded
+    int nbg_fd = open((const char*)argv[1], O_RDONLY);
+    if (nbg_fd < 0) {
+        std::cout << "Failed to open " << argv[1] << std::endl;
+        return -1;
+    }
+    struct stat nbg_stat;
+    if (0 != fstat(nbg_fd, &nbg_stat) || nbg_stat.st_size <= 0) {
+        std::cout << "Failed to stat " << argv[1] << std::endl;
+        close(nbg_fd);
+        return -1;
+    }
+    size_t nbg_size = static_cast<size_t>(nbg_stat.st_size);
+    // Copy-on-write, the driver may patch the binary in place
+    void* nbg_map = mmap(NULL, nbg_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                         nbg_fd, 0);
+    close(nbg_fd);
+    if (nbg_map == MAP_FAILED) {
+        std::cout << "Failed to map " << argv[1] << std::endl;
+        return -1;
+    }
+    char* nbg_data = static_cast<char*>(nbg_map);
+#else
     ifstream nbg_file((const char*)argv[1]);
     assert(nbg_file);
 
     nbg_file.seekg(0, ios::end);
-    int nbg_size = nbg_file.tellg();
+    size_t nbg_size = static_cast<size_t>(nbg_file.tellg());
     std::vector<char> nbg_buf(nbg_size);
     nbg_file.seekg(0, ios::beg);
     nbg_file.read( nbg_buf.data(), nbg_size );
     nbg_file.close();
+    char* nbg_data = nbg_buf.data();
+#endif
 
     nbg_parser_data nbg = NBG_NULL;
 
-    nbg_parser_init(nbg_buf.data(), nbg_size, &nbg);
+    nbg_parser_init(nbg_data, static_cast<nbg_uint32_t>(nbg_size), &nbg);
 
     // Get Inputs
     int input_count = 0;
@@ -220,7 +253,7 @@ int main(int argc, char** argv) {
     auto ctx = tim::vx::Context::Create();
     auto graph = ctx->CreateGraph();
     auto nbg_node = graph->CreateOperation<tim::vx::ops::NBG>(
-        nbg_buf.data(), input_count, output_count);
+        nbg_data, input_count, output_count);
     for(int i=0; i<input_count; i++) {
         auto input = graph->CreateTensor(input_list[i]);
         (*nbg_node).BindInput(input);
@@ -242,4 +275,10 @@ int main(int argc, char** argv) {
     tmE = get_perf_count();
     printf("Run Time: %ldus\n", (tmE - tmS)/1000);
 
+    // The NBG node references the binary until the graph is gone
+    nbg_node.reset();
+    graph.reset();
+#ifndef _WIN32
+    munmap(nbg_map, nbg_size);
+#endif
 }
@@ -29,6 +29,7 @@
 
 #include <array>
 #include <filesystem>
+#include <memory>
 #include <string_view>
 
 #include "vx/ovx_executor.hpp"
@@ -45,8 +46,14 @@ PYBIND11_MODULE(_nbg_runner, m) {
   py::class_<OVXExecutor>(m, "OVXExecutor")
     .def(py::init<const fs::path&>())
     .def(py::init([](const py::buffer& nbg_buffer) {
-      auto buffer_info = nbg_buffer.request(false);
-      return std::make_unique<OVXExecutor>(reinterpret_cast<char*>(buffer_info.ptr), buffer_info.size);
+      // Keep the buffer exported while the executor uses it instead of copying,
+      // the driver may patch the binary so read-only buffers are still copied
+      auto buffer_info = std::make_shared<py::buffer_info>(nbg_buffer.request(false));
+      if (buffer_info->readonly) {
+        return std::make_unique<OVXExecutor>(reinterpret_cast<const char*>(buffer_info->ptr), buffer_info->size);
+      }
+      auto nbg_data = std::shared_ptr<const char>(buffer_info, reinterpret_cast<const char*>(buffer_info->ptr));
+      return std::make_unique<OVXExecutor>(std::move(nbg_data));
     }))
     .def("init", &OVXExecutor::init)
     .def("get_num_inputs", &OVXExecutor::get_num_inputs)
@@ -25,26 +25,45 @@
 #include "ovx_executor.hpp"
 
 #include <VX/vx_khr_import_kernel.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <array>
 #include <filesystem>
-#include <fstream>
 
 #include "utils.hpp"
 
 namespace vsi::nbg_runner::vx {
 
 OVXExecutor::OVXExecutor(const char* nbg_data, size_t nbg_size) {
-  nbg_buffer_ = std::vector<char>(nbg_data, nbg_data + nbg_size);
+  auto buffer =
+      std::make_shared<std::vector<char>>(nbg_data, nbg_data + nbg_size);
+  nbg_data_ = std::shared_ptr<const char>(buffer, buffer->data());
 }
 
+OVXExecutor::OVXExecutor(std::shared_ptr<const char> nbg_data)
+    : nbg_data_(std::move(nbg_data)) {}
+
 OVXExecutor::OVXExecutor(const fs::path& nbg_path) {
   size_t nbg_size = fs::file_size(nbg_path);
-  auto nbg_file = std::ifstream(nbg_path, std::ios::in | std::ios::binary);
+  int fd = open(nbg_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open NBG file.");
+  }
+  // Copy-on-write, the driver may patch the binary in place
+  void* addr =
+      mmap(nullptr, nbg_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    throw std::runtime_error("Failed to map NBG file.");
+  }
 
-  nbg_buffer_.resize(nbg_size);
-  nbg_file.read(nbg_buffer_.data(), static_cast<std::streamsize>(nbg_size));
+  nbg_data_ = std::shared_ptr<const char>(
+      static_cast<const char*>(addr), [nbg_size](const char* data) {
+        munmap(const_cast<char*>(data), nbg_size);
+      });
 }
 
 OVXExecutor::~OVXExecutor() {
@@ -76,7 +95,7 @@ int OVXExecutor::init() {
   }
 
   nbg_kernel_ = vxImportKernelFromURL(
-      context_, VX_VIVANTE_IMPORT_KERNEL_FROM_POINTER, nbg_buffer_.data());
+      context_, VX_VIVANTE_IMPORT_KERNEL_FROM_POINTER, nbg_data_.get());
   status = vxGetStatus(reinterpret_cast<vx_reference>(nbg_kernel_));
   if (status != VX_SUCCESS) {
     throw std::runtime_error("Failed to import NBG kernel.");
@@ -32,6 +32,7 @@
 
 #include <array>
 #include <filesystem>
+#include <memory>
 #include <vector>
 
 
@@ -51,7 +52,11 @@ struct OVXTensorInfo {
 
 class OVXExecutor {
  public:
+  /** \brief Copy the NBG from memory. */
   explicit OVXExecutor(const char* nbg_data, size_t nbg_size);
+  /** \brief Borrow the NBG from memory, owned by nbg_data. */
+  explicit OVXExecutor(std::shared_ptr<const char> nbg_data);
+  /** \brief Map the NBG file copy-on-write. */
   explicit OVXExecutor(const fs::path& nbg_path);
 
   ~OVXExecutor();
@@ -101,8 +106,8 @@ class OVXExecutor {
   /** \brief The OpenVX output tensors. */
   std::vector<vx_tensor> output_tensors_;
 
-  /** \brief The NBG buffer. */
-  std::vector<char> nbg_buffer_;
+  /** \brief The NBG data, copied, borrowed or mapped from file. */
+  std::shared_ptr<const char> nbg_data_;
 };
 
 }  // namespace vsi::nbg_runner::vx
@@ -0,0 +1,198 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+/*
+ * Measure what TransposeOptimization saves at run time.
+ *
+ * A chain of CWHN blocks conv2d(1x1) -> transpose -> inverse transpose is
+ * built, as exporters emit around layout sensitive ops. Layout inference
+ * lowers it with a chain of transposes between the convs, which the
+ * optimization composes and cancels. Both graphs are compiled and run with
+ * the same input, the mean run latency of each and the largest output
+ * difference are reported.
+ *
+ * Usage: transpose_optimization_benchmark [block_count [loops]]
+ *        defaults to 16 blocks and 50 loops
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "tim/transform/layout_inference.h"
+#include "tim/transform/transpose_optimization.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops/conv2d.h"
+#include "tim/vx/ops/transpose.h"
+#include "tim/vx/tensor.h"
+
+namespace {
+
+const uint32_t kChannels = 16;
+const uint32_t kSize = 56;
+
+std::shared_ptr<tim::vx::Graph> BuildTransposeChain(
+    const std::shared_ptr<tim::vx::Context>& context, uint32_t block_count,
+    const std::vector<float>& kernel_data) {
+  tim::vx::ShapeType shape({kChannels, kSize, kSize, 1});  // CWHN
+  tim::vx::ShapeType whcn_shape({kSize, kSize, kChannels, 1});
+  tim::vx::ShapeType kernel_shape({kChannels, 1, 1, kChannels});  // IcWHOc
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec kernel_spec(tim::vx::DataType::FLOAT32, kernel_shape,
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec whcn_spec(tim::vx::DataType::FLOAT32, whcn_shape,
+                                tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+
+  auto graph = context->CreateGraph();
+  auto block_in = graph->CreateTensor(input_spec);
+  for (uint32_t i = 0; i < block_count; ++i) {
+    auto kernel = graph->CreateTensor(kernel_spec, kernel_data.data());
+    auto conv_out = graph->CreateTensor(transient_spec);
+    auto whcn = graph->CreateTensor(whcn_spec);
+    auto block_out = graph->CreateTensor(
+        i + 1 == block_count ? output_spec : transient_spec);
+    graph
+        ->CreateOperation<tim::vx::ops::Conv2d>(
+            tim::vx::PadType::VALID, std::array<uint32_t, 2>({1, 1}),
+            std::array<uint32_t, 2>({1, 1}), 0, tim::vx::DataLayout::CWHN,
+            tim::vx::DataLayout::IcWHOc)
+        ->BindInputs({block_in, kernel})
+        .BindOutput(conv_out);
+    graph
+        ->CreateOperation<tim::vx::ops::Transpose>(
+            std::vector<uint32_t>({1, 2, 0, 3}))
+        ->BindInput(conv_out)
+        .BindOutput(whcn);
+    graph
+        ->CreateOperation<tim::vx::ops::Transpose>(
+            std::vector<uint32_t>({2, 0, 1, 3}))
+        ->BindInput(whcn)
+        .BindOutput(block_out);
+    block_in = block_out;
+  }
+  return graph;
+}
+
+// Compile graph and return its mean run latency over loops in ms, output
+// receives the result of the last run
+double TimeRuns(const std::shared_ptr<tim::vx::Graph>& graph,
+                const std::shared_ptr<tim::vx::Tensor>& input,
+                const std::shared_ptr<tim::vx::Tensor>& output,
+                const std::vector<float>& input_data, uint32_t loops,
+                double& compile_ms, std::vector<float>& output_data) {
+  auto start = std::chrono::steady_clock::now();
+  if (!graph->Compile()) {
+    std::cout << "Compile graph fail" << std::endl;
+    return -1;
+  }
+  compile_ms = std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  input->CopyDataToTensor(input_data.data(),
+                          input_data.size() * sizeof(float));
+  graph->Run();  // warm up
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < loops; ++i) {
+    graph->Run();
+  }
+  double run_ms = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count() /
+                  loops;
+  output_data.resize(input_data.size());
+  output->CopyDataFromTensor(output_data.data());
+  return run_ms;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  uint32_t block_count = argc > 1 ? std::atoi(argv[1]) : 16;
+  uint32_t loops = argc > 2 ? std::atoi(argv[2]) : 50;
+  if (block_count == 0 || loops == 0) {
+    std::cout << "Usage: " << argv[0] << " [block_count [loops]]"
+              << std::endl;
+    return -1;
+  }
+  std::vector<float> kernel_data(kChannels * kChannels, 1.0f / kChannels);
+  std::vector<float> input_data(kChannels * kSize * kSize);
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = static_cast<float>(i % 13) / 13.0f;
+  }
+
+  auto context = tim::vx::Context::Create();
+  auto src_graph = BuildTransposeChain(context, block_count, kernel_data);
+  auto src_input = src_graph->InputsTensor()[0];
+  auto src_output = src_graph->OutputsTensor()[0];
+
+  auto infer = tim::transform::LayoutInference(src_graph, context);
+  tim::transform::TransposeOptimizationStats stats;
+  auto opt = tim::transform::TransposeOptimization(infer.first, context,
+                                                   &stats);
+  if (!opt.first) {
+    std::cout << "Transpose optimization fail" << std::endl;
+    return -1;
+  }
+
+  double infer_compile_ms = 0, opt_compile_ms = 0;
+  std::vector<float> infer_out, opt_out;
+  auto infer_input = infer.second[src_input];
+  auto infer_output = infer.second[src_output];
+  double infer_ms = TimeRuns(infer.first, infer_input, infer_output,
+                             input_data, loops, infer_compile_ms, infer_out);
+  double opt_ms = TimeRuns(opt.first, opt.second[infer_input],
+                           opt.second[infer_output], input_data, loops,
+                           opt_compile_ms, opt_out);
+  if (infer_ms < 0 || opt_ms < 0) {
+    return -1;
+  }
+  float max_diff = 0;
+  for (size_t i = 0; i < infer_out.size(); ++i) {
+    max_diff = std::max(max_diff, std::fabs(infer_out[i] - opt_out[i]));
+  }
+
+  std::cout << std::setw(12) << "graph" << std::setw(8) << "ops"
+            << std::setw(12) << "transposes" << std::setw(14) << "compile(ms)"
+            << std::setw(12) << "run(ms)" << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << std::setw(12) << "inferred" << std::setw(8)
+            << infer.first->OpVector().size() << std::setw(12)
+            << stats.transposes_before << std::setw(14) << infer_compile_ms
+            << std::setw(12) << infer_ms << std::endl;
+  std::cout << std::setw(12) << "optimized" << std::setw(8)
+            << opt.first->OpVector().size() << std::setw(12)
+            << stats.transposes_after << std::setw(14) << opt_compile_ms
+            << std::setw(12) << opt_ms << std::endl;
+  std::cout << "speedup " << infer_ms / opt_ms << "x, max output diff "
+            << max_diff << std::endl;
+  return 0;
+}
@@ -24,6 +24,11 @@
 
 #include "execution_private.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <cstdint>
 #include <cstring>
 #include <vector>
@@ -38,17 +43,17 @@
 namespace tim {
 namespace lite {
 
-ExecutionImpl::ExecutionImpl(const void* executable, size_t executable_size) {
+ExecutionImpl::ExecutionImpl(void* executable, size_t executable_size) {
     vip_status_e status = VIP_SUCCESS;
     vip_network network = nullptr;
-    std::vector<uint8_t> data(executable_size);
     valid_ = false;
     status = vip_init();
     if (status != VIP_SUCCESS) {
         return;
     }
-    memcpy(data.data(), executable, executable_size);
-    status = vip_create_network(data.data(), data.size(),
+    // The driver may patch the executable in place, it is done with it once
+    // the network is prepared
+    status = vip_create_network(executable, executable_size,
         VIP_CREATE_NETWORK_FROM_MEMORY, &network);
     if (status == VIP_SUCCESS && network) {
         status = vip_prepare_network(network);
@@ -160,7 +165,7 @@ bool ExecutionImpl::Trigger() {
 };
 
 std::shared_ptr<Execution> Execution::Create(
-    const void* executable, size_t executable_size) {
+    void* executable, size_t executable_size) {
     std::shared_ptr<ExecutionImpl> exec;
     if (executable && executable_size) {
         exec = std::make_shared<ExecutionImpl>(executable, executable_size);
@@ -171,5 +176,43 @@ std::shared_ptr<Execution> Execution::Create(
     return exec;
 }
 
+std::shared_ptr<Execution> Execution::Create(
+    const void* executable, size_t executable_size) {
+    if (!executable || !executable_size) {
+        return nullptr;
+    }
+    // Caller memory may be read-only, the driver gets a private copy
+    std::vector<uint8_t> data(executable_size);
+    memcpy(data.data(), executable, executable_size);
+    return Create(static_cast<void*>(data.data()), data.size());
+}
+
+std::shared_ptr<Execution> Execution::Create(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cout << "Open executable " << path << " failed." << std::endl;
+        return nullptr;
+    }
+    struct stat st;
+    void* addr = MAP_FAILED;
+    size_t size = 0;
+    if (0 == fstat(fd, &st) && st.st_size > 0) {
+        size = static_cast<size_t>(st.st_size);
+        // Copy-on-write, pages the driver patches never reach the file
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (MAP_FAILED == addr) {
+        std::cout << "Map executable " << path << " failed." << std::endl;
+        return nullptr;
+    }
+    auto exec = std::make_shared<ExecutionImpl>(addr, size);
+    munmap(addr, size);
+    if (!exec->IsValid()) {
+        exec.reset();
+    }
+    return exec;
+}
+
 }
 }
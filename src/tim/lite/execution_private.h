@@ -37,7 +37,7 @@ namespace lite {
 
 class ExecutionImpl : public Execution {
  public:
-  ExecutionImpl(const void* executable, size_t executable_size);
+  ExecutionImpl(void* executable, size_t executable_size);
   ~ExecutionImpl();
   std::shared_ptr<Handle> CreateInputHandle(uint32_t in_idx, uint8_t* buffer,
                                             size_t size) override;
@@ -0,0 +1,109 @@
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/transform/layout_inference.h"
+#include "op_impl.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+int64_t TransposedBytes(const std::shared_ptr<tim::vx::Graph>& graph) {
+  int64_t bytes = 0;
+  for (const auto& op : graph->OpVector()) {
+    if (op->impl()->kind_ == VSI_NN_OP_PERMUTE) {
+      bytes += op->impl()->InputsTensor()[0]->GetSpec().GetByteSize();
+    }
+  }
+  return bytes;
+}
+}  // namespace
+
+TEST(Concat, layout_infer_transpose_smaller_input) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  // A small NHWC input is concatenated with a large conv output which
+  // layout inference keeps in WHCN
+  const uint32_t big_c = 32, small_c = 2, out_c = 8, size = 16;
+  tim::vx::ShapeType big_shape({big_c, size, size, 1});      //cwhn
+  tim::vx::ShapeType small_shape({small_c, size, size, 1});  //cwhn
+  tim::vx::ShapeType concat_shape({big_c + small_c, size, size, 1});
+  tim::vx::ShapeType output_shape({out_c, size, size, 1});
+  tim::vx::ShapeType kernel0_shape({big_c, 1, 1, big_c});            //iwho
+  tim::vx::ShapeType kernel1_shape({big_c + small_c, 1, 1, out_c});  //iwho
+
+  tim::vx::TensorSpec big_spec(tim::vx::DataType::FLOAT32, big_shape,
+                               tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec small_spec(tim::vx::DataType::FLOAT32, small_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec conv0out_spec(tim::vx::DataType::FLOAT32, big_shape,
+                                    tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec concat_spec(tim::vx::DataType::FLOAT32, concat_shape,
+                                  tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec kernel0_spec(tim::vx::DataType::FLOAT32, kernel0_shape,
+                                   tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec kernel1_spec(tim::vx::DataType::FLOAT32, kernel1_shape,
+                                   tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, output_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+
+  // conv0 scales by 0.5 * big_c, conv1 weights input channel c by c
+  std::vector<float> kernel0_data(kernel0_spec.GetElementNum(), 0.5f);
+  std::vector<float> kernel1_data(kernel1_spec.GetElementNum());
+  for (uint32_t i = 0; i < kernel1_data.size(); ++i) {
+    kernel1_data[i] = i % (big_c + small_c);
+  }
+
+  auto big_tensor = graph->CreateTensor(big_spec);
+  auto small_tensor = graph->CreateTensor(small_spec);
+  auto conv0out_tensor = graph->CreateTensor(conv0out_spec);
+  auto concat_tensor = graph->CreateTensor(concat_spec);
+  auto kernel0_tensor = graph->CreateTensor(kernel0_spec, kernel0_data.data());
+  auto kernel1_tensor = graph->CreateTensor(kernel1_spec, kernel1_data.data());
+  auto output_tensor = graph->CreateTensor(output_spec);
+
+  std::array<uint32_t, 2> stride({1, 1});
+  std::array<uint32_t, 2> dilation({1, 1});
+  auto conv0 = graph->CreateOperation<tim::vx::ops::Conv2d>(
+      tim::vx::PadType::VALID, stride, dilation, 0, tim::vx::DataLayout::CWHN,
+      tim::vx::DataLayout::IcWHOc);
+  (*conv0).BindInputs({big_tensor, kernel0_tensor}).BindOutput(conv0out_tensor);
+  auto concat = graph->CreateOperation<tim::vx::ops::Concat>(0, 2);
+  (*concat).BindInputs({small_tensor, conv0out_tensor}).BindOutput(concat_tensor);
+  auto conv1 = graph->CreateOperation<tim::vx::ops::Conv2d>(
+      tim::vx::PadType::VALID, stride, dilation, 0, tim::vx::DataLayout::CWHN,
+      tim::vx::DataLayout::IcWHOc);
+  (*conv1).BindInputs({concat_tensor, kernel1_tensor}).BindOutput(output_tensor);
+
+  auto transform = tim::transform::LayoutInference(graph, ctx);
+  auto infer_graph = transform.first;
+  auto graph_io_map = transform.second;
+
+  // Besides the graph input and output of the convs only the small input is
+  // transposed. Taking the first input's layout would transpose the conv
+  // output back and the concat output again for conv1.
+  const int64_t plane = size * size * sizeof(float);
+  int64_t moved = TransposedBytes(infer_graph);
+  RecordProperty("transposed_bytes", std::to_string(moved));
+  EXPECT_EQ(moved, (big_c + small_c + out_c) * plane);
+  EXPECT_LT(moved, (big_c + big_c + (big_c + small_c) + out_c) * plane);
+
+  std::vector<float> big_data(big_spec.GetElementNum(), 1.0f);
+  std::vector<float> small_data(small_spec.GetElementNum(), 1.0f);
+  EXPECT_TRUE(graph_io_map[big_tensor]->CopyDataToTensor(
+      big_data.data(), big_data.size() * sizeof(float)));
+  EXPECT_TRUE(graph_io_map[small_tensor]->CopyDataToTensor(
+      small_data.data(), small_data.size() * sizeof(float)));
+  EXPECT_TRUE(infer_graph->Compile());
+  EXPECT_TRUE(infer_graph->Run());
+
+  float golden_value = 0;
+  for (uint32_t c = 0; c < big_c + small_c; ++c) {
+    golden_value += c * (c < small_c ? 1.0f : 0.5f * big_c);
+  }
+  std::vector<float> golden(output_spec.GetElementNum(), golden_value);
+  std::vector<float> output(golden.size());
+  EXPECT_TRUE(graph_io_map[output_tensor]->CopyDataFromTensor(output.data()));
+  EXPECT_TRUE(ArraysMatch(golden, output, 1e-3f));
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "const_data.h"
+
+#include <algorithm>
+
+#include "graph_private.h"
+#include "tensor_private.h"
+#include "vsi_nn_pub.h"
+
+namespace tim {
+namespace transform {
+
+std::shared_ptr<void> AllocConstData(const std::shared_ptr<vx::Graph>& graph,
+                                     size_t bytes) {
+  auto vsi_graph = static_cast<vx::GraphImpl*>(graph.get())->graph();
+  auto align_start = vsi_graph->handle_manager.align_start_size;
+  auto align_block = vsi_graph->handle_manager.align_block_size;
+  uint8_t* buffer = vsi_nn_MallocAlignedBuffer(std::max<size_t>(bytes, 1),
+                                               align_start, align_block);
+  if (!buffer) {
+    return nullptr;
+  }
+  return std::shared_ptr<void>(buffer, [](void* p) {
+    vsi_nn_FreeAlignedBuffer(static_cast<uint8_t*>(p));
+  });
+}
+
+std::shared_ptr<const void> ReadConstData(
+    const std::shared_ptr<vx::Tensor>& tensor,
+    const std::shared_ptr<vx::Graph>& graph) {
+  if (!tensor->IsConstTensor() || tensor->IsPlaceHolder()) {
+    return nullptr;
+  }
+  std::shared_ptr<const void> data =
+      static_cast<vx::TensorImpl*>(tensor.get())->borrowed_;
+  if (data) {
+    return data;
+  }
+  auto buffer = AllocConstData(graph, tensor->GetSpec().GetByteSize());
+  if (!buffer || !tensor->CopyDataFromTensor(buffer.get())) {
+    VSILOGE("Read constant tensor fail.");
+    return nullptr;
+  }
+  return buffer;
+}
+
+std::shared_ptr<vx::Tensor> CreateConstTensor(
+    const std::shared_ptr<vx::Graph>& graph, const vx::TensorSpec& spec,
+    const std::shared_ptr<const void>& data) {
+  if (!data) {
+    return nullptr;
+  }
+  // The release callback owns a reference to `data`, it's dropped along with
+  // the tensor and the low-level graph
+  return graph->CreateTensor(
+      spec, vx::BorrowedBufferDesc{data.get(), [data](const void*) {}});
+}
+
+}  // namespace transform
+}  // namespace tim
@@ -0,0 +1,55 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_CONST_DATA_H_
+#define TIM_TRANSFORM_CONST_DATA_H_
+
+#include <memory>
+
+#include "tim/vx/graph.h"
+#include "tim/vx/tensor.h"
+
+namespace tim {
+namespace transform {
+
+/// Buffer for the data of a constant created by CreateConstTensor, aligned as
+/// `graph` requires for tensors created from handle
+std::shared_ptr<void> AllocConstData(const std::shared_ptr<vx::Graph>& graph,
+                                     size_t bytes);
+
+/// Host data of constant `tensor`. A tensor with a borrowed buffer lends it,
+/// others are read back once into a buffer from AllocConstData
+std::shared_ptr<const void> ReadConstData(
+    const std::shared_ptr<vx::Tensor>& tensor,
+    const std::shared_ptr<vx::Graph>& graph);
+
+/// Create a constant in `graph` which references `data` without a copy and
+/// keeps it alive as long as `graph` uses it
+std::shared_ptr<vx::Tensor> CreateConstTensor(
+    const std::shared_ptr<vx::Graph>& graph, const vx::TensorSpec& spec,
+    const std::shared_ptr<const void>& data);
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
@@ -0,0 +1,294 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/constant_folding.h"
+
+#include <cstring>
+#include <vector>
+
+#include "builtin_op_impl.h"
+#include "const_data.h"
+#include "graph_rebuilder.h"
+#include "host_kernels.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+
+namespace tim {
+namespace transform {
+namespace {
+
+// Value of a tensor known on the host
+struct HostTensor {
+  vx::TensorSpec spec;
+  std::shared_ptr<const void> data;
+  bool materialized{false};
+};
+
+bool IsFullyKnown(const vx::ShapeType& shape) {
+  for (auto d : shape) {
+    if (d == 0) return false;
+  }
+  return !shape.empty();
+}
+
+// Byte size of a single element, 0 for sub-byte types
+size_t ElementBytes(const vx::TensorSpec& spec) {
+  auto elements = spec.GetElementNum();
+  auto bytes = spec.GetByteSize();
+  return elements > 0 && bytes % elements == 0 ? bytes / elements : 0;
+}
+
+bool SameEncoding(const vx::TensorSpec& a, const vx::TensorSpec& b) {
+  return a.datatype_ == b.datatype_ && a.quantization_ == b.quantization_;
+}
+
+class ConstantFolder {
+ public:
+  ConstantFolder(const std::shared_ptr<vx::Graph>& src_graph,
+                 std::shared_ptr<vx::Context>& ctx)
+      : rebuilder_(src_graph, ctx) {}
+
+  void Run(const std::vector<std::shared_ptr<vx::Operation>>& sorted) {
+    for (const auto& op : sorted) {
+      if (Fold(op)) {
+        ++stats_.folded_ops;
+        continue;
+      }
+      for (const auto& input : op->impl()->InputsTensor()) {
+        Materialize(input);
+      }
+      rebuilder_.Clone(op);
+    }
+  }
+
+  GraphRebuilder& rebuilder() { return rebuilder_; }
+  const ConstantFoldingStats& stats() const { return stats_; }
+
+ private:
+  // Host value of `t`, nullptr unless it is constant or folded
+  HostTensor* Value(const std::shared_ptr<vx::Tensor>& t) {
+    auto it = values_.find(t);
+    if (it != values_.end()) return &it->second;
+    if (!t->IsConstTensor() || t->IsPlaceHolder()) return nullptr;
+    auto data = ReadConstData(t, rebuilder_.graph());
+    if (!data) return nullptr;
+    // Source constants are created by the rebuilder when an op keeps them
+    HostTensor value{t->GetSpec(), data, true};
+    return &values_.emplace(t, std::move(value)).first->second;
+  }
+
+  // Create the constant for a folded result consumed by a kept op
+  void Materialize(const std::shared_ptr<vx::Tensor>& t) {
+    auto it = values_.find(t);
+    if (it == values_.end() || it->second.materialized) return;
+    rebuilder_.Map(
+        t, CreateConstTensor(rebuilder_.graph(), it->second.spec,
+                             it->second.data));
+    it->second.materialized = true;
+    ++stats_.constants;
+  }
+
+  bool Fold(const std::shared_ptr<vx::Operation>& op) {
+    auto inputs = op->impl()->InputsTensor();
+    auto outputs = op->impl()->OutputsTensor();
+    if (inputs.empty() || outputs.size() != 1 ||
+        rebuilder_.IsGraphOutput(outputs[0])) {
+      return false;
+    }
+    std::vector<HostTensor*> in;
+    for (const auto& input : inputs) {
+      auto value = Value(input);
+      if (!value) return false;
+      in.push_back(value);
+    }
+
+    vx::TensorSpec spec = outputs[0]->GetSpec();
+    spec.attr_ = vx::TensorAttribute::CONSTANT;
+    std::shared_ptr<void> data;
+    switch (op->impl()->kind_) {
+      case VSI_NN_OP_RESHAPE:
+      case VSI_NN_OP_RESHAPE2:
+      case VSI_NN_OP_SQUEEZE:
+        data = Reshape(*in[0], spec);
+        break;
+      case VSI_NN_OP_PERMUTE:
+        data = Transpose(op, *in[0], spec);
+        break;
+      case VSI_NN_OP_CONCAT:
+        data = Concat(op, in, spec);
+        break;
+      case VSI_NN_OP_DATACONVERT:
+        data = Convert(*in[0], spec);
+        break;
+      case VSI_NN_OP_ADD:
+        data = Binary(host::BinaryOp::kAdd, in, spec);
+        break;
+      case VSI_NN_OP_SUBTRACT:
+        data = Binary(host::BinaryOp::kSub, in, spec);
+        break;
+      case VSI_NN_OP_MULTIPLY:
+        if (op->impl()->node()->nn_param.multiply.scale != 1.0f) break;
+        data = Binary(host::BinaryOp::kMul, in, spec);
+        break;
+      case VSI_NN_OP_DIVIDE:
+        if (op->impl()->node()->nn_param.divide.scale != 1.0f) break;
+        data = Binary(host::BinaryOp::kDiv, in, spec);
+        break;
+      case VSI_NN_OP_MAXIMUM:
+        data = Binary(host::BinaryOp::kMax, in, spec);
+        break;
+      case VSI_NN_OP_MINIMUM:
+        data = Binary(host::BinaryOp::kMin, in, spec);
+        break;
+      default:
+        break;
+    }
+    if (!data) return false;
+    values_[outputs[0]] = HostTensor{spec, data};
+    return true;
+  }
+
+  std::shared_ptr<void> Alloc(const vx::TensorSpec& spec) {
+    return AllocConstData(rebuilder_.graph(), spec.GetByteSize());
+  }
+
+  std::shared_ptr<void> Reshape(const HostTensor& in,
+                                const vx::TensorSpec& spec) {
+    if (!SameEncoding(in.spec, spec) || !IsFullyKnown(spec.shape_) ||
+        spec.GetElementNum() != in.spec.GetElementNum()) {
+      return nullptr;
+    }
+    auto data = Alloc(spec);
+    if (data) memcpy(data.get(), in.data.get(), spec.GetByteSize());
+    return data;
+  }
+
+  std::shared_ptr<void> Transpose(const std::shared_ptr<vx::Operation>& op,
+                                  const HostTensor& in, vx::TensorSpec& spec) {
+    const auto& param = op->impl()->node()->nn_param.permute;
+    const auto& in_shape = in.spec.shape_;
+    if (!SameEncoding(in.spec, spec) || param.dim_num != in_shape.size()) {
+      return nullptr;
+    }
+    std::vector<uint32_t> perm(param.perm, param.perm + param.dim_num);
+    spec.shape_.resize(perm.size());
+    for (size_t i = 0; i < perm.size(); ++i) {
+      if (perm[i] >= in_shape.size()) return nullptr;
+      spec.shape_[i] = in_shape[perm[i]];
+    }
+    auto data = Alloc(spec);
+    if (!data || !host::Transpose(in.data.get(), in_shape, perm,
+                                  ElementBytes(spec), data.get())) {
+      return nullptr;
+    }
+    return data;
+  }
+
+  std::shared_ptr<void> Concat(const std::shared_ptr<vx::Operation>& op,
+                               const std::vector<HostTensor*>& in,
+                               vx::TensorSpec& spec) {
+    uint32_t axis = op->impl()->node()->nn_param.concat.axis;
+    spec.shape_ = in[0]->spec.shape_;
+    if (axis >= spec.shape_.size()) return nullptr;
+    spec.shape_[axis] = 0;
+    std::vector<const void*> data_in;
+    std::vector<vx::ShapeType> shapes;
+    for (const auto& value : in) {
+      const auto& shape = value->spec.shape_;
+      if (!SameEncoding(value->spec, spec) ||
+          shape.size() != spec.shape_.size()) {
+        return nullptr;
+      }
+      for (size_t d = 0; d < shape.size(); ++d) {
+        if (d != axis && shape[d] != spec.shape_[d]) return nullptr;
+      }
+      spec.shape_[axis] += shape[axis];
+      data_in.push_back(value->data.get());
+      shapes.push_back(shape);
+    }
+    size_t element_bytes = ElementBytes(spec);
+    auto data = element_bytes ? Alloc(spec) : nullptr;
+    if (data) {
+      host::Concat(data_in, shapes, axis, element_bytes, data.get());
+    }
+    return data;
+  }
+
+  std::shared_ptr<void> Convert(const HostTensor& in, vx::TensorSpec& spec) {
+    spec.shape_ = in.spec.shape_;
+    auto data = Alloc(spec);
+    if (!data || !host::Convert(in.data.get(), in.spec, data.get(), spec,
+                                in.spec.GetElementNum())) {
+      return nullptr;
+    }
+    return data;
+  }
+
+  std::shared_ptr<void> Binary(host::BinaryOp binary_op,
+                               const std::vector<HostTensor*>& in,
+                               vx::TensorSpec& spec) {
+    if (in.size() != 2 || !SameEncoding(in[0]->spec, spec) ||
+        !SameEncoding(in[1]->spec, spec) ||
+        spec.quantization_.Type() != vx::QuantType::NONE ||
+        !host::BroadcastShape(in[0]->spec.shape_, in[1]->spec.shape_,
+                              spec.shape_)) {
+      return nullptr;
+    }
+    auto data = Alloc(spec);
+    if (!data || !host::Binary(binary_op, spec.datatype_, in[0]->data.get(),
+                               in[0]->spec.shape_, in[1]->data.get(),
+                               in[1]->spec.shape_, data.get(), spec.shape_)) {
+      return nullptr;
+    }
+    return data;
+  }
+
+  GraphRebuilder rebuilder_;
+  std::map<std::shared_ptr<vx::Tensor>, HostTensor> values_;
+  ConstantFoldingStats stats_;
+};
+
+}  // namespace
+
+std::pair<std::shared_ptr<vx::Graph>,
+          std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+ConstantFolding(const std::shared_ptr<vx::Graph>& src_graph,
+                std::shared_ptr<vx::Context>& ctx,
+                ConstantFoldingStats* stats) {
+  std::vector<std::shared_ptr<vx::Operation>> sorted;
+  if (!SortOps(src_graph, sorted)) {
+    VSILOGE("Graph has a cycle, constants are not folded.");
+    return std::make_pair(nullptr, std::map<std::shared_ptr<vx::Tensor>,
+                                            std::shared_ptr<vx::Tensor>>());
+  }
+
+  ConstantFolder folder(src_graph, ctx);
+  folder.Run(sorted);
+  if (stats) *stats = folder.stats();
+  return std::make_pair(folder.rebuilder().graph(),
+                        folder.rebuilder().io_map());
+}
+
+}  // namespace transform
+}  // namespace tim
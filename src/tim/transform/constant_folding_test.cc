@@ -0,0 +1,135 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/constant_folding.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+TEST(ConstantFolding, transpose_add_concat) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 6},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {2, 6},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec a_spec(tim::vx::DataType::FLOAT32, {3, 2},
+                             tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec b_spec(tim::vx::DataType::FLOAT32, {2, 1},
+                             tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec c_spec(tim::vx::DataType::FLOAT32, {2, 3},
+                             tim::vx::TensorAttribute::CONSTANT);
+  // Transient shapes are left to be inferred
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, {0, 0},
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  std::vector<float> a_data{1, 2, 3, 4, 5, 6};
+  std::vector<float> b_data{10, 20};
+  std::vector<float> c_data{-1, -2, -3, -4, -5, -6};
+
+  auto input = graph->CreateTensor(input_spec);
+  auto output = graph->CreateTensor(output_spec);
+  auto transposed = graph->CreateTensor(transient_spec);
+  auto shifted = graph->CreateTensor(transient_spec);
+  auto concatenated = graph->CreateTensor(transient_spec);
+  graph
+      ->CreateOperation<tim::vx::ops::Transpose>(
+          std::vector<uint32_t>({1, 0}))
+      ->BindInput(graph->CreateTensor(a_spec, a_data.data()))
+      .BindOutput(transposed);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({transposed, graph->CreateTensor(b_spec, b_data.data())})
+      .BindOutput(shifted);
+  graph->CreateOperation<tim::vx::ops::Concat>(1, 2)
+      ->BindInputs({shifted, graph->CreateTensor(c_spec, c_data.data())})
+      .BindOutput(concatenated);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({input, concatenated})
+      .BindOutput(output);
+
+  tim::transform::ConstantFoldingStats stats;
+  auto folded = tim::transform::ConstantFolding(graph, ctx, &stats);
+  ASSERT_NE(folded.first, nullptr);
+  EXPECT_EQ(stats.folded_ops, 3u);
+  EXPECT_EQ(stats.constants, 1u);
+  EXPECT_EQ(folded.first->OpVector().size(), 1u);
+
+  std::vector<float> input_data(12, 0.5f);
+  std::vector<float> golden{11.5f, 24.5f, 12.5f, 25.5f, 13.5f, 26.5f,
+                            -0.5f, -1.5f, -2.5f, -3.5f, -4.5f, -5.5f};
+  auto result = RunGraph(folded.first, folded.second[input],
+                         folded.second[output], input_data);
+  EXPECT_TRUE(ArraysMatch(golden, result, 1e-5f));
+}
+
+TEST(ConstantFolding, dequantize_weights_keep_output) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::Quantization quant(tim::vx::QuantType::ASYMMETRIC, 0.5f, 10);
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {4},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {4},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec weight_spec(tim::vx::DataType::UINT8, {4},
+                                  tim::vx::TensorAttribute::CONSTANT, quant);
+  tim::vx::TensorSpec float_spec(tim::vx::DataType::FLOAT32, {4},
+                                 tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec scalar_spec(tim::vx::DataType::FLOAT32, {1},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  std::vector<uint8_t> weight_data{10, 12, 14, 20};
+  float one = 1.0f;
+
+  auto input = graph->CreateTensor(input_spec);
+  auto output = graph->CreateTensor(output_spec);
+  auto dequantized = graph->CreateTensor(float_spec);
+  auto product = graph->CreateTensor(float_spec);
+  // Output of all constant inputs, it can't be replaced by a constant
+  auto const_output = graph->CreateTensor(output_spec);
+  graph->CreateOperation<tim::vx::ops::DataConvert>()
+      ->BindInput(graph->CreateTensor(weight_spec, weight_data.data()))
+      .BindOutput(dequantized);
+  graph->CreateOperation<tim::vx::ops::Multiply>()
+      ->BindInputs({input, dequantized})
+      .BindOutput(product);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({product, dequantized})
+      .BindOutput(output);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({dequantized, graph->CreateTensor(scalar_spec, &one)})
+      .BindOutput(const_output);
+
+  tim::transform::ConstantFoldingStats stats;
+  auto folded = tim::transform::ConstantFolding(graph, ctx, &stats);
+  ASSERT_NE(folded.first, nullptr);
+  EXPECT_EQ(stats.folded_ops, 1u);
+  EXPECT_EQ(stats.constants, 1u);
+  EXPECT_EQ(folded.first->OpVector().size(), 3u);
+
+  std::vector<float> input_data{1, 2, 3, 4};
+  std::vector<float> golden{0, 3, 8, 25};
+  auto result = RunGraph(folded.first, folded.second[input],
+                         folded.second[output], input_data);
+  EXPECT_TRUE(ArraysMatch(golden, result, 1e-5f));
+}
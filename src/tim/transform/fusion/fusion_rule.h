@@ -0,0 +1,110 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_FUSION_FUSION_RULE_H_
+#define TIM_TRANSFORM_FUSION_FUSION_RULE_H_
+
+#include <memory>
+#include <vector>
+
+#include "builtin_op_impl.h"
+#include "graph_rebuilder.h"
+#include "pattern.h"
+
+namespace tim {
+namespace transform {
+namespace fusion {
+
+/// Replaces the ops matched by one of its patterns with a fused op
+class FusionRule {
+ public:
+  virtual ~FusionRule() = default;
+
+  /// Patterns tried in order at every candidate root op
+  const std::vector<Pattern>& Patterns() const { return patterns_; }
+
+  /// Check what the structure of a match doesn't tell, e.g. parameter shapes
+  virtual bool Accept(const Match& match) const {
+    (void)match;
+    return true;
+  }
+
+  /// Create the fused op in the rebuilt graph, writing the mapped output of
+  /// `root`
+  virtual void Rewrite(const Match& match,
+                       const std::shared_ptr<vx::Operation>& root,
+                       GraphRebuilder& rebuilder) = 0;
+
+ protected:
+  static std::shared_ptr<vx::Tensor> RootOutput(
+      const std::shared_ptr<vx::Operation>& root, GraphRebuilder& rebuilder) {
+    return rebuilder.MapOutput(root->impl()->OutputsTensor()[0]);
+  }
+
+  /// Axis reduced by a reduce op matched by `Reduce`, in [0, rank)
+  static int32_t ReduceAxis(const std::shared_ptr<vx::Operation>& reduce,
+                            const std::shared_ptr<vx::Tensor>& input) {
+    int32_t axis = reduce->impl()->node()->nn_param.reduce.axis[0];
+    return axis < 0 ? axis + static_cast<int32_t>(input->GetShape().size())
+                    : axis;
+  }
+
+  /// `param` is a scalar or holds `size` values along axis 0 only
+  static bool IsScalarOrSize(const std::shared_ptr<vx::Tensor>& param,
+                             uint32_t size) {
+    const auto& shape = param->GetShape();
+    if (param->GetSpec().GetElementNum() == 1) return true;
+    if (shape.empty() || shape[0] != size) return false;
+    for (size_t i = 1; i < shape.size(); ++i) {
+      if (shape[i] != 1) return false;
+    }
+    return true;
+  }
+
+  /// 1-D float32 constant of `size` elements in the rebuilt graph holding
+  /// `param`, broadcast if it is a scalar, or `fill` without `param`
+  static std::shared_ptr<vx::Tensor> CreateParamTensor(
+      const std::shared_ptr<vx::Tensor>& param, uint32_t size, float fill,
+      GraphRebuilder& rebuilder) {
+    std::vector<float> data(size, fill);
+    if (param) {
+      float* param_data = param->ConvertTensorToFloat32Data();
+      bool scalar = param->GetSpec().GetElementNum() == 1;
+      for (uint32_t i = 0; i < size; ++i) {
+        data[i] = param_data[scalar ? 0 : i];
+      }
+      vsi_nn_Free(param_data);
+    }
+    vx::TensorSpec spec(vx::DataType::FLOAT32, {size},
+                        vx::TensorAttribute::CONSTANT);
+    return rebuilder.graph()->CreateTensor(spec, data.data());
+  }
+
+  std::vector<Pattern> patterns_;
+};
+
+}  // namespace fusion
+}  // namespace transform
+}  // namespace tim
+
+#endif
@@ -0,0 +1,75 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_FUSION_GELU_FUSION_H_
+#define TIM_TRANSFORM_FUSION_GELU_FUSION_H_
+
+#include <cmath>
+
+#include "fusion/fusion_rule.h"
+#include "tim/vx/ops/activations.h"
+
+namespace tim {
+namespace transform {
+namespace fusion {
+
+/* x * 0.5 * (1 + erf(x / sqrt(2))) and its tanh approximation
+   x * 0.5 * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3))), with the
+   multiplications in any of the orders exporters emit */
+class GeluFusion : public FusionRule {
+ public:
+  GeluFusion() : x_(Input()) {
+    auto erf = Op(VSI_NN_OP_ERF, {AnyOf({Div(x_, Scalar(std::sqrt(2.0f))),
+                                         Mul(x_, Scalar(std::sqrt(0.5f)))})});
+    auto cube =
+        AnyOf({Op(VSI_NN_OP_POW, {x_, Scalar(3.0f)}), Mul(x_, Square(x_))});
+    tanh_ = Op(VSI_NN_OP_TANH,
+               {Mul(Add(x_, Mul(cube, Scalar(0.044715f))),
+                    Scalar(std::sqrt(2.0f / static_cast<float>(M_PI))))});
+    for (const auto& cdf : {erf, tanh_}) {
+      auto one_plus = Add(cdf, Scalar(1.0f));
+      patterns_.push_back(AnyOf({Mul(Mul(x_, one_plus), Scalar(0.5f)),
+                                 Mul(x_, Mul(one_plus, Scalar(0.5f))),
+                                 Mul(Mul(x_, Scalar(0.5f)), one_plus)}));
+    }
+  }
+
+  void Rewrite(const Match& match, const std::shared_ptr<vx::Operation>& root,
+               GraphRebuilder& rebuilder) override {
+    bool approximate = match.op(tanh_) != nullptr;
+    rebuilder.graph()
+        ->CreateOperation<vx::ops::Gelu>(approximate)
+        ->BindInput(rebuilder.Mapped(match.tensor(x_)))
+        .BindOutput(RootOutput(root, rebuilder));
+  }
+
+ private:
+  Pattern x_;
+  Pattern tanh_;
+};
+
+}  // namespace fusion
+}  // namespace transform
+}  // namespace tim
+
+#endif
@@ -0,0 +1,79 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_FUSION_HARDSWISH_FUSION_H_
+#define TIM_TRANSFORM_FUSION_HARDSWISH_FUSION_H_
+
+#include <cmath>
+
+#include "fusion/fusion_rule.h"
+#include "tim/vx/ops/activations.h"
+
+namespace tim {
+namespace transform {
+namespace fusion {
+
+/* x * relu6(x + 3) / 6, with relu6 also as clip(0, 6), and
+   x * hard_sigmoid(x) with alpha 1/6 and beta 0.5 */
+class HardSwishFusion : public FusionRule {
+ public:
+  HardSwishFusion() : x_(Input()) {
+    auto shifted = Add(x_, Scalar(3.0f));
+    auto relu6 = AnyOf(
+        {Op(VSI_NN_OP_RELU6, {shifted}),
+         Op(VSI_NN_OP_CLIP, {shifted},
+            [](const std::shared_ptr<vx::Operation>& op) {
+              auto& param = op->impl()->node()->nn_param.clip;
+              return param.min == 0.0f && param.max == 6.0f;
+            })});
+    auto hard_sigmoid =
+        Op(VSI_NN_OP_HARD_SIGMOID, {x_},
+           [](const std::shared_ptr<vx::Operation>& op) {
+             auto& param = op->impl()->node()->nn_param.hard_sigmoid;
+             return std::fabs(param.alpha - 1.0f / 6) < 1e-4f &&
+                    std::fabs(param.beta - 0.5f) < 1e-4f;
+           });
+    patterns_.push_back(AnyOf({Div(Mul(x_, relu6), Scalar(6.0f)),
+                               Mul(Mul(x_, relu6), Scalar(1.0f / 6)),
+                               Mul(x_, Div(relu6, Scalar(6.0f))),
+                               Mul(x_, Mul(relu6, Scalar(1.0f / 6))),
+                               Mul(x_, hard_sigmoid)}));
+  }
+
+  void Rewrite(const Match& match, const std::shared_ptr<vx::Operation>& root,
+               GraphRebuilder& rebuilder) override {
+    rebuilder.graph()
+        ->CreateOperation<vx::ops::HardSwish>()
+        ->BindInput(rebuilder.Mapped(match.tensor(x_)))
+        .BindOutput(RootOutput(root, rebuilder));
+  }
+
+ private:
+  Pattern x_;
+};
+
+}  // namespace fusion
+}  // namespace transform
+}  // namespace tim
+
+#endif
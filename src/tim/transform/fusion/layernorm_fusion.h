@@ -0,0 +1,97 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_FUSION_LAYERNORM_FUSION_H_
+#define TIM_TRANSFORM_FUSION_LAYERNORM_FUSION_H_
+
+#include "fusion/fusion_rule.h"
+#include "tim/vx/ops/layernormalization.h"
+
+namespace tim {
+namespace transform {
+namespace fusion {
+
+/* d = x - mean(x), d / sqrt(mean(d^2) + eps) or d * rsqrt(mean(d^2) + eps),
+   optionally scaled by gamma and shifted by beta. Normalizing the innermost
+   axis only, whose 1-D gamma and beta LayerNormalization takes. */
+class LayerNormFusion : public FusionRule {
+ public:
+  LayerNormFusion()
+      : x_(Input()),
+        mean_(Reduce(VSI_NN_REDUCE_MEAN, x_)),
+        eps_(Const([](const std::shared_ptr<vx::Tensor>& t) {
+          return t->GetSpec().GetElementNum() == 1;
+        })),
+        gamma_(Const()),
+        beta_(Const()) {
+    auto d = Sub(x_, mean_);
+    var_ = Reduce(VSI_NN_REDUCE_MEAN, Square(d));
+    auto var_eps = Add(var_, eps_);
+    auto normed = AnyOf({Div(d, Op(VSI_NN_OP_SQRT, {var_eps})),
+                         Mul(d, Op(VSI_NN_OP_RSQRT, {var_eps}))});
+    patterns_.push_back(Add(Mul(normed, gamma_), beta_));
+    patterns_.push_back(Mul(normed, gamma_));
+    patterns_.push_back(normed);
+  }
+
+  bool Accept(const Match& match) const override {
+    auto x = match.tensor(x_);
+    if (ReduceAxis(match.op(mean_), x) != 0 ||
+        ReduceAxis(match.op(var_), x) != 0) {
+      return false;
+    }
+    uint32_t size = x->GetShape()[0];
+    auto gamma = match.tensor(gamma_);
+    auto beta = match.tensor(beta_);
+    return (!gamma || IsScalarOrSize(gamma, size)) &&
+           (!beta || IsScalarOrSize(beta, size));
+  }
+
+  void Rewrite(const Match& match, const std::shared_ptr<vx::Operation>& root,
+               GraphRebuilder& rebuilder) override {
+    auto x = match.tensor(x_);
+    uint32_t size = x->GetShape()[0];
+    auto beta = CreateParamTensor(match.tensor(beta_), size, 0.0f, rebuilder);
+    auto gamma =
+        CreateParamTensor(match.tensor(gamma_), size, 1.0f, rebuilder);
+    rebuilder.graph()
+        ->CreateOperation<vx::ops::LayerNormalization>(
+            0, ScalarValue(match.tensor(eps_)))
+        ->BindInputs({rebuilder.Mapped(x), beta, gamma})
+        .BindOutput(RootOutput(root, rebuilder));
+  }
+
+ private:
+  Pattern x_;
+  Pattern mean_;
+  Pattern var_;
+  Pattern eps_;
+  Pattern gamma_;
+  Pattern beta_;
+};
+
+}  // namespace fusion
+}  // namespace transform
+}  // namespace tim
+
+#endif
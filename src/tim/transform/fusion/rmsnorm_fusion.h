@@ -0,0 +1,86 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_FUSION_RMSNORM_FUSION_H_
+#define TIM_TRANSFORM_FUSION_RMSNORM_FUSION_H_
+
+#include "fusion/fusion_rule.h"
+#include "tim/vx/ops/rmsnormalization.h"
+
+#ifdef VSI_FEAT_OP_RMSNORM
+
+namespace tim {
+namespace transform {
+namespace fusion {
+
+/* x / sqrt(mean(x^2) + eps) or x * rsqrt(mean(x^2) + eps), optionally
+   scaled by gamma, over the innermost axis */
+class RMSNormFusion : public FusionRule {
+ public:
+  RMSNormFusion()
+      : x_(Input()),
+        mean_(Reduce(VSI_NN_REDUCE_MEAN, Square(x_))),
+        eps_(Const([](const std::shared_ptr<vx::Tensor>& t) {
+          return t->GetSpec().GetElementNum() == 1;
+        })),
+        gamma_(Const()) {
+    auto mean_eps = Add(mean_, eps_);
+    auto normed = AnyOf({Div(x_, Op(VSI_NN_OP_SQRT, {mean_eps})),
+                         Mul(x_, Op(VSI_NN_OP_RSQRT, {mean_eps}))});
+    patterns_.push_back(Mul(normed, gamma_));
+    patterns_.push_back(normed);
+  }
+
+  bool Accept(const Match& match) const override {
+    auto x = match.tensor(x_);
+    auto gamma = match.tensor(gamma_);
+    return ReduceAxis(match.op(mean_), x) == 0 &&
+           (!gamma || IsScalarOrSize(gamma, x->GetShape()[0]));
+  }
+
+  void Rewrite(const Match& match, const std::shared_ptr<vx::Operation>& root,
+               GraphRebuilder& rebuilder) override {
+    auto x = match.tensor(x_);
+    auto gamma = CreateParamTensor(match.tensor(gamma_), x->GetShape()[0],
+                                   1.0f, rebuilder);
+    rebuilder.graph()
+        ->CreateOperation<vx::ops::RMSNormalization>(
+            0, ScalarValue(match.tensor(eps_)))
+        ->BindInputs({rebuilder.Mapped(x), gamma})
+        .BindOutput(RootOutput(root, rebuilder));
+  }
+
+ private:
+  Pattern x_;
+  Pattern mean_;
+  Pattern eps_;
+  Pattern gamma_;
+};
+
+}  // namespace fusion
+}  // namespace transform
+}  // namespace tim
+
+#endif  // VSI_FEAT_OP_RMSNORM
+
+#endif
@@ -0,0 +1,70 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_FUSION_SOFTMAX_FUSION_H_
+#define TIM_TRANSFORM_FUSION_SOFTMAX_FUSION_H_
+
+#include "fusion/fusion_rule.h"
+#include "tim/vx/ops/softmax.h"
+
+namespace tim {
+namespace transform {
+namespace fusion {
+
+/* e = exp(x - reduce_max(x)) or exp(x), e / reduce_sum(e) */
+class SoftmaxFusion : public FusionRule {
+ public:
+  SoftmaxFusion()
+      : x_(Input()), max_(Reduce(VSI_NN_REDUCE_MAX, x_)) {
+    auto e = Op(VSI_NN_OP_EXP, {AnyOf({Sub(x_, max_), x_})});
+    sum_ = Reduce(VSI_NN_REDUCE_SUM, e);
+    patterns_.push_back(Div(e, sum_));
+  }
+
+  bool Accept(const Match& match) const override {
+    auto x = match.tensor(x_);
+    auto max = match.op(max_);
+    return !max || ReduceAxis(max, x) == ReduceAxis(match.op(sum_), x);
+  }
+
+  void Rewrite(const Match& match, const std::shared_ptr<vx::Operation>& root,
+               GraphRebuilder& rebuilder) override {
+    auto x = match.tensor(x_);
+    rebuilder.graph()
+        ->CreateOperation<vx::ops::Softmax>(1.0f,
+                                            ReduceAxis(match.op(sum_), x))
+        ->BindInput(rebuilder.Mapped(x))
+        .BindOutput(RootOutput(root, rebuilder));
+  }
+
+ private:
+  Pattern x_;
+  Pattern max_;
+  Pattern sum_;
+};
+
+}  // namespace fusion
+}  // namespace transform
+}  // namespace tim
+
+#endif
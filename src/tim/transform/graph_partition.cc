@@ -0,0 +1,211 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/graph_partition.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "builtin_op_impl.h"
+#include "const_data.h"
+#include "graph_rebuilder.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+
+namespace tim {
+namespace transform {
+namespace {
+
+using TensorMap =
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>;
+
+uint64_t ElementCount(const vx::ShapeType& shape) {
+  uint64_t count = 1;
+  for (auto d : shape) count *= d;
+  return count;
+}
+
+uint64_t EstimateCost(const std::shared_ptr<vx::Operation>& op) {
+  uint64_t cost = 0;
+  for (const auto& out : op->impl()->OutputsTensor()) {
+    cost += ElementCount(out->GetShape());
+  }
+  for (const auto& in : op->impl()->InputsTensor()) {
+    const auto& shape = in->GetShape();
+    if (in->IsConstTensor() && shape.size() >= 2 && shape.back() > 0) {
+      // Weights are laid out with the output channel last
+      cost *= std::max<uint64_t>(1, ElementCount(shape) / shape.back());
+      break;
+    }
+  }
+  return std::max<uint64_t>(cost, 1);
+}
+
+/// Build the stages of `sorted` ops, `stages[i]` is the stage of `sorted[i]`
+/// and never decreases along a tensor
+std::vector<GraphPartition> BuildStages(
+    const std::shared_ptr<vx::Graph>& src_graph,
+    const std::vector<std::shared_ptr<vx::Operation>>& sorted,
+    const std::vector<uint32_t>& stages,
+    const std::vector<std::shared_ptr<vx::Context>>& contexts) {
+  std::map<std::shared_ptr<vx::Operation>, uint32_t> op_stage;
+  uint32_t stage_count = 0;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    op_stage[sorted[i]] = stages[i];
+    stage_count = std::max(stage_count, stages[i] + 1);
+  }
+  auto outputs = src_graph->OutputsTensor();
+  std::set<std::shared_ptr<vx::Tensor>> graph_outputs(outputs.begin(),
+                                                      outputs.end());
+  // A tensor leaves its stage if it's a graph output or read by a later stage
+  auto leaves_stage = [&](const std::shared_ptr<vx::Tensor>& t,
+                          uint32_t stage) {
+    if (graph_outputs.count(t)) return true;
+    for (const auto& consumer : src_graph->GetConsumersOp(t)) {
+      auto it = op_stage.find(consumer);
+      if (it != op_stage.end() && it->second > stage) return true;
+    }
+    return false;
+  };
+
+  std::vector<GraphPartition> partitions;
+  for (uint32_t stage = 0; stage < stage_count; ++stage) {
+    GraphPartition part;
+    TensorMap mapped;
+    auto map_input = [&](const std::shared_ptr<vx::Tensor>& t) {
+      auto it = mapped.find(t);
+      if (it != mapped.end()) {
+        return it->second;
+      }
+      std::shared_ptr<vx::Tensor> input;
+      if (t->IsPlaceHolder()) {
+        input = part.graph->CreateTensorPlaceHolder();
+      } else if (t->IsConstTensor()) {
+        input = CreateConstTensor(part.graph, t->GetSpec(),
+                                  ReadConstData(t, part.graph));
+      } else {
+        auto spec = t->GetSpec();
+        spec.SetAttribute(vx::TensorAttribute::INPUT);
+        input = part.graph->CreateTensor(spec);
+        part.src_inputs.push_back(t);
+      }
+      mapped[t] = input;
+      return input;
+    };
+
+    for (size_t i = 0; i < sorted.size(); ++i) {
+      if (stages[i] != stage) continue;
+      const auto& op = sorted[i];
+      if (!part.graph) {
+        const auto& ctx = contexts[partitions.size() % contexts.size()];
+        part.graph = ctx->CreateGraph();
+      }
+      auto cloned_op = op->Clone(part.graph);
+      for (const auto& in : op->impl()->InputsTensor()) {
+        cloned_op->BindInput(map_input(in));
+      }
+      std::vector<std::shared_ptr<vx::Tensor>> outs;
+      for (const auto& out : op->impl()->OutputsTensor()) {
+        auto spec = out->GetSpec();
+        bool leaves = leaves_stage(out, stage);
+        spec.SetAttribute(leaves ? vx::TensorAttribute::OUTPUT
+                                 : vx::TensorAttribute::TRANSIENT);
+        auto t = part.graph->CreateTensor(spec);
+        if (leaves) part.src_outputs.push_back(out);
+        mapped[out] = t;
+        outs.push_back(t);
+      }
+      cloned_op->BindOutputs(outs);
+    }
+    if (part.graph) {
+      partitions.push_back(std::move(part));
+    }
+  }
+  return partitions;
+}
+
+}  // namespace
+
+std::vector<GraphPartition> PartitionGraph(
+    const std::shared_ptr<vx::Graph>& src_graph,
+    const std::vector<std::vector<std::shared_ptr<vx::Tensor>>>& boundaries,
+    const std::vector<std::shared_ptr<vx::Context>>& contexts) {
+  std::vector<std::shared_ptr<vx::Operation>> sorted;
+  if (contexts.empty() || !SortOps(src_graph, sorted)) {
+    VSILOGE("Graph has a cycle or no context given, graph is not partitioned.");
+    return {};
+  }
+  // First stage a tensor may be read in
+  std::map<std::shared_ptr<vx::Tensor>, uint32_t> tensor_stage;
+  for (uint32_t i = 0; i < boundaries.size(); ++i) {
+    for (const auto& t : boundaries[i]) {
+      tensor_stage[t] = std::max(tensor_stage[t], i + 1);
+    }
+  }
+  std::vector<uint32_t> stages(sorted.size(), 0);
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    for (const auto& in : sorted[i]->impl()->InputsTensor()) {
+      auto it = tensor_stage.find(in);
+      if (it != tensor_stage.end()) {
+        stages[i] = std::max(stages[i], it->second);
+      }
+    }
+    for (const auto& out : sorted[i]->impl()->OutputsTensor()) {
+      auto& stage = tensor_stage[out];
+      stage = std::max(stage, stages[i]);
+    }
+  }
+  return BuildStages(src_graph, sorted, stages, contexts);
+}
+
+std::vector<GraphPartition> PartitionGraphByCost(
+    const std::shared_ptr<vx::Graph>& src_graph, uint32_t stage_count,
+    const std::vector<std::shared_ptr<vx::Context>>& contexts) {
+  std::vector<std::shared_ptr<vx::Operation>> sorted;
+  if (contexts.empty() || !SortOps(src_graph, sorted)) {
+    VSILOGE("Graph has a cycle or no context given, graph is not partitioned.");
+    return {};
+  }
+  stage_count = std::max<uint32_t>(stage_count, 1);
+  std::vector<uint64_t> costs;
+  uint64_t total = 0;
+  for (const auto& op : sorted) {
+    costs.push_back(EstimateCost(op));
+    total += costs.back();
+  }
+  // An op goes to the stage its cost midpoint falls in
+  std::vector<uint32_t> stages(sorted.size(), 0);
+  uint64_t done = 0;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    uint64_t mid = done + costs[i] / 2;
+    stages[i] = std::min<uint32_t>(
+        static_cast<uint32_t>(mid * stage_count / total), stage_count - 1);
+    done += costs[i];
+  }
+  return BuildStages(src_graph, sorted, stages, contexts);
+}
+
+}  // namespace transform
+}  // namespace tim
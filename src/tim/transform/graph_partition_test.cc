@@ -0,0 +1,128 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/graph_partition.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+
+#include "gtest/gtest.h"
+
+TEST(GraphPartition, at_tensor_boundary) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType shape({4});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  std::vector<float> bias_data = {1, 1, 1, 1};
+  auto input = graph->CreateTensor(input_spec);
+  auto bias = graph->CreateTensor(const_spec, bias_data.data());
+  auto biased = graph->CreateTensor(transient_spec);
+  auto relu_out = graph->CreateTensor(transient_spec);
+  auto output = graph->CreateTensor(output_spec);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({input, bias})
+      .BindOutput(biased);
+  graph->CreateOperation<tim::vx::ops::Relu>()
+      ->BindInput(biased)
+      .BindOutput(relu_out);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({relu_out, input})
+      .BindOutput(output);
+
+  auto stages = tim::transform::PartitionGraph(graph, {{biased}}, {ctx});
+  ASSERT_EQ(stages.size(), 2u);
+  EXPECT_EQ(stages[0].graph->OpVector().size(), 1u);
+  EXPECT_EQ(stages[0].src_inputs,
+            std::vector<std::shared_ptr<tim::vx::Tensor>>({input}));
+  EXPECT_EQ(stages[0].src_outputs,
+            std::vector<std::shared_ptr<tim::vx::Tensor>>({biased}));
+  EXPECT_EQ(stages[1].graph->OpVector().size(), 2u);
+  EXPECT_EQ(stages[1].src_inputs,
+            std::vector<std::shared_ptr<tim::vx::Tensor>>({biased, input}));
+  EXPECT_EQ(stages[1].src_outputs,
+            std::vector<std::shared_ptr<tim::vx::Tensor>>({output}));
+
+  std::vector<float> in_data = {-3, -1, 1, 3};
+  std::vector<float> biased_data(4);
+  std::vector<float> golden = {-3, -1, 3, 7};
+  auto& stage0 = stages[0].graph;
+  auto& stage1 = stages[1].graph;
+  EXPECT_TRUE(stage0->Compile());
+  EXPECT_TRUE(stage1->Compile());
+  EXPECT_TRUE(stage0->InputsTensor()[0]->CopyDataToTensor(
+      in_data.data(), in_data.size() * sizeof(float)));
+  EXPECT_TRUE(stage0->Run());
+  EXPECT_TRUE(stage0->OutputsTensor()[0]->CopyDataFromTensor(
+      biased_data.data()));
+  EXPECT_TRUE(stage1->InputsTensor()[0]->CopyDataToTensor(
+      biased_data.data(), biased_data.size() * sizeof(float)));
+  EXPECT_TRUE(stage1->InputsTensor()[1]->CopyDataToTensor(
+      in_data.data(), in_data.size() * sizeof(float)));
+  EXPECT_TRUE(stage1->Run());
+
+  std::vector<float> out_data(golden.size());
+  EXPECT_TRUE(stage1->OutputsTensor()[0]->CopyDataFromTensor(out_data.data()));
+  EXPECT_EQ(golden, out_data);
+}
+
+TEST(GraphPartition, by_cost) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType shape({8, 8});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  std::vector<std::shared_ptr<tim::vx::Tensor>> tensors = {
+      graph->CreateTensor(input_spec)};
+  for (int i = 0; i < 4; ++i) {
+    tensors.push_back(
+        graph->CreateTensor(i == 3 ? output_spec : transient_spec));
+    graph->CreateOperation<tim::vx::ops::Relu>()
+        ->BindInput(tensors[i])
+        .BindOutput(tensors[i + 1]);
+  }
+
+  auto ctx1 = tim::vx::Context::Create();
+  auto stages = tim::transform::PartitionGraphByCost(graph, 2, {ctx, ctx1});
+  ASSERT_EQ(stages.size(), 2u);
+  EXPECT_EQ(stages[0].graph->OpVector().size(), 2u);
+  EXPECT_EQ(stages[1].graph->OpVector().size(), 2u);
+  EXPECT_EQ(stages[0].src_outputs,
+            std::vector<std::shared_ptr<tim::vx::Tensor>>({tensors[2]}));
+  EXPECT_EQ(stages[1].src_inputs,
+            std::vector<std::shared_ptr<tim::vx::Tensor>>({tensors[2]}));
+  EXPECT_TRUE(stages[0].graph->Compile());
+  EXPECT_TRUE(stages[1].graph->Compile());
+}
@@ -0,0 +1,127 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "graph_rebuilder.h"
+
+#include <algorithm>
+#include <queue>
+
+#include "builtin_op_impl.h"
+#include "const_data.h"
+
+namespace tim {
+namespace transform {
+
+bool SortOps(const std::shared_ptr<vx::Graph>& graph,
+             std::vector<std::shared_ptr<vx::Operation>>& sorted) {
+  auto& ops = graph->OpVector();
+  std::map<std::shared_ptr<vx::Operation>, uint32_t> indegree;
+  std::queue<std::shared_ptr<vx::Operation>> ready;
+  for (const auto& op : ops) {
+    uint32_t cnt = 0;
+    for (const auto& in : op->impl()->InputsTensor()) {
+      if (graph->GetProducerOp(in)) ++cnt;
+    }
+    indegree[op] = cnt;
+    if (cnt == 0) ready.push(op);
+  }
+  while (!ready.empty()) {
+    auto op = ready.front();
+    ready.pop();
+    sorted.push_back(op);
+    for (const auto& out : op->impl()->OutputsTensor()) {
+      auto consumers = graph->GetConsumersOp(out);
+      std::sort(consumers.begin(), consumers.end());
+      consumers.erase(std::unique(consumers.begin(), consumers.end()),
+                      consumers.end());
+      for (const auto& consumer : consumers) {
+        auto it = indegree.find(consumer);
+        if (it == indegree.end()) continue;
+        for (const auto& in : consumer->impl()->InputsTensor()) {
+          if (in == out && --it->second == 0) ready.push(consumer);
+        }
+      }
+    }
+  }
+  return sorted.size() == ops.size();
+}
+
+GraphRebuilder::GraphRebuilder(const std::shared_ptr<vx::Graph>& src_graph,
+                               std::shared_ptr<vx::Context>& ctx)
+    : src_graph_(src_graph), graph_(ctx->CreateGraph()) {
+  for (const auto& in : src_graph_->InputsTensor()) {
+    auto t = graph_->CreateTensor(in->GetSpec());
+    mapped_[in] = t;
+    io_map_[in] = t;
+  }
+  for (const auto& out : src_graph_->OutputsTensor()) {
+    auto t = graph_->CreateTensor(out->GetSpec());
+    outputs_[out] = t;
+    io_map_[out] = t;
+  }
+}
+
+std::shared_ptr<vx::Tensor> GraphRebuilder::Mapped(
+    const std::shared_ptr<vx::Tensor>& t) {
+  auto it = mapped_.find(t);
+  if (it != mapped_.end()) {
+    return it->second;
+  }
+  std::shared_ptr<vx::Tensor> mapped;
+  if (t->IsPlaceHolder()) {
+    mapped = graph_->CreateTensorPlaceHolder();
+  } else if (t->IsConstTensor()) {
+    mapped = CreateConstTensor(graph_, t->GetSpec(), ReadConstData(t, graph_));
+  } else {
+    VSILOGE("Tensor is used before it's produced.");
+    return nullptr;
+  }
+  mapped_[t] = mapped;
+  return mapped;
+}
+
+std::shared_ptr<vx::Tensor> GraphRebuilder::MapOutput(
+    const std::shared_ptr<vx::Tensor>& t) {
+  auto it = outputs_.find(t);
+  auto mapped =
+      it != outputs_.end() ? it->second : graph_->CreateTensor(t->GetSpec());
+  mapped_[t] = mapped;
+  return mapped;
+}
+
+std::shared_ptr<vx::Operation> GraphRebuilder::Clone(
+    const std::shared_ptr<vx::Operation>& op) {
+  auto cloned_op = op->Clone(graph_);
+  for (const auto& in : op->impl()->InputsTensor()) {
+    cloned_op->BindInput(Mapped(in));
+  }
+  std::vector<std::shared_ptr<vx::Tensor>> outs;
+  for (const auto& out : op->impl()->OutputsTensor()) {
+    outs.push_back(MapOutput(out));
+  }
+  cloned_op->BindOutputs(outs);
+  return cloned_op;
+}
+
+}  // namespace transform
+}  // namespace tim
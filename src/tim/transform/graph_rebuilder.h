@@ -0,0 +1,99 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_GRAPH_REBUILDER_H_
+#define TIM_TRANSFORM_GRAPH_REBUILDER_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+#include "tim/vx/tensor.h"
+
+namespace tim {
+namespace transform {
+
+/// Sort the ops of `graph` so that every op follows the producers of its
+/// inputs. Returns false if the graph has a cycle
+bool SortOps(const std::shared_ptr<vx::Graph>& graph,
+             std::vector<std::shared_ptr<vx::Operation>>& sorted);
+
+/// Rebuilds a source graph into a new graph of the same context for passes
+/// which rewrite the graph. ovxlib nodes are created with their operation, so
+/// a rewritten graph is built anew like LayoutInference does.
+class GraphRebuilder {
+ public:
+  GraphRebuilder(const std::shared_ptr<vx::Graph>& src_graph,
+                 std::shared_ptr<vx::Context>& ctx);
+
+  /// Tensor in graph() for source tensor `t`. Constants and placeholders are
+  /// created on first use, constants sharing the source's data
+  std::shared_ptr<vx::Tensor> Mapped(const std::shared_ptr<vx::Tensor>& t);
+  /// Create the tensor in graph() for output `t` of a source op
+  std::shared_ptr<vx::Tensor> MapOutput(const std::shared_ptr<vx::Tensor>& t);
+  /// Map source tensor `t` to `mapped` of graph()
+  void Map(const std::shared_ptr<vx::Tensor>& t,
+           const std::shared_ptr<vx::Tensor>& mapped) {
+    mapped_[t] = mapped;
+  }
+  bool IsGraphOutput(const std::shared_ptr<vx::Tensor>& t) const {
+    return outputs_.find(t) != outputs_.end();
+  }
+  /// Graph output of graph() for source graph output `t`, nullptr for other
+  /// tensors
+  std::shared_ptr<vx::Tensor> GraphOutput(
+      const std::shared_ptr<vx::Tensor>& t) const {
+    auto it = outputs_.find(t);
+    return it != outputs_.end() ? it->second : nullptr;
+  }
+  bool IsMapped(const std::shared_ptr<vx::Tensor>& t) const {
+    return mapped_.find(t) != mapped_.end();
+  }
+
+  /// Clone source `op` into graph() on the mapped tensors
+  std::shared_ptr<vx::Operation> Clone(
+      const std::shared_ptr<vx::Operation>& op);
+
+  const std::shared_ptr<vx::Graph>& src_graph() const { return src_graph_; }
+  std::shared_ptr<vx::Graph>& graph() { return graph_; }
+  /// Graph inputs and outputs of the source graph to those of graph()
+  const std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>&
+  io_map() const {
+    return io_map_;
+  }
+
+ private:
+  const std::shared_ptr<vx::Graph>& src_graph_;
+  std::shared_ptr<vx::Graph> graph_;
+  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>> mapped_;
+  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>> outputs_;
+  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>> io_map_;
+};
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
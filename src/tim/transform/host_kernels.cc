@@ -0,0 +1,283 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "host_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "type_utils.h"
+#include "vsi_nn_pub.h"
+
+namespace tim {
+namespace transform {
+namespace host {
+namespace {
+
+size_t ElementNum(const vx::ShapeType& shape) {
+  size_t num = 1;
+  for (auto d : shape) num *= d;
+  return num;
+}
+
+std::vector<size_t> Strides(const vx::ShapeType& shape) {
+  std::vector<size_t> strides(shape.size(), 1);
+  for (size_t i = 1; i < shape.size(); ++i) {
+    strides[i] = strides[i - 1] * shape[i - 1];
+  }
+  return strides;
+}
+
+// Strides of `shape` broadcast to `out_shape`, 0 along broadcast dims
+std::vector<size_t> BroadcastStrides(const vx::ShapeType& shape,
+                                     const vx::ShapeType& out_shape) {
+  auto strides = Strides(shape);
+  strides.resize(out_shape.size(), 0);
+  for (size_t i = 0; i < shape.size(); ++i) {
+    if (shape[i] == 1) strides[i] = 0;
+  }
+  return strides;
+}
+
+// Rows along dim 0 keep the inner loops contiguous, with a broadcast operand
+// hoisted out, so that the compiler vectorizes them
+template <typename T, typename F>
+void BinaryRows(const T* a, const vx::ShapeType& a_shape, const T* b,
+                const vx::ShapeType& b_shape, T* out,
+                const vx::ShapeType& out_shape, F f) {
+  size_t rank = out_shape.size();
+  size_t inner = rank ? out_shape[0] : 1;
+  size_t rows = inner ? ElementNum(out_shape) / inner : 0;
+  auto a_strides = BroadcastStrides(a_shape, out_shape);
+  auto b_strides = BroadcastStrides(b_shape, out_shape);
+  bool a_step = rank && a_strides[0] != 0;
+  bool b_step = rank && b_strides[0] != 0;
+  std::vector<uint32_t> coord(rank, 0);
+  for (size_t r = 0; r < rows; ++r, out += inner) {
+    size_t a_offset = 0;
+    size_t b_offset = 0;
+    for (size_t d = 1; d < rank; ++d) {
+      a_offset += coord[d] * a_strides[d];
+      b_offset += coord[d] * b_strides[d];
+    }
+    const T* a_row = a + a_offset;
+    const T* b_row = b + b_offset;
+    if (a_step && b_step) {
+      for (size_t i = 0; i < inner; ++i) out[i] = f(a_row[i], b_row[i]);
+    } else if (a_step) {
+      const T b_value = *b_row;
+      for (size_t i = 0; i < inner; ++i) out[i] = f(a_row[i], b_value);
+    } else if (b_step) {
+      const T a_value = *a_row;
+      for (size_t i = 0; i < inner; ++i) out[i] = f(a_value, b_row[i]);
+    } else {
+      std::fill(out, out + inner, f(*a_row, *b_row));
+    }
+    for (size_t d = 1; d < rank && ++coord[d] == out_shape[d]; ++d) {
+      coord[d] = 0;
+    }
+  }
+}
+
+template <typename T>
+bool BinaryOf(BinaryOp op, const void* a, const vx::ShapeType& a_shape,
+              const void* b, const vx::ShapeType& b_shape, void* out,
+              const vx::ShapeType& out_shape) {
+  auto a_data = static_cast<const T*>(a);
+  auto b_data = static_cast<const T*>(b);
+  auto out_data = static_cast<T*>(out);
+  switch (op) {
+    case BinaryOp::kAdd:
+      BinaryRows(a_data, a_shape, b_data, b_shape, out_data, out_shape,
+                 [](T x, T y) { return x + y; });
+      return true;
+    case BinaryOp::kSub:
+      BinaryRows(a_data, a_shape, b_data, b_shape, out_data, out_shape,
+                 [](T x, T y) { return x - y; });
+      return true;
+    case BinaryOp::kMul:
+      BinaryRows(a_data, a_shape, b_data, b_shape, out_data, out_shape,
+                 [](T x, T y) { return x * y; });
+      return true;
+    case BinaryOp::kDiv:
+      BinaryRows(a_data, a_shape, b_data, b_shape, out_data, out_shape,
+                 [](T x, T y) { return x / y; });
+      return true;
+    case BinaryOp::kMax:
+      BinaryRows(a_data, a_shape, b_data, b_shape, out_data, out_shape,
+                 [](T x, T y) { return x > y ? x : y; });
+      return true;
+    case BinaryOp::kMin:
+      BinaryRows(a_data, a_shape, b_data, b_shape, out_data, out_shape,
+                 [](T x, T y) { return x < y ? x : y; });
+      return true;
+  }
+  return false;
+}
+
+template <typename T>
+void TransposeOf(const T* in, const vx::ShapeType& in_shape,
+                 const std::vector<uint32_t>& perm, T* out) {
+  size_t rank = in_shape.size();
+  vx::ShapeType out_shape(rank);
+  std::vector<size_t> in_strides = Strides(in_shape);
+  std::vector<size_t> strides(rank);
+  for (size_t i = 0; i < rank; ++i) {
+    out_shape[i] = in_shape[perm[i]];
+    strides[i] = in_strides[perm[i]];
+  }
+  size_t inner = rank ? out_shape[0] : 1;
+  size_t rows = inner ? ElementNum(out_shape) / inner : 0;
+  size_t step = rank ? strides[0] : 1;
+  std::vector<uint32_t> coord(rank, 0);
+  for (size_t r = 0; r < rows; ++r, out += inner) {
+    size_t offset = 0;
+    for (size_t d = 1; d < rank; ++d) offset += coord[d] * strides[d];
+    const T* row = in + offset;
+    if (step == 1) {
+      std::copy(row, row + inner, out);
+    } else {
+      for (size_t i = 0; i < inner; ++i) out[i] = row[i * step];
+    }
+    for (size_t d = 1; d < rank && ++coord[d] == out_shape[d]; ++d) {
+      coord[d] = 0;
+    }
+  }
+}
+
+bool ToVsiDtype(const vx::TensorSpec& spec, vsi_nn_dtype_t& dtype) {
+  memset(&dtype, 0, sizeof(dtype));
+  dtype.vx_type = vx::TranslateDataType(spec.datatype_);
+  const auto& quant = spec.quantization_;
+  dtype.qnt_type = vx::TranslateQuantType(quant.Type());
+  switch (quant.Type()) {
+    case vx::QuantType::NONE:
+      return true;
+    case vx::QuantType::ASYMMETRIC:
+      dtype.scale = quant.Scales()[0];
+      dtype.zero_point = quant.ZeroPoints()[0];
+      return true;
+    case vx::QuantType::DYNAMIC_FIXED_POINT:
+      dtype.fl = quant.Fl();
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool BroadcastShape(const vx::ShapeType& a, const vx::ShapeType& b,
+                    vx::ShapeType& out) {
+  out.assign(std::max(a.size(), b.size()), 1);
+  for (size_t i = 0; i < out.size(); ++i) {
+    uint32_t a_dim = i < a.size() ? a[i] : 1;
+    uint32_t b_dim = i < b.size() ? b[i] : 1;
+    if (a_dim != b_dim && a_dim != 1 && b_dim != 1) return false;
+    out[i] = a_dim == 1 ? b_dim : a_dim;
+  }
+  return true;
+}
+
+bool Binary(BinaryOp op, vx::DataType dtype, const void* a,
+            const vx::ShapeType& a_shape, const void* b,
+            const vx::ShapeType& b_shape, void* out,
+            const vx::ShapeType& out_shape) {
+  switch (dtype) {
+    case vx::DataType::FLOAT32:
+      return BinaryOf<float>(op, a, a_shape, b, b_shape, out, out_shape);
+    case vx::DataType::INT32:
+      // Integer division rounds differently across drivers
+      return op != BinaryOp::kDiv &&
+             BinaryOf<int32_t>(op, a, a_shape, b, b_shape, out, out_shape);
+    default:
+      return false;
+  }
+}
+
+bool Transpose(const void* in, const vx::ShapeType& in_shape,
+               const std::vector<uint32_t>& perm, size_t element_bytes,
+               void* out) {
+  switch (element_bytes) {
+    case 1:
+      TransposeOf(static_cast<const uint8_t*>(in), in_shape, perm,
+                  static_cast<uint8_t*>(out));
+      return true;
+    case 2:
+      TransposeOf(static_cast<const uint16_t*>(in), in_shape, perm,
+                  static_cast<uint16_t*>(out));
+      return true;
+    case 4:
+      TransposeOf(static_cast<const uint32_t*>(in), in_shape, perm,
+                  static_cast<uint32_t*>(out));
+      return true;
+    case 8:
+      TransposeOf(static_cast<const uint64_t*>(in), in_shape, perm,
+                  static_cast<uint64_t*>(out));
+      return true;
+    default:
+      return false;
+  }
+}
+
+void Concat(const std::vector<const void*>& in,
+            const std::vector<vx::ShapeType>& in_shapes, uint32_t axis,
+            size_t element_bytes, void* out) {
+  // Every input contributes a block of dims up to `axis` per outer index
+  size_t outer = 1;
+  for (size_t d = axis + 1; d < in_shapes[0].size(); ++d) {
+    outer *= in_shapes[0][d];
+  }
+  std::vector<size_t> block_bytes;
+  for (const auto& shape : in_shapes) {
+    size_t bytes = element_bytes;
+    for (size_t d = 0; d <= axis; ++d) bytes *= shape[d];
+    block_bytes.push_back(bytes);
+  }
+  auto dst = static_cast<uint8_t*>(out);
+  for (size_t o = 0; o < outer; ++o) {
+    for (size_t i = 0; i < in.size(); ++i) {
+      memcpy(dst, static_cast<const uint8_t*>(in[i]) + o * block_bytes[i],
+             block_bytes[i]);
+      dst += block_bytes[i];
+    }
+  }
+}
+
+bool Convert(const void* in, const vx::TensorSpec& in_spec, void* out,
+             const vx::TensorSpec& out_spec, size_t elements) {
+  vsi_nn_dtype_t in_dtype;
+  vsi_nn_dtype_t out_dtype;
+  if (!ToVsiDtype(in_spec, in_dtype) || !ToVsiDtype(out_spec, out_dtype)) {
+    return false;
+  }
+  auto in_data = static_cast<uint8_t*>(const_cast<void*>(in));
+  return vsi_nn_DtypeConvertRawData(in_data, in_spec.GetByteSize(), &in_dtype,
+                                    static_cast<uint8_t*>(out),
+                                    out_spec.GetByteSize(),
+                                    &out_dtype) == elements;
+}
+
+}  // namespace host
+}  // namespace transform
+}  // namespace tim
@@ -0,0 +1,71 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_HOST_KERNELS_H_
+#define TIM_TRANSFORM_HOST_KERNELS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "tim/vx/tensor.h"
+#include "tim/vx/types.h"
+
+namespace tim {
+namespace transform {
+namespace host {
+
+/// Elementwise binary ops evaluated on the host
+enum class BinaryOp { kAdd, kSub, kMul, kDiv, kMax, kMin };
+
+/// Shape of `a` and `b` broadcast against each other, aligned at dim 0 as
+/// ovxlib does. Returns false if they don't broadcast
+bool BroadcastShape(const vx::ShapeType& a, const vx::ShapeType& b,
+                    vx::ShapeType& out);
+
+/// `out` = `a` op `b` of `dtype` FLOAT32 or INT32 with broadcasting. Returns
+/// false for types or ops which aren't supported, INT32 kDiv included
+bool Binary(BinaryOp op, vx::DataType dtype, const void* a,
+            const vx::ShapeType& a_shape, const void* b,
+            const vx::ShapeType& b_shape, void* out,
+            const vx::ShapeType& out_shape);
+
+/// Transpose elements of `element_bytes`, out.dim[i] = in.dim[perm[i]]
+bool Transpose(const void* in, const vx::ShapeType& in_shape,
+               const std::vector<uint32_t>& perm, size_t element_bytes,
+               void* out);
+
+/// Concatenate elements of `element_bytes` along `axis`
+void Concat(const std::vector<const void*>& in,
+            const std::vector<vx::ShapeType>& in_shapes, uint32_t axis,
+            size_t element_bytes, void* out);
+
+/// Convert `elements` values from `in_spec` to `out_spec`, both quantized
+/// per tensor if at all
+bool Convert(const void* in, const vx::TensorSpec& in_spec, void* out,
+             const vx::TensorSpec& out_spec, size_t elements);
+
+}  // namespace host
+}  // namespace transform
+}  // namespace tim
+
+#endif
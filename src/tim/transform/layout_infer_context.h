@@ -3,8 +3,11 @@
 
 #include "permute_vector.h"
 #include "tim/transform/layout_inference.h"
+#include "tim/vx/tensor.h"
 
+#include <map>
 #include <unordered_map>
+#include <vector>
 
 namespace tim {
 namespace transform {
@@ -22,8 +25,9 @@ class LayoutInferContext {
   bool IsReadyForInfer(const std::shared_ptr<vx::Operation>& op) const;
   void UpdateTensorMap(const std::shared_ptr<vx::Tensor>& t_src,
                        const std::shared_ptr<vx::Tensor>& t_layout);
+  /// A constant not mapped yet is cloned on first lookup
   std::shared_ptr<vx::Tensor> GetMappedTensor(
-      const std::shared_ptr<vx::Tensor>& t_src) const;
+      const std::shared_ptr<vx::Tensor>& t_src);
   std::shared_ptr<vx::Tensor> GetMappedGraphInputTensor(
       const std::shared_ptr<vx::Tensor>& t_src) const;
   std::shared_ptr<vx::Tensor> GetMappedGraphOutputTensor(
@@ -44,16 +48,52 @@ class LayoutInferContext {
   GetGraphOutputMap() const {
     return graph_output_map_;
   }
+  /// Host data of constant `t_src`, shared by all tensors cloned from it.
+  /// Borrowed from the source tensor if it has a borrowed buffer, otherwise
+  /// read back once
+  std::shared_ptr<const void> GetConstData(
+      const std::shared_ptr<vx::Tensor>& t_src);
+  /// Buffer for constant data in infer graph, see CreateConstTensor
+  std::shared_ptr<void> AllocConstData(size_t bytes);
+  /// Create a constant in infer graph referencing `data` without a copy
+  std::shared_ptr<vx::Tensor> CreateConstTensor(
+      const vx::TensorSpec& spec, const std::shared_ptr<const void>& data);
+  /// Constant `t_src` in infer graph, it's created once and shares storage
+  /// with every other clone of `t_src`
+  std::shared_ptr<vx::Tensor> CloneConstTensor(
+      const std::shared_ptr<vx::Tensor>& t_src);
+  /// Same as above but reshaped to `spec`, which isn't cached
+  std::shared_ptr<vx::Tensor> CloneConstTensor(
+      const std::shared_ptr<vx::Tensor>& t_src, const vx::TensorSpec& spec);
+
   const std::shared_ptr<vx::Graph>& src_graph_;
   std::shared_ptr<vx::Graph>& infer_graph_;
 
  private:
-  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<IPermuteVector>>
-      tensor_pv_;
-  std::unordered_map<std::shared_ptr<vx::Operation>, bool> op_visited_;
-  // tensor_in_src -> tensor_in_layout
-  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>
-      tensor_map_;
+  // Everything known about a tensor of src graph
+  struct TensorSlot {
+    const vx::Tensor* src{nullptr};
+    std::shared_ptr<IPermuteVector> pv;
+    // tensor_in_layout
+    std::shared_ptr<vx::Tensor> mapped;
+    // unpermuted const in infer graph
+    std::shared_ptr<vx::Tensor> const_clone;
+    // host data, alive as long as a tensor in infer graph uses it
+    std::weak_ptr<const void> const_data;
+  };
+  /// Slot of `tensor`, created on demand. Slots are indexed by tensor id,
+  /// tensors without an id live in a side table
+  TensorSlot* FindSlot(const std::shared_ptr<vx::Tensor>& tensor);
+  /// Same as above but nullptr if `tensor` has no slot yet
+  const TensorSlot* FindSlot(const std::shared_ptr<vx::Tensor>& tensor) const;
+
+  std::vector<TensorSlot> tensor_slots_;
+  std::unordered_map<const vx::Tensor*, TensorSlot> detached_slots_;
+  // op -> index in OpVector of src graph
+  std::unordered_map<const vx::Operation*, uint32_t> op_index_;
+  std::vector<bool> op_visited_;
+  // number of inputs whose permute vector is still unknown, per op
+  std::vector<uint32_t> op_pending_inputs_;
   std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>
       graph_input_map_;
   std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>
@@ -24,6 +24,7 @@
 
 #include "permute_vector.h"
 #include "layout_infer_context.h"
+#include "const_data.h"
 
 #include "tim/transform/layout_inference.h"
 #include "ops/conv2d_layout_inference.h"
@@ -71,6 +72,14 @@
 #include "ops/bidirectional_rnn_layout_inference.h"
 #include "ops/roi_align_layout_inference.h"
 #include "ops/roi_pool_layout_inference.h"
+#include "ops/matmul_layout_inference.h"
+#include "ops/layernorm_layout_inference.h"
+#include "ops/tile_layout_inference.h"
+#include "ops/topk_layout_inference.h"
+#include "ops/cumsum_layout_inference.h"
+#include "ops/gather_elements_layout_inference.h"
+#include "ops/onehot_layout_inference.h"
+#include "ops/logsoftmax_layout_inference.h"
 
 #include <algorithm>
 #include <queue>
@@ -83,33 +92,119 @@ namespace tim {
 namespace transform {
 namespace layout_inference_impl {
 
+#define REGISTER_RELATIONAL_LAYOUT_INFERENCE(op_idx)                      \
+  case op_idx: {                                                          \
+    auto relational_type = op->impl()->node()->nn_param.relational_ops.op; \
+    switch (relational_type) {                                            \
+      REGISTER_LAYOUT_INFERENCE(VSI_NN_RELATIONAL_OPS_GREAT, Greater);    \
+      REGISTER_LAYOUT_INFERENCE(VSI_NN_RELATIONAL_OPS_GREAT_EQUAL,        \
+                                GreaterOrEqual);                          \
+      REGISTER_LAYOUT_INFERENCE(VSI_NN_RELATIONAL_OPS_LESS, Less);        \
+      REGISTER_LAYOUT_INFERENCE(VSI_NN_RELATIONAL_OPS_LESS_EQUAL,         \
+                                LessOrEqual);                             \
+      REGISTER_LAYOUT_INFERENCE(VSI_NN_RELATIONAL_OPS_NOT_EQUAL,          \
+                                NotEqual);                                \
+      REGISTER_LAYOUT_INFERENCE(VSI_NN_RELATIONAL_OPS_EQUAL, Equal);      \
+      default:                                                            \
+        VSILOGW("Op %d: Default layout inference pass for relational.",   \
+                relational_type);                                         \
+        assert(false);                                                    \
+    }                                                                     \
+    break;                                                                \
+  }
+
 std::vector<std::shared_ptr<vx::Tensor>> HandleLayoutInfer(
     std::shared_ptr<layout_inference_impl::LayoutInferContext>& ctx,
     const std::shared_ptr<vx::Operation>& op);
 
+namespace {
+// Inputs an op has to wait for before it can be inferred
+bool IsAwaitedInput(const std::shared_ptr<vx::Tensor>& tensor) {
+  return !tensor->IsConstTensor() &&
+         tensor->GetId() != static_cast<uint32_t>(-1);
+}
+}  // namespace
+
 // Implementation for LayoutInferContext
 LayoutInferContext::LayoutInferContext(
     const std::shared_ptr<vx::Graph>& src_graph,
     std::shared_ptr<vx::Graph>& infer_graph)
     : src_graph_(src_graph), infer_graph_(infer_graph) {
-  for (const auto& op : src_graph->OpVector()) {
-    op_visited_[op] = false;
+  const auto& ops = src_graph->OpVector();
+  op_index_.reserve(ops.size());
+  op_visited_.assign(ops.size(), false);
+  op_pending_inputs_.assign(ops.size(), 0);
+  tensor_slots_.reserve(2 * ops.size());
+  for (uint32_t i = 0; i < ops.size(); ++i) {
+    op_index_[ops[i].get()] = i;
+    for (const auto& tensor : ops[i]->impl()->InputsTensor()) {
+      if (IsAwaitedInput(tensor)) {
+        ++op_pending_inputs_[i];
+      }
+    }
   }
 }
 
+LayoutInferContext::TensorSlot* LayoutInferContext::FindSlot(
+    const std::shared_ptr<vx::Tensor>& tensor) {
+  uint32_t id = tensor->GetId();
+  if (id != static_cast<uint32_t>(-1)) {
+    if (id >= tensor_slots_.size()) {
+      tensor_slots_.resize(id + 1);
+    }
+    auto& slot = tensor_slots_[id];
+    if (slot.src == nullptr) {
+      slot.src = tensor.get();
+    }
+    if (slot.src == tensor.get()) {
+      return &slot;
+    }
+  }
+  auto& slot = detached_slots_[tensor.get()];
+  slot.src = tensor.get();
+  return &slot;
+}
+
+const LayoutInferContext::TensorSlot* LayoutInferContext::FindSlot(
+    const std::shared_ptr<vx::Tensor>& tensor) const {
+  uint32_t id = tensor->GetId();
+  if (id < tensor_slots_.size() && tensor_slots_[id].src == tensor.get()) {
+    return &tensor_slots_[id];
+  }
+  auto it = detached_slots_.find(tensor.get());
+  return it != detached_slots_.end() ? &it->second : nullptr;
+}
+
 void LayoutInferContext::SetPermuteVector(std::shared_ptr<vx::Tensor> tensor,
                                           std::shared_ptr<IPermuteVector> pv) {
-  if (tensor_pv_.end() != tensor_pv_.find(tensor)) {
+  auto slot = FindSlot(tensor);
+  if (slot->pv) {
     VSILOGD("Tensor PermuteVector has been setted.");
+  } else if (IsAwaitedInput(tensor)) {
+    // Consumers may list an op once per binding, visit each op once and
+    // count its bindings instead
+    auto consumers = src_graph_->GetConsumersOp(tensor);
+    std::sort(consumers.begin(), consumers.end());
+    consumers.erase(std::unique(consumers.begin(), consumers.end()),
+                    consumers.end());
+    for (const auto& op : consumers) {
+      auto it = op_index_.find(op.get());
+      if (it == op_index_.end()) continue;
+      for (const auto& input : op->impl()->InputsTensor()) {
+        if (input == tensor) {
+          --op_pending_inputs_[it->second];
+        }
+      }
+    }
   }
-  tensor_pv_[tensor] = pv;
+  slot->pv = pv;
 }
 
 const std::shared_ptr<IPermuteVector> LayoutInferContext::GetPermuteVector(
     const std::shared_ptr<vx::Tensor>& tensor) const {
-  auto pv_it = tensor_pv_.find(tensor);
-  if (pv_it != tensor_pv_.end()) {
-    return pv_it->second;
+  auto slot = FindSlot(tensor);
+  if (slot && slot->pv) {
+    return slot->pv;
   } else {
     VSILOGE("Tensor PermuteVecor has not beed setted.");
     assert(false);
@@ -119,20 +214,28 @@ const std::shared_ptr<IPermuteVector> LayoutInferContext::GetPermuteVector(
 }
 
 void LayoutInferContext::MarkVisited(const std::shared_ptr<vx::Operation>& op) {
-  op_visited_[op] = true;
+  auto it = op_index_.find(op.get());
+  if (it != op_index_.end()) {
+    op_visited_[it->second] = true;
+  }
 }
 
 bool LayoutInferContext::IsVisited(
     const std::shared_ptr<vx::Operation>& op) const {
-  return op_visited_.at(op);
+  auto it = op_index_.find(op.get());
+  assert(it != op_index_.end());
+  return it != op_index_.end() && op_visited_[it->second];
 }
 
 bool LayoutInferContext::IsReadyForInfer(
     const std::shared_ptr<vx::Operation>& op) const {
+  auto it = op_index_.find(op.get());
+  if (it != op_index_.end()) {
+    return op_pending_inputs_[it->second] == 0;
+  }
   for (const auto& tensor : op->impl()->InputsTensor()) {
-    if (!tensor->IsConstTensor() &&
-        tensor->GetId() != static_cast<uint32_t>(-1) &&
-        (tensor_pv_.end() == tensor_pv_.find(tensor))) {
+    auto slot = FindSlot(tensor);
+    if (IsAwaitedInput(tensor) && (!slot || !slot->pv)) {
       return false;
     }
   }
@@ -142,14 +245,19 @@ bool LayoutInferContext::IsReadyForInfer(
 void LayoutInferContext::UpdateTensorMap(
     const std::shared_ptr<vx::Tensor>& t_src,
     const std::shared_ptr<vx::Tensor>& t_layout) {
-  tensor_map_[t_src] = t_layout;
+  FindSlot(t_src)->mapped = t_layout;
 }
 
 std::shared_ptr<vx::Tensor> LayoutInferContext::GetMappedTensor(
-    const std::shared_ptr<vx::Tensor>& t_src) const {
-  auto it = tensor_map_.find(t_src);
-  if (it != tensor_map_.end()) {
-    return it->second;
+    const std::shared_ptr<vx::Tensor>& t_src) {
+  auto mapped = FindSlot(t_src)->mapped;
+  if (mapped) {
+    return mapped;
+  }
+  if (t_src->IsConstTensor() && !t_src->IsPlaceHolder()) {
+    auto t_layout = CloneConstTensor(t_src);
+    UpdateTensorMap(t_src, t_layout);
+    return t_layout;
   }
 
   VSILOGE("Tensor has not beed inserted in tensor map.");
@@ -159,7 +267,7 @@ std::shared_ptr<vx::Tensor> LayoutInferContext::GetMappedTensor(
 std::shared_ptr<vx::Tensor> LayoutInferContext::GetMappedGraphInputTensor(
     const std::shared_ptr<vx::Tensor>& t_src) const {
   auto it = graph_input_map_.find(t_src);
-  if (it != tensor_map_.end()) {
+  if (it != graph_input_map_.end()) {
     return it->second;
   }
 
@@ -170,7 +278,7 @@ std::shared_ptr<vx::Tensor> LayoutInferContext::GetMappedGraphInputTensor(
 std::shared_ptr<vx::Tensor> LayoutInferContext::GetMappedGraphOutputTensor(
     const std::shared_ptr<vx::Tensor>& t_src) const {
   auto it = graph_output_map_.find(t_src);
-  if (it != tensor_map_.end()) {
+  if (it != graph_output_map_.end()) {
     return it->second;
   }
 
@@ -190,6 +298,44 @@ void LayoutInferContext::UpdateGraphOutputMap(
   graph_output_map_[o_src] = o_layout;
 }
 
+std::shared_ptr<const void> LayoutInferContext::GetConstData(
+    const std::shared_ptr<vx::Tensor>& t_src) {
+  auto data = FindSlot(t_src)->const_data.lock();
+  if (data) {
+    return data;
+  }
+  data = ReadConstData(t_src, infer_graph_);
+  if (data) {
+    FindSlot(t_src)->const_data = data;
+  }
+  return data;
+}
+
+std::shared_ptr<void> LayoutInferContext::AllocConstData(size_t bytes) {
+  return transform::AllocConstData(infer_graph_, bytes);
+}
+
+std::shared_ptr<vx::Tensor> LayoutInferContext::CreateConstTensor(
+    const vx::TensorSpec& spec, const std::shared_ptr<const void>& data) {
+  return transform::CreateConstTensor(infer_graph_, spec, data);
+}
+
+std::shared_ptr<vx::Tensor> LayoutInferContext::CloneConstTensor(
+    const std::shared_ptr<vx::Tensor>& t_src) {
+  auto cached = FindSlot(t_src)->const_clone;
+  if (cached && cached->GetSpec() == t_src->GetSpec()) {
+    return cached;
+  }
+  auto t_layout = CreateConstTensor(t_src->GetSpec(), GetConstData(t_src));
+  FindSlot(t_src)->const_clone = t_layout;
+  return t_layout;
+}
+
+std::shared_ptr<vx::Tensor> LayoutInferContext::CloneConstTensor(
+    const std::shared_ptr<vx::Tensor>& t_src, const vx::TensorSpec& spec) {
+  return CreateConstTensor(spec, GetConstData(t_src));
+}
+
 #define REGISTER_LAYOUT_INFERENCE(op_idx, name)                   \
   case op_idx: {                                                  \
     auto op_infer = std::make_shared<name##LayoutInfer>(op, ctx); \
@@ -325,6 +471,37 @@ std::vector<std::shared_ptr<vx::Tensor>> HandleLayoutInfer(
 #ifdef VSI_FEAT_OP_CUSTOM_TINY_YOLOV4_POSTPROCESS
     REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_CUSTOM_TINY_YOLOV4_POSTPROCESS, Yolov4);
 #endif
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_FLOOR, Floor);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_CEIL, Ceil);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_ROUND, Round);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_CAST, Cast);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_RCP, Rcp);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_SIGN, Sign);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_SOFTSIGN, SoftSign);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_LINEAR, Linear);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_GELU, Gelu);
+#ifdef _VSI_NN_OP_SELU_H
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_SELU, Selu);
+#endif
+#ifdef _VSI_NN_OP_CELU_H
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_CELU, Celu);
+#endif
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_CLIP, Clip);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_ERF, Erf);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_FLOORDIV, FloorDiv);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_MATRIXMUL, MatMul);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_LAYER_NORM, LayerNorm);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_TILE, Tile);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_TOPK, Topk);
+#ifdef VSI_FEAT_OP_CUMSUM
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_CUMSUM, CumSum);
+#endif
+#ifdef _VSI_NN_OP_GATHER_ELEMENTS_H
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_GATHER_ELEMENTS, GatherElements);
+#endif
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_ONE_HOT, OneHot);
+    REGISTER_LAYOUT_INFERENCE(VSI_NN_OP_LOG_SOFTMAX, LogSoftmax);
+    REGISTER_RELATIONAL_LAYOUT_INFERENCE(VSI_NN_OP_RELATIONAL_OPS);
     REGISTER_LOGICAL_LAYOUT_INFERENCE(VSI_NN_OP_LOGICAL_OPS);
     REGISTER_REDUCE_LAYOUT_INFERENCE(VSI_NN_OP_REDUCE);
     // use default layout inference
@@ -366,13 +543,10 @@ LayoutInference(
                    : MakeShared(t_src->GetShape().size()));
   }
 
+  // Constants are cloned into infer graph on first use, so a constant which
+  // ends up permuted isn't duplicated
   auto const_inputs = src_graph->GetConstantInputs();
   for (auto const_in : const_inputs) {
-    std::vector<uint8_t> dataRef(const_in->GetSpec().GetByteSize());
-    const_in->CopyDataFromTensor(dataRef.data());
-    auto input = infer_graph->CreateTensor(const_in->GetSpec(),
-                                           (const void*)dataRef.data());
-    layout_infer_ctx->UpdateTensorMap(const_in, input);
     tensor_queue.push(const_in);
     layout_infer_ctx->SetPermuteVector(
         const_in, tensor_pv_map.find(const_in) != tensor_pv_map.end()
@@ -6,6 +6,10 @@
 
 #include "gtest/gtest.h"
 
+#include <fstream>
+#include <sstream>
+#include <string>
+
 TEST(LayoutInference, simple_conv2d) {
   auto ctx = tim::vx::Context::Create();
   auto src_graph = ctx->CreateGraph();
@@ -420,4 +424,78 @@ TEST(RoiAlign, nhwc) {
   std::vector<float> output(golden.size());
   EXPECT_TRUE(infer_output->CopyDataFromTensor(output.data()));
   EXPECT_TRUE(ArraysMatch(golden, output, 1e-5f));
-}
\ No newline at end of file
+}
+
+namespace {
+// Read a "Vm*:" field of /proc/self/status in bytes, 0 if it's unavailable
+size_t ReadProcStatus(const std::string& field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, field.size(), field) == 0) {
+      std::istringstream value(line.substr(field.size()));
+      size_t kb = 0;
+      value >> kb;
+      return kb * 1024;
+    }
+  }
+  return 0;
+}
+
+// Reset VmHWM to the current RSS, see proc(5)
+bool ResetPeakRss() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+  clear_refs.flush();
+  return clear_refs.good();
+}
+}  // namespace
+
+TEST(LayoutInference, const_weight_peak_memory) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+
+  const uint32_t channels = 256;
+  tim::vx::ShapeType input_shape({channels, 8, 8, 1});  // CWHN
+  tim::vx::ShapeType kernel_shape({channels, 3, 3, channels});  // IcWHOc
+  tim::vx::ShapeType bias_shape({channels});
+  tim::vx::ShapeType output_shape({channels, 8, 8, 1});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, input_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec kernel_spec(tim::vx::DataType::FLOAT32, kernel_shape,
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec bias_spec(tim::vx::DataType::FLOAT32, bias_shape,
+                                tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, output_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  size_t weight_bytes = kernel_spec.GetByteSize();
+  {
+    std::vector<float> kernel_data(weight_bytes / sizeof(float), 0.5f);
+    std::vector<float> bias_data(channels, 0.0f);
+    auto input = src_graph->CreateTensor(input_spec);
+    auto kernel = src_graph->CreateTensor(kernel_spec, kernel_data.data());
+    auto bias = src_graph->CreateTensor(bias_spec, bias_data.data());
+    auto output = src_graph->CreateTensor(output_spec);
+    auto conv2d = src_graph->CreateOperation<tim::vx::ops::Conv2d>(
+        channels, tim::vx::PadType::SAME, std::array<uint32_t, 2>({3, 3}),
+        std::array<uint32_t, 2>({1, 1}), std::array<uint32_t, 2>({1, 1}),
+        std::array<uint32_t, 4>({0, 0, 0, 0}), 0, tim::vx::DataLayout::CWHN,
+        tim::vx::DataLayout::IcWHOc);
+    (*conv2d).BindInputs({input, kernel, bias}).BindOutput(output);
+  }
+
+  bool peak_tracked = ResetPeakRss();
+  size_t rss_before = ReadProcStatus("VmRSS:");
+  auto transform = tim::transform::LayoutInference(src_graph, ctx);
+  size_t peak = ReadProcStatus("VmHWM:");
+  ASSERT_NE(transform.first, nullptr);
+
+  size_t pass_peak = peak > rss_before ? peak - rss_before : 0;
+  RecordProperty("peak_bytes", std::to_string(pass_peak));
+  RecordProperty("weight_bytes", std::to_string(weight_bytes));
+  if (peak_tracked && rss_before > 0) {
+    // The weight is read back once and permuted into the buffer backing the
+    // inferred constant, there's no third copy any more
+    EXPECT_LT(pass_peak, 3 * weight_bytes);
+  }
+}
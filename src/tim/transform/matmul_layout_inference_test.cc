@@ -0,0 +1,124 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/transform/layout_inference.h"
+#include "permute_vector.h"
+#include "op_impl.h"
+
+#include "gtest/gtest.h"
+
+// The matrix axes of input a arrive swapped, which is absorbed by
+// transpose_a instead of a transpose in front of the matmul.
+TEST(MatMul, swapped_matrix_axes) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType a_shape({2, 3, 2});  // a_pv={1,0,2}
+  tim::vx::ShapeType b_shape({2, 3, 2});
+  tim::vx::ShapeType out_shape({2, 2, 2});
+  tim::vx::TensorSpec a_spec(tim::vx::DataType::FLOAT32, a_shape,
+                             tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec b_spec(tim::vx::DataType::FLOAT32, b_shape,
+                             tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec out_spec(tim::vx::DataType::FLOAT32, out_shape,
+                               tim::vx::TensorAttribute::OUTPUT);
+  auto a = graph->CreateTensor(a_spec);
+  auto b = graph->CreateTensor(b_spec);
+  auto out = graph->CreateTensor(out_spec);
+  auto matmul = graph->CreateOperation<tim::vx::ops::Matmul>();
+  (*matmul).BindInputs({a, b}).BindOutputs({out});
+
+  std::map<std::shared_ptr<tim::vx::Tensor>,
+           std::shared_ptr<tim::transform::IPermuteVector>>
+      tensor_pv_map;
+  std::shared_ptr<tim::transform::IPermuteVector> pv =
+      std::make_shared<tim::transform::PermuteVector<3>>(
+          std::initializer_list<uint32_t>({1, 0, 2}));
+  tensor_pv_map.insert({a, pv});
+  auto transform = tim::transform::LayoutInference(graph, ctx, tensor_pv_map);
+  auto infer_graph = transform.first;
+  uint32_t transposes = 0;
+  for (const auto& op : infer_graph->OpVector()) {
+    if (op->impl()->kind_ == VSI_NN_OP_PERMUTE) ++transposes;
+  }
+  EXPECT_EQ(transposes, 0u);
+
+  std::vector<float> a_data = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  std::vector<float> b_data = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  std::vector<float> golden = {35, 44, 44, 56, 251, 278, 278, 308};
+  auto graph_io_map = transform.second;
+  auto infer_a = graph_io_map[graph->InputsTensor()[0]];
+  auto infer_b = graph_io_map[graph->InputsTensor()[1]];
+  auto infer_out = graph_io_map[graph->OutputsTensor()[0]];
+  EXPECT_TRUE(infer_graph->Compile());
+  EXPECT_TRUE(infer_a->CopyDataToTensor(a_data.data(),
+                                        a_data.size() * sizeof(float)));
+  EXPECT_TRUE(infer_b->CopyDataToTensor(b_data.data(),
+                                        b_data.size() * sizeof(float)));
+  EXPECT_TRUE(infer_graph->Run());
+
+  std::vector<float> out_data(golden.size());
+  EXPECT_TRUE(infer_out->CopyDataFromTensor(out_data.data()));
+  EXPECT_EQ(golden, out_data);
+}
+
+// Swapping a batch axis with a matrix axis can not be absorbed, the input is
+// transposed back like the default handler does.
+TEST(MatMul, batch_axis_moved) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType a_shape({3, 2, 2});  // a_pv={0,2,1}
+  tim::vx::ShapeType b_shape({2, 3, 2});
+  tim::vx::ShapeType out_shape({2, 2, 2});
+  tim::vx::TensorSpec a_spec(tim::vx::DataType::FLOAT32, a_shape,
+                             tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec b_spec(tim::vx::DataType::FLOAT32, b_shape,
+                             tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec out_spec(tim::vx::DataType::FLOAT32, out_shape,
+                               tim::vx::TensorAttribute::OUTPUT);
+  auto a = graph->CreateTensor(a_spec);
+  auto b = graph->CreateTensor(b_spec);
+  auto out = graph->CreateTensor(out_spec);
+  auto matmul = graph->CreateOperation<tim::vx::ops::Matmul>();
+  (*matmul).BindInputs({a, b}).BindOutputs({out});
+
+  std::map<std::shared_ptr<tim::vx::Tensor>,
+           std::shared_ptr<tim::transform::IPermuteVector>>
+      tensor_pv_map;
+  std::shared_ptr<tim::transform::IPermuteVector> pv =
+      std::make_shared<tim::transform::PermuteVector<3>>(
+          std::initializer_list<uint32_t>({0, 2, 1}));
+  tensor_pv_map.insert({a, pv});
+  auto transform = tim::transform::LayoutInference(graph, ctx, tensor_pv_map);
+  auto infer_graph = transform.first;
+  uint32_t transposes = 0;
+  for (const auto& op : infer_graph->OpVector()) {
+    if (op->impl()->kind_ == VSI_NN_OP_PERMUTE) ++transposes;
+  }
+  EXPECT_EQ(transposes, 1u);
+  EXPECT_TRUE(infer_graph->Compile());
+}
@@ -0,0 +1,100 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/transform/layout_inference.h"
+#include "permute_vector.h"
+#include "op_impl.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+// CWHN conv -> cast -> one hot: the one hot axis is inserted into the layout
+// of the conv, so only the graph input and output need a transpose.
+TEST(OneHot, after_cwhn_conv2d) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType io_shape({2, 2, 1, 1});          // CWHN
+  tim::vx::ShapeType onehot_shape({3, 2, 2, 1, 1});   // depth + CWHN
+  tim::vx::ShapeType kernel_shape({2, 1, 1, 2});      // IcWHOc
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec indices_spec(tim::vx::DataType::INT32, io_shape,
+                                   tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec kernel_spec(tim::vx::DataType::FLOAT32, kernel_shape,
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, onehot_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+
+  std::vector<float> identity = {1, 0, 0, 1};
+  auto input = graph->CreateTensor(input_spec);
+  auto kernel0 = graph->CreateTensor(kernel_spec, identity.data());
+  auto conv0_out = graph->CreateTensor(transient_spec);
+  auto indices = graph->CreateTensor(indices_spec);
+  auto output = graph->CreateTensor(output_spec);
+
+  std::array<uint32_t, 2> stride({1, 1});
+  std::array<uint32_t, 2> dilation({1, 1});
+  auto conv0 = graph->CreateOperation<tim::vx::ops::Conv2d>(
+      tim::vx::PadType::VALID, stride, dilation, 0, tim::vx::DataLayout::CWHN,
+      tim::vx::DataLayout::IcWHOc);
+  (*conv0).BindInputs({input, kernel0}).BindOutputs({conv0_out});
+  auto cast = graph->CreateOperation<tim::vx::ops::Cast>();
+  (*cast).BindInputs({conv0_out}).BindOutputs({indices});
+  auto onehot = graph->CreateOperation<tim::vx::ops::OneHot>(3);
+  (*onehot).BindInputs({indices}).BindOutputs({output});
+
+  auto transform = tim::transform::LayoutInference(graph, ctx);
+  auto infer_graph = transform.first;
+  uint32_t transposes = 0;
+  for (const auto& op : infer_graph->OpVector()) {
+    if (op->impl()->kind_ == VSI_NN_OP_PERMUTE) ++transposes;
+    // The indices reach the one hot in the layout of the conv
+    if (op->impl()->kind_ == VSI_NN_OP_ONE_HOT) {
+      auto producer =
+          infer_graph->GetProducerOp(op->impl()->InputsTensor()[0]);
+      ASSERT_NE(producer, nullptr);
+      EXPECT_NE(producer->impl()->kind_, VSI_NN_OP_PERMUTE);
+    }
+  }
+  EXPECT_EQ(transposes, 2u);
+
+  std::vector<float> in_data = {0, 1, 2, 1};
+  std::vector<float> golden = {1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 0};
+  auto graph_io_map = transform.second;
+  auto infer_input = graph_io_map[input];
+  auto infer_output = graph_io_map[output];
+  EXPECT_TRUE(infer_graph->Compile());
+  EXPECT_TRUE(infer_input->CopyDataToTensor(in_data.data(),
+                                            in_data.size() * sizeof(float)));
+  EXPECT_TRUE(infer_graph->Run());
+
+  std::vector<float> out_data(golden.size());
+  EXPECT_TRUE(infer_output->CopyDataFromTensor(out_data.data()));
+  EXPECT_EQ(golden, out_data);
+}
@@ -0,0 +1,200 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/op_elimination.h"
+
+#include <cstring>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "builtin_op_impl.h"
+#include "graph_rebuilder.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+
+namespace tim {
+namespace transform {
+namespace {
+
+using TensorMap =
+    std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>;
+
+template <typename T>
+void AppendKey(std::string& key, const T& value) {
+  key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void AppendKey(std::string& key, const vx::TensorSpec& spec) {
+  const auto& quant = spec.quantization_;
+  AppendKey(key, spec.datatype_);
+  AppendKey(key, spec.attr_);
+  AppendKey(key, spec.shape_.size());
+  for (auto d : spec.shape_) AppendKey(key, d);
+  AppendKey(key, quant.Type());
+  AppendKey(key, quant.ChannelDim());
+  AppendKey(key, quant.Scales().size());
+  for (auto s : quant.Scales()) AppendKey(key, s);
+  for (auto zp : quant.ZeroPoints()) AppendKey(key, zp);
+  AppendKey(key, quant.Fl());
+}
+
+// Params of the ovxlib node an op was lowered to. vsi_nn_NewNode zeroes the
+// node and ops set the param fields one by one, so the union's padding and
+// unused tail compare equal. Params pointing at arrays the op owns are keyed
+// by the array contents, other pointers only match the same pointer
+void AppendNodeParams(std::string& key, const vsi_nn_node_t* node) {
+  switch (node->op) {
+    case VSI_NN_OP_PERMUTE: {
+      const auto& param = node->nn_param.permute;
+      AppendKey(key, param.dim_num);
+      for (uint32_t i = 0; param.perm && i < param.dim_num; ++i) {
+        AppendKey(key, param.perm[i]);
+      }
+      break;
+    }
+#ifdef _VSI_NN_OP_RESHAPE2_H
+    case VSI_NN_OP_RESHAPE2: {
+      const auto& param = node->nn_param.reshape2;
+#else
+    case VSI_NN_OP_RESHAPE: {
+      const auto& param = node->nn_param.reshape;
+#endif
+      AppendKey(key, param.dim_num);
+      for (uint32_t i = 0; param.size && i < param.dim_num; ++i) {
+        AppendKey(key, param.size[i]);
+      }
+      break;
+    }
+    default:
+      AppendKey(key, node->nn_param);
+      break;
+  }
+  AppendKey(key, node->vx_param);
+}
+
+}  // namespace
+
+std::pair<std::shared_ptr<vx::Graph>, TensorMap> DeadOpElimination(
+    const std::shared_ptr<vx::Graph>& src_graph,
+    std::shared_ptr<vx::Context>& ctx, uint32_t* removed_ops) {
+  std::vector<std::shared_ptr<vx::Operation>> sorted;
+  if (!SortOps(src_graph, sorted)) {
+    VSILOGE("Graph has a cycle, dead ops are not eliminated.");
+    return std::make_pair(nullptr, TensorMap());
+  }
+
+  GraphRebuilder rebuilder(src_graph, ctx);
+  // Consumers follow their producers, so a reverse walk sees whether any
+  // consumer of an op is live before the op itself
+  std::set<std::shared_ptr<vx::Operation>> live;
+  for (auto op = sorted.rbegin(); op != sorted.rend(); ++op) {
+    for (const auto& output : (*op)->impl()->OutputsTensor()) {
+      bool used = rebuilder.IsGraphOutput(output);
+      for (const auto& consumer : src_graph->GetConsumersOp(output)) {
+        used = used || live.count(consumer) != 0;
+      }
+      if (used) {
+        live.insert(*op);
+        break;
+      }
+    }
+  }
+
+  for (const auto& op : sorted) {
+    if (live.count(op)) rebuilder.Clone(op);
+  }
+  if (removed_ops) {
+    *removed_ops = static_cast<uint32_t>(sorted.size() - live.size());
+  }
+  return std::make_pair(rebuilder.graph(), rebuilder.io_map());
+}
+
+std::pair<std::shared_ptr<vx::Graph>, TensorMap>
+CommonSubexpressionElimination(const std::shared_ptr<vx::Graph>& src_graph,
+                               std::shared_ptr<vx::Context>& ctx,
+                               uint32_t* removed_ops) {
+  std::vector<std::shared_ptr<vx::Operation>> sorted;
+  if (!SortOps(src_graph, sorted)) {
+    VSILOGE("Graph has a cycle, common subexpressions are not eliminated.");
+    return std::make_pair(nullptr, TensorMap());
+  }
+
+  GraphRebuilder rebuilder(src_graph, ctx);
+  // Tensors of eliminated ops to the same output of the op kept for them
+  TensorMap replaced;
+  // Ops already kept by everything that makes two ops compute the same
+  std::unordered_map<std::string, std::shared_ptr<vx::Operation>> computed;
+  uint32_t removed = 0;
+  for (const auto& op : sorted) {
+    auto inputs = op->impl()->InputsTensor();
+    auto outputs = op->impl()->OutputsTensor();
+    uint64_t digest = 0;
+    if (inputs.empty() || !src_graph->GetOpParamDigest(op.get(), digest)) {
+      rebuilder.Clone(op);
+      continue;
+    }
+
+    std::string key;
+    AppendKey(key, op->impl()->kind_);
+    AppendKey(key, digest);
+    AppendKey(key, op->impl()->layout_);
+    // The digest is only a hash of the creation params, the params lowered
+    // to the node are compared in full
+    auto node = op->impl()->node();
+    if (node) AppendNodeParams(key, node);
+    AppendKey(key, inputs.size());
+    for (const auto& input : inputs) {
+      auto it = replaced.find(input);
+      AppendKey(key, it != replaced.end() ? it->second.get() : input.get());
+    }
+    AppendKey(key, outputs.size());
+    bool writes_graph_output = false;
+    for (const auto& output : outputs) {
+      AppendKey(key, output->GetSpec());
+      writes_graph_output =
+          writes_graph_output || rebuilder.IsGraphOutput(output);
+    }
+
+    auto it = computed.find(key);
+    if (computed.end() == it || writes_graph_output) {
+      rebuilder.Clone(op);
+      computed.emplace(key, op);
+      continue;
+    }
+    const auto& same = it->second;
+    auto same_outputs = same->impl()->OutputsTensor();
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      replaced[outputs[i]] = same_outputs[i];
+      rebuilder.Map(outputs[i], rebuilder.Mapped(same_outputs[i]));
+    }
+    ++removed;
+  }
+  if (removed_ops) *removed_ops = removed;
+  return std::make_pair(rebuilder.graph(), rebuilder.io_map());
+}
+
+}  // namespace transform
+}  // namespace tim
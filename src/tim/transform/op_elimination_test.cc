@@ -0,0 +1,146 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/op_elimination.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "op_impl.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+uint32_t CountOps(const std::shared_ptr<tim::vx::Graph>& graph,
+                  int32_t kind) {
+  uint32_t count = 0;
+  for (const auto& op : graph->OpVector()) {
+    if (op->impl()->kind_ == kind) ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(OpElimination, dead_branch) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {4},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, {4},
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {4},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto input = graph->CreateTensor(input_spec);
+  auto output = graph->CreateTensor(output_spec);
+  auto sigmoid_out = graph->CreateTensor(transient_spec);
+  graph->CreateOperation<tim::vx::ops::Relu>()->BindInput(input).BindOutput(
+      output);
+  // Branch whose result is never read
+  graph->CreateOperation<tim::vx::ops::Sigmoid>()->BindInput(input).BindOutput(
+      sigmoid_out);
+  graph->CreateOperation<tim::vx::ops::Tanh>()
+      ->BindInput(sigmoid_out)
+      .BindOutput(graph->CreateTensor(transient_spec));
+
+  uint32_t removed = 0;
+  auto result = tim::transform::DeadOpElimination(graph, ctx, &removed);
+  ASSERT_NE(result.first, nullptr);
+  EXPECT_EQ(removed, 2u);
+  ASSERT_EQ(result.first->OpVector().size(), 1u);
+  EXPECT_EQ(CountOps(result.first, VSI_NN_OP_RELU), 1u);
+
+  std::vector<float> input_data{-1.0f, 2.0f, -3.0f, 4.0f};
+  std::vector<float> golden{0.0f, 2.0f, 0.0f, 4.0f};
+  std::vector<float> output_data(4);
+  EXPECT_TRUE(result.first->Compile());
+  EXPECT_TRUE(result.second[input]->CopyDataToTensor(
+      input_data.data(), input_data.size() * sizeof(float)));
+  EXPECT_TRUE(result.first->Run());
+  EXPECT_TRUE(result.second[output]->CopyDataFromTensor(output_data.data()));
+  EXPECT_TRUE(ArraysMatch(golden, output_data, 1e-5f));
+}
+
+TEST(OpElimination, shared_transpose) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {2, 3},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, {3, 2},
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {3, 2},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto input = graph->CreateTensor(input_spec);
+  auto output = graph->CreateTensor(output_spec);
+  std::vector<std::shared_ptr<tim::vx::Tensor>> transposed;
+  for (int i = 0; i < 3; ++i) {
+    transposed.push_back(graph->CreateTensor(transient_spec));
+    graph
+        ->CreateOperation<tim::vx::ops::Transpose>(
+            std::vector<uint32_t>({1, 0}))
+        ->BindInput(input)
+        .BindOutput(transposed.back());
+  }
+  // A different permutation of the same shape is not the same op
+  auto identity = graph->CreateTensor(tim::vx::TensorSpec(
+      tim::vx::DataType::FLOAT32, {2, 3}, tim::vx::TensorAttribute::TRANSIENT));
+  graph
+      ->CreateOperation<tim::vx::ops::Transpose>(std::vector<uint32_t>({0, 1}))
+      ->BindInput(input)
+      .BindOutput(identity);
+  auto reshaped = graph->CreateTensor(transient_spec);
+  graph->CreateOperation<tim::vx::ops::Reshape>(std::vector<uint32_t>({3, 2}))
+      ->BindInput(identity)
+      .BindOutput(reshaped);
+  auto sum = graph->CreateTensor(transient_spec);
+  auto product = graph->CreateTensor(transient_spec);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({transposed[0], transposed[1]})
+      .BindOutput(sum);
+  graph->CreateOperation<tim::vx::ops::Multiply>()
+      ->BindInputs({sum, transposed[2]})
+      .BindOutput(product);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({product, reshaped})
+      .BindOutput(output);
+
+  uint32_t removed = 0;
+  auto result =
+      tim::transform::CommonSubexpressionElimination(graph, ctx, &removed);
+  ASSERT_NE(result.first, nullptr);
+  EXPECT_EQ(removed, 2u);
+  EXPECT_EQ(result.first->OpVector().size(), 6u);
+  EXPECT_EQ(CountOps(result.first, VSI_NN_OP_PERMUTE), 2u);
+
+  // x = {1..6}, 2 * x^T * x^T + x
+  std::vector<float> input_data{1, 2, 3, 4, 5, 6};
+  std::vector<float> golden{3, 20, 53, 12, 37, 78};
+  std::vector<float> output_data(6);
+  EXPECT_TRUE(result.first->Compile());
+  EXPECT_TRUE(result.second[input]->CopyDataToTensor(
+      input_data.data(), input_data.size() * sizeof(float)));
+  EXPECT_TRUE(result.first->Run());
+  EXPECT_TRUE(result.second[output]->CopyDataFromTensor(output_data.data()));
+  EXPECT_TRUE(ArraysMatch(golden, output_data, 1e-5f));
+}
@@ -25,6 +25,8 @@
 #define TIM_LAYOUT_INFER_ACTIVATION_LAYOUT_INFERENCE_H_
 
 #include "tim/vx/ops/activations.h"
+#include "tim/vx/ops/clip.h"
+#include "tim/vx/ops/erf.h"
 #include "tim/vx/ops/reshape.h"
 
 #include "ops/op_layout_inference.h"
@@ -83,12 +85,10 @@ class PReluLayoutInfer : public OpLayoutInfer {
       }
 
       if (src_slope->IsConstTensor()) {
-        std::vector<uint8_t> dataRef(src_slope->GetSpec().GetByteSize());
-        src_slope->CopyDataFromTensor(dataRef.data());
         auto infer_slope_spec = src_slope->GetSpec();
         infer_slope_spec.SetShape(boardcast_shape);
-        auto infer_slope = context_->infer_graph_->CreateTensor(
-            infer_slope_spec, (const void*)dataRef.data());
+        auto infer_slope =
+            context_->CloneConstTensor(src_slope, infer_slope_spec);
 
         if (!input_pv->IsAligned()) {
           //The dimension of slop is already the same as input, directly use input_pv to convert
@@ -114,11 +114,7 @@ class PReluLayoutInfer : public OpLayoutInfer {
       context_->SetPermuteVector(src_slope, input_pv);
     } else {  // 1d slope tensor need not transpose
       if (src_slope->IsConstTensor()) {
-        std::vector<uint8_t> dataRef(src_slope->GetSpec().GetByteSize());
-        src_slope->CopyDataFromTensor(dataRef.data());
-        auto infer_slope_spec = src_slope->GetSpec();
-        auto infer_slope = context_->infer_graph_->CreateTensor(
-            infer_slope_spec, (const void*)dataRef.data());
+        auto infer_slope = context_->CloneConstTensor(src_slope);
         context_->UpdateTensorMap(src_slope, infer_slope);
         context_->SetPermuteVector(src_slope, MakeShared(1));
       }
@@ -149,6 +145,18 @@ using HardSigmoidLayoutInfer = ActivationLayoutInfer<vx::ops::HardSigmoid>;
 using SoftReluLayoutInfer = ActivationLayoutInfer<vx::ops::SoftRelu>;
 using HardSwishLayoutInfer = ActivationLayoutInfer<vx::ops::HardSwish>;
 using TanhLayoutInfer = ActivationLayoutInfer<vx::ops::Tanh>;
+using SignLayoutInfer = ActivationLayoutInfer<vx::ops::Sign>;
+using SoftSignLayoutInfer = ActivationLayoutInfer<vx::ops::SoftSign>;
+using LinearLayoutInfer = ActivationLayoutInfer<vx::ops::Linear>;
+using GeluLayoutInfer = ActivationLayoutInfer<vx::ops::Gelu>;
+#ifdef _VSI_NN_OP_SELU_H
+using SeluLayoutInfer = ActivationLayoutInfer<vx::ops::Selu>;
+#endif
+#ifdef _VSI_NN_OP_CELU_H
+using CeluLayoutInfer = ActivationLayoutInfer<vx::ops::Celu>;
+#endif
+using ClipLayoutInfer = ActivationLayoutInfer<vx::ops::Clip>;
+using ErfLayoutInfer = ActivationLayoutInfer<vx::ops::Erf>;
 
 }  // namespace transform
 }  // namespace tim
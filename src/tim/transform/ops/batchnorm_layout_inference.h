@@ -52,9 +52,7 @@ class BatchNormLayoutInfer : public OpLayoutInfer {
         std::shared_ptr<IPermuteVector> input_pv;
         auto src_in = input_tensors[idx];
         if (src_in->IsConstTensor()) {
-            std::vector<uint8_t> dataRef(src_in->GetSpec().GetByteSize());
-            src_in->CopyDataFromTensor(dataRef.data());
-            perm_out = context_->infer_graph_->CreateTensor(src_in->GetSpec(), (const void*)dataRef.data());
+            perm_out = context_->CloneConstTensor(src_in);
             input_pv = MakeShared(src_in->GetShape().size());
         } else {
           perm_out = context_->GetMappedTensor(src_in);
@@ -92,10 +92,7 @@ class Conv2dLayoutInfer : public OpLayoutInfer {
       if (!weight_required_pv->IsAligned()) {
         infer_weight = PermuteConstTensor(input_tensors[1], weight_required_pv);
       } else {
-        std::vector<uint8_t> dataRef(input_tensors[1]->GetSpec().GetByteSize());
-        input_tensors[1]->CopyDataFromTensor(dataRef.data());
-        infer_weight = context_->infer_graph_->CreateTensor(
-            input_tensors[1]->GetSpec(), (const void*)dataRef.data());
+        infer_weight = context_->CloneConstTensor(input_tensors[1]);
       }
       context_->SetPermuteVector(input_tensors[1], weight_required_pv);
       context_->UpdateTensorMap(input_tensors[1], infer_weight);
@@ -116,10 +113,7 @@ class Conv2dLayoutInfer : public OpLayoutInfer {
     // For bias
     if (input_tensors.size() == 3) {
       if (input_tensors[2]->IsConstTensor()) {
-        std::vector<uint8_t> dataRef(input_tensors[2]->GetSpec().GetByteSize());
-        input_tensors[2]->CopyDataFromTensor(dataRef.data());
-        infer_bias = context_->infer_graph_->CreateTensor(
-            input_tensors[2]->GetSpec(), (const void*)dataRef.data());
+        infer_bias = context_->CloneConstTensor(input_tensors[2]);
       } else {
         infer_bias = context_->GetMappedTensor(input_tensors[2]);
       }
@@ -53,10 +53,7 @@ class Conv3dLayoutInfer : public OpLayoutInfer {
           !(in->GetSpec().attr_ & vx::TensorAttribute::INPUT)) {
             // For bias
             if (in->GetShape().size() == 1) {
-              std::vector<uint8_t> dataRef(in->GetSpec().GetByteSize());
-              in->CopyDataFromTensor(dataRef.data());
-              infer_tensor = context_->infer_graph_->CreateTensor(
-                  in->GetSpec(), (const void*)dataRef.data());
+              infer_tensor = context_->CloneConstTensor(in);
               trans_pv = MakeShared(1);
             } else {
               // For input/weight
@@ -71,10 +68,7 @@ class Conv3dLayoutInfer : public OpLayoutInfer {
                   trans_pv = required_pv;
                 }
               } else {
-                std::vector<uint8_t> dataRef(in->GetSpec().GetByteSize());
-                in->CopyDataFromTensor(dataRef.data());
-                infer_tensor = context_->infer_graph_->CreateTensor(
-                    in->GetSpec(), (const void*)dataRef.data());
+                infer_tensor = context_->CloneConstTensor(in);
                 trans_pv = MakeShared(required_pv->Rank());
               }
             }
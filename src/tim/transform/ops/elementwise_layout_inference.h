@@ -25,6 +25,7 @@
 #define TIM_LAYOUT_INFER_ElEMENTWISE_LAYOUT_INFERENCE_H_
 
 #include "tim/vx/ops/elementwise.h"
+#include "tim/vx/ops/relational_operations.h"
 
 #include "ops/op_layout_inference.h"
 #include "permute_vector.h"
@@ -135,6 +136,16 @@ using DivLayoutInfer = ElementWiseLayoutInfer<tim::vx::ops::Div>;
 using PowLayoutInfer = ElementWiseLayoutInfer<tim::vx::ops::Pow>;
 using MinimumLayoutInfer = ElementWiseLayoutInfer<tim::vx::ops::Minimum>;
 using MaximumLayoutInfer = ElementWiseLayoutInfer<tim::vx::ops::Maximum>;
+using FloorDivLayoutInfer = ElementWiseLayoutInfer<tim::vx::ops::FloorDiv>;
+
+using GreaterLayoutInfer = ElementWiseLayoutInfer<tim::vx::ops::Greater>;
+using GreaterOrEqualLayoutInfer =
+    ElementWiseLayoutInfer<tim::vx::ops::GreaterOrEqual>;
+using LessLayoutInfer = ElementWiseLayoutInfer<tim::vx::ops::Less>;
+using LessOrEqualLayoutInfer =
+    ElementWiseLayoutInfer<tim::vx::ops::LessOrEqual>;
+using NotEqualLayoutInfer = ElementWiseLayoutInfer<tim::vx::ops::NotEqual>;
+using EqualLayoutInfer = ElementWiseLayoutInfer<tim::vx::ops::Equal>;
 
 }  // namespace transform
 }  // namespace tim
@@ -49,10 +49,7 @@ class FullyConnectedLayoutInfer : public OpLayoutInfer {
     }
     for (const auto& in : input_tensors) {
       if (in->IsConstTensor()) {
-        std::vector<uint8_t> dataRef(in->GetSpec().GetByteSize());
-        in->CopyDataFromTensor(dataRef.data());
-        auto infer_tensor = context_->infer_graph_->CreateTensor(in->GetSpec(),
-                                                            (const void*)dataRef.data());
+        auto infer_tensor = context_->CloneConstTensor(in);
         auto trans_pv = MakeShared(in->GetShape().size());
 
         context_->UpdateTensorMap(in, infer_tensor);
@@ -0,0 +1,86 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_LAYOUT_INFER_GATHER_ELEMENTS_LAYOUT_INFERENCE_H_
+#define TIM_LAYOUT_INFER_GATHER_ELEMENTS_LAYOUT_INFERENCE_H_
+
+#include "tim/vx/ops/gather_elements.h"
+
+#include "ops/op_layout_inference.h"
+#include "permute_vector.h"
+#include "builtin_op_impl.h"
+
+#ifdef _VSI_NN_OP_GATHER_ELEMENTS_H
+namespace tim {
+namespace transform {
+class GatherElementsLayoutInfer : public OpLayoutInfer {
+ public:
+  GatherElementsLayoutInfer(
+      const std::shared_ptr<vx::Operation> op,
+      std::shared_ptr<layout_inference_impl::LayoutInferContext>& context)
+      : OpLayoutInfer(op, context) {}
+
+  void OnInputs(
+      std::vector<std::shared_ptr<vx::Tensor>>& next_tensors) override {
+    auto input_tensors = op_->impl()->InputsTensor();
+    auto pv = context_->GetPermuteVector(input_tensors[0]);
+    auto indices = input_tensors[1];
+
+    // Indices have the rank of the data, align them to its layout
+    if (indices->IsConstTensor()) {
+      auto infer_indices = pv->IsAligned()
+                               ? context_->CloneConstTensor(indices)
+                               : PermuteConstTensor(indices, pv);
+      context_->UpdateTensorMap(indices, infer_indices);
+    } else {
+      auto final_pv =
+          context_->GetPermuteVector(indices)->Reverse()->Add(pv);
+      if (!final_pv->IsAligned()) {
+        auto perm_out =
+            InsertPermute(context_->GetMappedTensor(indices), final_pv);
+        context_->UpdateTensorMap(indices, perm_out);
+      }
+    }
+    context_->SetPermuteVector(indices, pv);
+
+    int32_t axis = op_->impl()->node()->nn_param.gather_elements.axis;
+    if (axis < 0) axis += pv->Rank();
+    axis = MapAxis(pv->AsStdVec(), static_cast<uint32_t>(axis));
+    auto gather =
+        context_->infer_graph_->CreateOperation<vx::ops::GatherElements>(
+            axis);
+    auto out_infer = CreateOutputsTensor(pv);
+    (*gather)
+        .BindInput(context_->GetMappedTensor(input_tensors[0]))
+        .BindInput(context_->GetMappedTensor(indices));
+    (*gather).BindOutput(out_infer[0]);
+    context_->SetPermuteVector(op_->impl()->OutputsTensor()[0], pv);
+    next_tensors.push_back(op_->impl()->OutputsTensor()[0]);
+  }
+};
+
+}  // namespace transform
+}  // namespace tim
+#endif  // _VSI_NN_OP_GATHER_ELEMENTS_H
+
+#endif
@@ -73,10 +73,7 @@ class InstanceNormLayoutInfer : public OpLayoutInfer {
 
     for (const auto& t_src : op_->impl()->InputsTensor()) {
       if(t_src->IsConstTensor()) {
-        std::vector<uint8_t> dataRef(t_src->GetSpec().GetByteSize());
-        t_src->CopyDataFromTensor(dataRef.data());
-        auto t_infer = context_->infer_graph_->CreateTensor(
-                t_src->GetSpec(), (const void*)dataRef.data());
+        auto t_infer = context_->CloneConstTensor(t_src);
         context_->SetPermuteVector(t_src, MakeShared(t_src->GetShape().size()));
         context_->UpdateTensorMap(t_src, t_infer);
       }
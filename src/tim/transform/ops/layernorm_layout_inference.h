@@ -0,0 +1,70 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_LAYOUT_INFER_LAYERNORM_LAYOUT_INFERENCE_H_
+#define TIM_LAYOUT_INFER_LAYERNORM_LAYOUT_INFERENCE_H_
+
+#include "tim/vx/ops/layernormalization.h"
+
+#include "ops/default_layout_inference.h"
+#include "permute_vector.h"
+#include "builtin_op_impl.h"
+
+namespace tim {
+namespace transform {
+class LayerNormLayoutInfer : public DefaultLayoutInfer {
+ public:
+  LayerNormLayoutInfer(
+      const std::shared_ptr<vx::Operation> op,
+      std::shared_ptr<layout_inference_impl::LayoutInferContext>& context)
+      : DefaultLayoutInfer(op, context) {}
+
+  // Scale and bias are laid out along the normalized axis, so the input
+  // permute is only passed through when it keeps that axis in place.
+  void OnInputs(
+      std::vector<std::shared_ptr<vx::Tensor>>& next_tensors) override {
+    auto input_tensors = op_->impl()->InputsTensor();
+    auto pv = context_->GetPermuteVector(input_tensors[0]);
+    int32_t axis = op_->impl()->node()->nn_param.layernorm.axis;
+    if (axis < 0) axis += pv->Rank();
+    if (MapAxis(pv->AsStdVec(), static_cast<uint32_t>(axis)) !=
+        static_cast<uint32_t>(axis)) {
+      DefaultLayoutInfer::OnInputs(next_tensors);
+      return;
+    }
+
+    auto layernorm = op_->Clone(context_->infer_graph_);
+    for (const auto& i_src : input_tensors) {
+      (*layernorm).BindInput(context_->GetMappedTensor(i_src));
+    }
+    auto out_infer = CreateOutputsTensor(pv);
+    (*layernorm).BindOutput(out_infer[0]);
+    context_->SetPermuteVector(op_->impl()->OutputsTensor()[0], pv);
+    next_tensors.push_back(op_->impl()->OutputsTensor()[0]);
+  }
+};
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
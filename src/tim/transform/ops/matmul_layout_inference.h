@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_LAYOUT_INFER_MATMUL_LAYOUT_INFERENCE_H_
+#define TIM_LAYOUT_INFER_MATMUL_LAYOUT_INFERENCE_H_
+
+#include "tim/vx/ops/matmul.h"
+
+#include "ops/default_layout_inference.h"
+#include "permute_vector.h"
+#include "builtin_op_impl.h"
+
+namespace tim {
+namespace transform {
+class MatMulLayoutInfer : public DefaultLayoutInfer {
+ public:
+  MatMulLayoutInfer(
+      const std::shared_ptr<vx::Operation> op,
+      std::shared_ptr<layout_inference_impl::LayoutInferContext>& context)
+      : DefaultLayoutInfer(op, context) {}
+
+  // A permute which only swaps the two matrix axes is absorbed by flipping
+  // transpose_a/b, a permute of the batch axes is passed through to the
+  // output when both inputs agree on it. Anything else falls back to the
+  // default handler.
+  void OnInputs(
+      std::vector<std::shared_ptr<vx::Tensor>>& next_tensors) override {
+    auto& param = op_->impl()->node()->nn_param.matrixmul;
+    auto input_tensors = op_->impl()->InputsTensor();
+    uint32_t rank = op_->impl()->OutputsTensor()[0]->GetShape().size();
+
+    bool propagate = !param.adjoint[0] && !param.adjoint[1];
+    std::array<bool, 2> transpose = {param.transpose[0] != 0,
+                                     param.transpose[1] != 0};
+    std::vector<uint32_t> batch_perm;
+    for (size_t i = 0; propagate && i < 2; ++i) {
+      auto pv = context_->GetPermuteVector(input_tensors[i])->AsStdVec();
+      if ((pv.size() != 2 && pv.size() != rank) || pv[0] > 1 || pv[1] > 1) {
+        propagate = false;
+        break;
+      }
+      if (pv[0] == 1) transpose[i] = !transpose[i];
+      std::vector<uint32_t> batch(pv.begin() + 2, pv.end());
+      if (batch.empty()) continue;
+      if (batch_perm.empty()) {
+        batch_perm = batch;
+      } else if (batch_perm != batch) {
+        propagate = false;
+      }
+    }
+    if (!propagate) {
+      DefaultLayoutInfer::OnInputs(next_tensors);
+      return;
+    }
+
+    auto out_pv = MakeShared(rank);
+    for (uint32_t i = 0; i < batch_perm.size(); ++i) {
+      out_pv->At(i + 2) = batch_perm[i];
+    }
+    auto matmul = context_->infer_graph_->CreateOperation<vx::ops::Matmul>(
+        transpose[0], transpose[1]);
+    for (const auto& i_src : input_tensors) {
+      (*matmul).BindInput(context_->GetMappedTensor(i_src));
+    }
+    auto out_infer = CreateOutputsTensor(out_pv);
+    (*matmul).BindOutput(out_infer[0]);
+    context_->SetPermuteVector(op_->impl()->OutputsTensor()[0], out_pv);
+    next_tensors.push_back(op_->impl()->OutputsTensor()[0]);
+  }
+};
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_LAYOUT_INFER_ONEHOT_LAYOUT_INFERENCE_H_
+#define TIM_LAYOUT_INFER_ONEHOT_LAYOUT_INFERENCE_H_
+
+#include "tim/vx/ops/onehot.h"
+
+#include "ops/op_layout_inference.h"
+#include "permute_vector.h"
+#include "builtin_op_impl.h"
+
+namespace tim {
+namespace transform {
+class OneHotLayoutInfer : public OpLayoutInfer {
+ public:
+  OneHotLayoutInfer(
+      const std::shared_ptr<vx::Operation> op,
+      std::shared_ptr<layout_inference_impl::LayoutInferContext>& context)
+      : OpLayoutInfer(op, context) {}
+
+  // The one hot axis is inserted at the same position of the permuted input,
+  // the input axes around it keep their permutation in the output.
+  void OnInputs(
+      std::vector<std::shared_ptr<vx::Tensor>>& next_tensors) override {
+    auto input_tensors = op_->impl()->InputsTensor();
+    auto pv = context_->GetPermuteVector(input_tensors[0]);
+    const auto& param = op_->impl()->node()->nn_param.one_hot;
+    uint32_t axis = param.axis == -1 ? 0 : param.axis;
+
+    auto shift = [axis](uint32_t dim) { return dim < axis ? dim : dim + 1; };
+    auto out_pv = MakeShared(pv->Rank() + 1);
+    for (uint32_t i = 0; i < out_pv->Rank(); ++i) {
+      if (i < axis) {
+        out_pv->At(i) = shift(pv->At(i));
+      } else if (i > axis) {
+        out_pv->At(i) = shift(pv->At(i - 1));
+      }
+    }
+
+    auto onehot = context_->infer_graph_->CreateOperation<vx::ops::OneHot>(
+        param.depth, param.on_value, param.off_value, param.axis);
+    auto out_infer = CreateOutputsTensor(out_pv);
+    (*onehot).BindInput(context_->GetMappedTensor(input_tensors[0]));
+    (*onehot).BindOutput(out_infer[0]);
+    context_->SetPermuteVector(op_->impl()->OutputsTensor()[0], out_pv);
+    next_tensors.push_back(op_->impl()->OutputsTensor()[0]);
+  }
+};
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
@@ -29,6 +29,7 @@
 #include "type_utils.h"
 
 #include <algorithm>
+#include <limits>
 #include <vector>
 
 namespace tim {
@@ -190,15 +191,52 @@ uint32_t OpLayoutInfer::MapAxis(const std::vector<uint32_t>& perm,
   return perm.size() - 1;
 }
 
+std::shared_ptr<IPermuteVector> OpLayoutInfer::SelectRequiredPermuteVector(
+    uint32_t rank) {
+  std::vector<std::pair<std::shared_ptr<IPermuteVector>, int64_t>> inputs;
+  for (const auto& in : op_->impl()->InputsTensor()) {
+    if (!in->IsConstTensor() && in->GetShape().size() == rank) {
+      inputs.emplace_back(context_->GetPermuteVector(in),
+                          std::max<int64_t>(in->GetSpec().GetByteSize(), 1));
+    }
+  }
+
+  // Graph outputs left in a permuted layout need one more transpose
+  int64_t graph_output_bytes = 0;
+  auto graph_outputs = context_->src_graph_->OutputsTensor();
+  for (const auto& out : op_->impl()->OutputsTensor()) {
+    if (graph_outputs.cend() !=
+        std::find(graph_outputs.cbegin(), graph_outputs.cend(), out)) {
+      graph_output_bytes += std::max<int64_t>(out->GetSpec().GetByteSize(), 1);
+    }
+  }
+
+  std::shared_ptr<IPermuteVector> required_pv = nullptr;
+  int64_t min_cost = std::numeric_limits<int64_t>::max();
+  for (const auto& candidate : inputs) {
+    int64_t cost = candidate.first->IsAligned() ? 0 : graph_output_bytes;
+    for (const auto& in : inputs) {
+      if (!in.first->Reverse()->Add(candidate.first)->IsAligned()) {
+        cost += in.second;
+      }
+    }
+    // Ties keep the earlier input
+    if (cost < min_cost) {
+      min_cost = cost;
+      required_pv = candidate.first;
+    }
+  }
+  return required_pv;
+}
+
 std::shared_ptr<IPermuteVector>
 OpLayoutInfer::AlignPermuteVectorForMutilInputs() {
   auto src_inputs = op_->impl()->InputsTensor();
   // Suppose the inputs have same dimension rank
-  // TODO(yzw): should choose a optimal required_pv
   std::shared_ptr<IPermuteVector> required_pv = nullptr;
   for (const auto& in : src_inputs) {
     if (!in->IsConstTensor()) {
-      required_pv = context_->GetPermuteVector(in);
+      required_pv = SelectRequiredPermuteVector(in->GetShape().size());
       break;
     }
   }
@@ -206,22 +244,15 @@ OpLayoutInfer::AlignPermuteVectorForMutilInputs() {
   if (!required_pv) {
     // all inputs are constant tensors
     for (const auto& i_src : src_inputs) {
-      std::vector<uint8_t> dataRef(i_src->GetSpec().GetByteSize());
-      i_src->CopyDataFromTensor(dataRef.data());
-      context_->UpdateTensorMap(
-          i_src, context_->infer_graph_->CreateTensor(
-                     i_src->GetSpec(), (const void*)dataRef.data()));
+      context_->UpdateTensorMap(i_src, context_->CloneConstTensor(i_src));
       context_->SetPermuteVector(i_src, MakeShared(i_src->GetShape().size()));
     }
   } else {
     for (const auto& i_src : src_inputs) {
       std::shared_ptr<vx::Tensor> perm_out;
       if (i_src->IsConstTensor()) {
-        std::vector<uint8_t> dataRef(i_src->GetSpec().GetByteSize());
-        i_src->CopyDataFromTensor(dataRef.data());
         required_pv->IsAligned()
-            ? perm_out = context_->infer_graph_->CreateTensor(
-                  i_src->GetSpec(), (const void*)dataRef.data())
+            ? perm_out = context_->CloneConstTensor(i_src)
             : perm_out = PermuteConstTensor(i_src, required_pv);
       } else {
         auto final_pv =
@@ -246,20 +277,17 @@ OpLayoutInfer::AlignPermuteVectorForElementWise() {
   for (const auto& in : src_inputs) {
     int32_t rank = in->GetShape().size();
     if (!in->IsConstTensor() && rank > ref_rank) {
-      required_pv = context_->GetPermuteVector(in);
       ref_input = in;
       ref_rank = rank;
     }
   }
+  required_pv = SelectRequiredPermuteVector(ref_rank);
 
   for (auto i_src : src_inputs) {
     std::shared_ptr<vx::Tensor> perm_out;
     if (i_src->IsConstTensor()) {
       if (required_pv->IsAligned()) {
-        std::vector<uint8_t> dataRef(i_src->GetSpec().GetByteSize());
-        i_src->CopyDataFromTensor(dataRef.data());
-        perm_out = context_->infer_graph_->CreateTensor(
-            i_src->GetSpec(), (const void*)dataRef.data());
+        perm_out = context_->CloneConstTensor(i_src);
       } else if (i_src->GetShape().size() == required_pv->Rank()) {
         perm_out = PermuteConstTensor(i_src, required_pv);
         // need shape expansion
@@ -289,10 +317,7 @@ void OpLayoutInfer::ReverseInputsPermuteVector() {
     std::shared_ptr<IPermuteVector> input_pv;
     if (i_src->GetId() != (uint32_t)-1) {
       if (i_src->IsConstTensor()) {
-        std::vector<uint8_t> dataRef(i_src->GetSpec().GetByteSize());
-        i_src->CopyDataFromTensor(dataRef.data());
-        perm_out = context_->infer_graph_->CreateTensor(
-            i_src->GetSpec(), (const void*)dataRef.data());
+        perm_out = context_->CloneConstTensor(i_src);
         input_pv = MakeShared(i_src->GetShape().size());
       } else {
         perm_out = context_->GetMappedTensor(i_src);
@@ -321,16 +346,16 @@ std::vector<uint32_t> OpLayoutInfer::GetExpandedShape(
 
 bool OpLayoutInfer::TransposeConstTensorData(
     const std::shared_ptr<vx::Tensor>& input,
-    const std::shared_ptr<IPermuteVector>& pv, std::vector<uint8_t>& out_data) {
+    const std::shared_ptr<IPermuteVector>& pv, uint8_t* out_data) {
   auto vx_type = vx::TranslateDataType(input->GetDataType());
-  auto type_size = vsi_nn_GetTypeBytes(vx_type);
-  uint32_t out_size = 1;
-  for (const auto& s : input->GetShape()) out_size *= s;
-  out_size *= type_size;
-  out_data.resize(out_size);
   if (!input->IsConstTensor()) {
     return false;
   }
+  // Read straight from the data shared with clones of `input`
+  auto in_data = context_->GetConstData(input);
+  if (!in_data) {
+    return false;
+  }
 
   vx::ShapeType reverse_shape;
   for (int32_t i = input->GetShape().size() - 1; i >= 0; i--) {
@@ -355,9 +380,8 @@ bool OpLayoutInfer::TransposeConstTensorData(
                  [](const uint32_t& i) { return i; });
   std::transform(perm.begin(), perm.end(), std::back_inserter(native_perm),
                  [](const uint32_t& i) { return i; });
-  std::vector<uint8_t> dataRef(input->GetSpec().GetByteSize());
-  input->CopyDataFromTensor(dataRef.data());
-  vsi_nn_Transpose(out_data.data(), (uint8_t*)(dataRef.data()),
+  vsi_nn_Transpose(out_data,
+                   static_cast<uint8_t*>(const_cast<void*>(in_data.get())),
                    native_shape_array.data(),
                    static_cast<uint32_t>(input->GetShape().size()),
                    native_perm.data(), vx_type);
@@ -368,8 +392,10 @@ bool OpLayoutInfer::TransposeConstTensorData(
 std::shared_ptr<vx::Tensor> OpLayoutInfer::PermuteConstTensor(
     const std::shared_ptr<vx::Tensor>& input,
     const std::shared_ptr<IPermuteVector>& pv) {
-  std::vector<uint8_t> data;
-  bool is_ok = TransposeConstTensorData(input, pv, data);
+  // Permute into the buffer which backs the new tensor
+  auto data = context_->AllocConstData(input->GetSpec().GetByteSize());
+  bool is_ok = data && TransposeConstTensorData(
+                           input, pv, static_cast<uint8_t*>(data.get()));
   if (!is_ok) {
     assert(is_ok);
     return nullptr;
@@ -385,7 +411,7 @@ std::shared_ptr<vx::Tensor> OpLayoutInfer::PermuteConstTensor(
     dst_spec.quantization_.SetChannelDim(
         MapAxis(pv->AsStdVec(), dst_spec.quantization_.ChannelDim()));
   }
-  return context_->infer_graph_->CreateTensor(dst_spec, data.data());
+  return context_->CreateConstTensor(dst_spec, data);
 }
 
 std::vector<uint32_t> OpLayoutInfer::MapMultipleAxis(
@@ -79,6 +79,11 @@ class OpLayoutInfer {
 
   uint32_t MapAxis(const std::vector<uint32_t>& perm, uint32_t axis);
 
+  // Picks the permute vector of the rank-`rank` non-constant input which
+  // moves the fewest bytes through transposes when the inputs are aligned to
+  // it. Constant inputs are permuted on host and do not count.
+  std::shared_ptr<IPermuteVector> SelectRequiredPermuteVector(uint32_t rank);
+
   std::shared_ptr<IPermuteVector> AlignPermuteVectorForMutilInputs();
 
   std::shared_ptr<IPermuteVector> AlignPermuteVectorForElementWise();
@@ -91,7 +96,7 @@ class OpLayoutInfer {
 
   bool TransposeConstTensorData(const std::shared_ptr<vx::Tensor>& input,
                                 const std::shared_ptr<IPermuteVector>& pv,
-                                std::vector<uint8_t>& out_data);
+                                uint8_t* out_data);
 
   std::shared_ptr<vx::Tensor> PermuteConstTensor(
       const std::shared_ptr<vx::Tensor>& input,
@@ -24,21 +24,26 @@
 #ifndef TIM_LAYOUT_INFER_POOL2D_LAYOUT_INFERENCE_H_
 #define TIM_LAYOUT_INFER_POOL2D_LAYOUT_INFERENCE_H_
 
-#include "ops/op_layout_inference.h"
+#include "ops/default_layout_inference.h"
 #include "permute_vector.h"
 #include "builtin_op_impl.h"
 #include "tim/vx/ops/pool2d.h"
 
 namespace tim {
 namespace transform {
-class Pool2dLayoutInfer : public OpLayoutInfer {
+class Pool2dLayoutInfer : public DefaultLayoutInfer {
  public:
   Pool2dLayoutInfer(
       const std::shared_ptr<vx::Operation> op,
       std::shared_ptr<layout_inference_impl::LayoutInferContext>& context)
-      : OpLayoutInfer(op, context) {}
+      : DefaultLayoutInfer(op, context) {}
   void OnInputs(
       std::vector<std::shared_ptr<vx::Tensor>>& next_tensors) override {
+    // Pool1d shares VSI_NN_OP_POOL and only runs in its native WCN layout
+    if (op_->impl()->InputsTensor()[0]->GetShape().size() == 3) {
+      DefaultLayoutInfer::OnInputs(next_tensors);
+      return;
+    }
     vx::DataLayout layout = op_->impl()->layout_;
     auto required_pv = MakeShared(4);
     if (layout == vx::DataLayout::CWHN) {
@@ -67,6 +67,11 @@ using SqrtLayoutInfer = SimpleOpsLayoutInfer<vx::ops::Sqrt>;
 using RsqrtLayoutInfer = SimpleOpsLayoutInfer<vx::ops::Rsqrt>;
 using SquareLayoutInfer = SimpleOpsLayoutInfer<vx::ops::Square>;
 using LogicalNotLayoutInfer = SimpleOpsLayoutInfer<vx::ops::LogicalNot>;
+using FloorLayoutInfer = SimpleOpsLayoutInfer<vx::ops::Floor>;
+using CeilLayoutInfer = SimpleOpsLayoutInfer<vx::ops::Ceil>;
+using RoundLayoutInfer = SimpleOpsLayoutInfer<vx::ops::Round>;
+using CastLayoutInfer = SimpleOpsLayoutInfer<vx::ops::Cast>;
+using RcpLayoutInfer = SimpleOpsLayoutInfer<vx::ops::Rcp>;
 
 #ifdef VSI_FEAT_OP_COS
 using CosLayoutInfer = SimpleOpsLayoutInfer<vx::ops::Cos>;
@@ -0,0 +1,69 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#ifndef TIM_LAYOUT_INFER_TOPK_LAYOUT_INFERENCE_H_
+#define TIM_LAYOUT_INFER_TOPK_LAYOUT_INFERENCE_H_
+
+#include "tim/vx/ops/topk.h"
+
+#include "ops/op_layout_inference.h"
+#include "permute_vector.h"
+#include "builtin_op_impl.h"
+
+namespace tim {
+namespace transform {
+class TopkLayoutInfer : public OpLayoutInfer {
+ public:
+  TopkLayoutInfer(
+      const std::shared_ptr<vx::Operation> op,
+      std::shared_ptr<layout_inference_impl::LayoutInferContext>& context)
+      : OpLayoutInfer(op, context) {}
+
+  void OnInputs(
+      std::vector<std::shared_ptr<vx::Tensor>>& next_tensors) override {
+    auto input_tensors = op_->impl()->InputsTensor();
+    auto pv = context_->GetPermuteVector(input_tensors[0]);
+    uint32_t k = op_->impl()->node()->nn_param.topk.k;
+    int32_t axis = op_->impl()->node()->nn_param.topk.axis;
+    if (axis < 0) axis += pv->Rank();
+    axis = MapAxis(pv->AsStdVec(), static_cast<uint32_t>(axis));
+
+    auto topk =
+        context_->infer_graph_->CreateOperation<vx::ops::Topk>(k, axis);
+    // Values and indices share the layout of the input
+    std::vector<std::shared_ptr<IPermuteVector>> out_pvs(
+        op_->impl()->OutputsTensor().size(), pv);
+    auto out_infer = CreateOutputsTensor(out_pvs);
+    (*topk).BindInput(context_->GetMappedTensor(input_tensors[0]));
+    (*topk).BindOutputs(out_infer);
+    for (const auto& out : op_->impl()->OutputsTensor()) {
+      context_->SetPermuteVector(out, pv);
+      next_tensors.push_back(out);
+    }
+  }
+};
+
+}  // namespace transform
+}  // namespace tim
+
+#endif
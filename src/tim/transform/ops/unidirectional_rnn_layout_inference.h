@@ -56,10 +56,7 @@ class UnidirectionalRnnLayoutInfer : public OpLayoutInfer {
       std::shared_ptr<IPermuteVector> required_pv;
       if ((i_src->IsConstTensor() &&
               !(i_src->GetSpec().attr_ & vx::TensorAttribute::INPUT))) {
-        std::vector<uint8_t> dataRef(i_src->GetSpec().GetByteSize());
-        i_src->CopyDataFromTensor(dataRef.data());
-        infer_tensor = context_->infer_graph_->CreateTensor(
-            i_src->GetSpec(), (const void*)dataRef.data());
+        infer_tensor = context_->CloneConstTensor(i_src);
         context_->UpdateTensorMap(i_src, infer_tensor);
       }
       if (i_src->GetId() == (uint32_t)-1) {
@@ -46,10 +46,7 @@ class Yolov4LayoutInfer : public OpLayoutInfer {
 
     for (const auto& i_src : op_->impl()->InputsTensor()) {
       if (i_src->IsConstTensor()) {
-        std::vector<uint8_t> dataRef(i_src->GetSpec().GetByteSize());
-        i_src->CopyDataFromTensor(dataRef.data());
-        auto i_infer = context_->infer_graph_->CreateTensor(
-            i_src->GetSpec(), (const void*)dataRef.data());
+        auto i_infer = context_->CloneConstTensor(i_src);
         context_->SetPermuteVector(i_src, MakeShared(4));
         context_->UpdateTensorMap(i_src, i_infer);
       } 
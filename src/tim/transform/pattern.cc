@@ -0,0 +1,250 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "pattern.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+#include "builtin_op_impl.h"
+
+namespace tim {
+namespace transform {
+namespace fusion {
+
+Pattern Input() {
+  return std::make_shared<PatternNode>(PatternNode::Type::kInput);
+}
+
+Pattern Const(TensorPredicate predicate) {
+  auto node = std::make_shared<PatternNode>(PatternNode::Type::kConst);
+  node->tensor_predicate_ = std::move(predicate);
+  return node;
+}
+
+Pattern Scalar(float value, float tolerance) {
+  return Const([value, tolerance](const std::shared_ptr<vx::Tensor>& t) {
+    return t->GetSpec().GetElementNum() == 1 &&
+           std::fabs(ScalarValue(t) - value) <= tolerance;
+  });
+}
+
+Pattern Op(int32_t kind, std::vector<Pattern> inputs, OpPredicate predicate) {
+  auto node = std::make_shared<PatternNode>(PatternNode::Type::kOp);
+  node->kind_ = kind;
+  node->inputs_ = std::move(inputs);
+  node->op_predicate_ = std::move(predicate);
+  return node;
+}
+
+Pattern CommutativeOp(int32_t kind, Pattern a, Pattern b) {
+  auto node = Op(kind, {std::move(a), std::move(b)});
+  node->commutative_ = true;
+  return node;
+}
+
+Pattern AnyOf(std::vector<Pattern> alternatives) {
+  auto node = std::make_shared<PatternNode>(PatternNode::Type::kAnyOf);
+  node->inputs_ = std::move(alternatives);
+  return node;
+}
+
+Pattern Add(Pattern a, Pattern b) {
+  return CommutativeOp(VSI_NN_OP_ADD, std::move(a), std::move(b));
+}
+
+Pattern Mul(Pattern a, Pattern b) {
+  auto node = CommutativeOp(VSI_NN_OP_MULTIPLY, std::move(a), std::move(b));
+  node->op_predicate_ = [](const std::shared_ptr<vx::Operation>& op) {
+    return op->impl()->node()->nn_param.multiply.scale == 1.0f;
+  };
+  return node;
+}
+
+Pattern Sub(Pattern a, Pattern b) {
+  return Op(VSI_NN_OP_SUBTRACT, {std::move(a), std::move(b)});
+}
+
+Pattern Div(Pattern a, Pattern b) {
+  return Op(VSI_NN_OP_DIVIDE, {std::move(a), std::move(b)},
+            [](const std::shared_ptr<vx::Operation>& op) {
+              return op->impl()->node()->nn_param.divide.scale == 1.0f;
+            });
+}
+
+Pattern Square(Pattern x) {
+  return AnyOf({Op(VSI_NN_OP_SQUARE, {x}), Mul(x, x),
+                Op(VSI_NN_OP_POW, {x, Scalar(2.0f)})});
+}
+
+Pattern Reduce(int32_t reduce_type, Pattern x) {
+  return Op(VSI_NN_OP_REDUCE, {std::move(x)},
+            [reduce_type](const std::shared_ptr<vx::Operation>& op) {
+              auto& param = op->impl()->node()->nn_param.reduce;
+              return param.type == reduce_type && param.axis_num == 1 &&
+                     param.keep_dim;
+            });
+}
+
+float ScalarValue(const std::shared_ptr<vx::Tensor>& tensor) {
+  float* data = tensor->ConvertTensorToFloat32Data();
+  if (!data) {
+    return NAN;
+  }
+  float value = data[0];
+  vsi_nn_Free(data);
+  return value;
+}
+
+std::shared_ptr<vx::Tensor> Match::tensor(const Pattern& node) const {
+  auto it = tensors_.find(node.get());
+  return it == tensors_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<vx::Operation> Match::op(const Pattern& node) const {
+  auto it = ops_.find(node.get());
+  return it == ops_.end() ? nullptr : it->second;
+}
+
+std::vector<std::shared_ptr<vx::Operation>> Match::ops() const {
+  std::vector<std::shared_ptr<vx::Operation>> ops;
+  for (const auto& bound : ops_) {
+    if (std::find(ops.begin(), ops.end(), bound.second) == ops.end()) {
+      ops.push_back(bound.second);
+    }
+  }
+  return ops;
+}
+
+Matcher::Matcher(const std::shared_ptr<vx::Graph>& graph) : graph_(graph) {}
+
+bool Matcher::MatchAt(const Pattern& pattern,
+                      const std::shared_ptr<vx::Operation>& op,
+                      Match& match) const {
+  auto outputs = op->impl()->OutputsTensor();
+  Match trial;
+  if (outputs.size() != 1 || !MatchTensor(pattern, outputs[0], trial)) {
+    return false;
+  }
+
+  auto ops = trial.ops();
+  std::set<std::shared_ptr<vx::Operation>> matched(ops.begin(), ops.end());
+  for (const auto& inner : ops) {
+    if (inner == op) continue;
+    // Results of the replaced ops must not be needed elsewhere
+    for (const auto& out : inner->impl()->OutputsTensor()) {
+      if (IsGraphOutput(out)) return false;
+      for (const auto& consumer : graph_->GetConsumersOp(out)) {
+        if (matched.count(consumer) == 0) return false;
+      }
+    }
+  }
+  // Inputs of the match must come from outside of it
+  for (const auto& bound : trial.tensors_) {
+    if (bound.first->type_ == PatternNode::Type::kInput &&
+        matched.count(graph_->GetProducerOp(bound.second))) {
+      return false;
+    }
+  }
+  match = std::move(trial);
+  return true;
+}
+
+bool Matcher::MatchTensor(const Pattern& node,
+                          const std::shared_ptr<vx::Tensor>& t,
+                          Match& match) const {
+  auto bound = match.tensors_.find(node.get());
+  if (bound != match.tensors_.end()) {
+    return bound->second == t;
+  }
+
+  switch (node->type_) {
+    case PatternNode::Type::kInput:
+      break;
+    case PatternNode::Type::kConst:
+      if (!t->IsConstTensor() ||
+          (node->tensor_predicate_ && !node->tensor_predicate_(t))) {
+        return false;
+      }
+      break;
+    case PatternNode::Type::kOp: {
+      auto producer = graph_->GetProducerOp(t);
+      if (!producer || producer->impl()->kind_ != node->kind_ ||
+          producer->impl()->OutputsTensor().size() != 1 ||
+          (node->op_predicate_ && !node->op_predicate_(producer)) ||
+          !MatchInputs(node, producer->impl()->InputsTensor(), match)) {
+        return false;
+      }
+      match.ops_[node.get()] = producer;
+      break;
+    }
+    case PatternNode::Type::kAnyOf: {
+      bool matched = false;
+      for (const auto& alternative : node->inputs_) {
+        Match trial = match;
+        if (MatchTensor(alternative, t, trial)) {
+          match = std::move(trial);
+          matched = true;
+          break;
+        }
+      }
+      if (!matched) return false;
+      break;
+    }
+  }
+  match.tensors_[node.get()] = t;
+  return true;
+}
+
+bool Matcher::MatchInputs(
+    const Pattern& node, const std::vector<std::shared_ptr<vx::Tensor>>& inputs,
+    Match& match) const {
+  if (inputs.size() != node->inputs_.size()) {
+    return false;
+  }
+  if (node->commutative_ && inputs.size() == 2) {
+    for (uint32_t first = 0; first < 2; ++first) {
+      Match trial = match;
+      if (MatchTensor(node->inputs_[0], inputs[first], trial) &&
+          MatchTensor(node->inputs_[1], inputs[1 - first], trial)) {
+        match = std::move(trial);
+        return true;
+      }
+    }
+    return false;
+  }
+  for (uint32_t i = 0; i < inputs.size(); ++i) {
+    if (!MatchTensor(node->inputs_[i], inputs[i], match)) return false;
+  }
+  return true;
+}
+
+bool Matcher::IsGraphOutput(const std::shared_ptr<vx::Tensor>& t) const {
+  const auto& outputs = graph_->OutputsTensor();
+  return std::find(outputs.begin(), outputs.end(), t) != outputs.end();
+}
+
+}  // namespace fusion
+}  // namespace transform
+}  // namespace tim
@@ -0,0 +1,129 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_TRANSFORM_PATTERN_H_
+#define TIM_TRANSFORM_PATTERN_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+#include "tim/vx/tensor.h"
+
+namespace tim {
+namespace transform {
+namespace fusion {
+
+using OpPredicate = std::function<bool(const std::shared_ptr<vx::Operation>&)>;
+using TensorPredicate = std::function<bool(const std::shared_ptr<vx::Tensor>&)>;
+
+/// Node of a subgraph pattern. An op node matches the producer of a tensor
+/// and its inputs, leaf nodes match the tensor itself. A node used at several
+/// places of a pattern must match the same tensor everywhere.
+class PatternNode {
+ public:
+  enum class Type { kInput, kConst, kOp, kAnyOf };
+
+  explicit PatternNode(Type type) : type_(type) {}
+
+  Type type_;
+  // VSI_NN_OP_* of an op node
+  int32_t kind_{-1};
+  // Two input op node matching its inputs in either order
+  bool commutative_{false};
+  std::vector<std::shared_ptr<PatternNode>> inputs_;
+  OpPredicate op_predicate_;
+  TensorPredicate tensor_predicate_;
+};
+using Pattern = std::shared_ptr<PatternNode>;
+
+/// Any tensor
+Pattern Input();
+/// Any constant tensor satisfying `predicate`
+Pattern Const(TensorPredicate predicate = nullptr);
+/// Single element constant equal to `value` within `tolerance`
+Pattern Scalar(float value, float tolerance = 1e-4f);
+/// Output of an op of `kind` whose inputs match `inputs`
+Pattern Op(int32_t kind, std::vector<Pattern> inputs,
+           OpPredicate predicate = nullptr);
+/// Op of `kind` with two inputs matching `a` and `b` in either order
+Pattern CommutativeOp(int32_t kind, Pattern a, Pattern b);
+/// First of `alternatives` which matches
+Pattern AnyOf(std::vector<Pattern> alternatives);
+
+Pattern Add(Pattern a, Pattern b);
+Pattern Sub(Pattern a, Pattern b);
+/// Multiply and Div with a scale of 1
+Pattern Mul(Pattern a, Pattern b);
+Pattern Div(Pattern a, Pattern b);
+/// square(x), x * x or x ^ 2
+Pattern Square(Pattern x);
+/// Reduce of `reduce_type` with a single axis keeping dims
+Pattern Reduce(int32_t reduce_type, Pattern x);
+
+/// Value of a single element constant
+float ScalarValue(const std::shared_ptr<vx::Tensor>& tensor);
+
+/// Tensors and ops bound to the nodes of a matched pattern
+class Match {
+ public:
+  std::shared_ptr<vx::Tensor> tensor(const Pattern& node) const;
+  std::shared_ptr<vx::Operation> op(const Pattern& node) const;
+  /// Every op of the match
+  std::vector<std::shared_ptr<vx::Operation>> ops() const;
+
+ private:
+  friend class Matcher;
+  std::map<const PatternNode*, std::shared_ptr<vx::Tensor>> tensors_;
+  std::map<const PatternNode*, std::shared_ptr<vx::Operation>> ops_;
+};
+
+/// Matches patterns against the producer and consumer maps of a graph
+class Matcher {
+ public:
+  explicit Matcher(const std::shared_ptr<vx::Graph>& graph);
+
+  /// Match `pattern` with its root at `op`. Only the root's output may be
+  /// used outside of the match, so the matched ops can be replaced.
+  bool MatchAt(const Pattern& pattern, const std::shared_ptr<vx::Operation>& op,
+               Match& match) const;
+
+ private:
+  bool MatchTensor(const Pattern& node, const std::shared_ptr<vx::Tensor>& t,
+                   Match& match) const;
+  bool MatchInputs(const Pattern& node,
+                   const std::vector<std::shared_ptr<vx::Tensor>>& inputs,
+                   Match& match) const;
+  bool IsGraphOutput(const std::shared_ptr<vx::Tensor>& t) const;
+
+  std::shared_ptr<vx::Graph> graph_;
+};
+
+}  // namespace fusion
+}  // namespace transform
+}  // namespace tim
+
+#endif
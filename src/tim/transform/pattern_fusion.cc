@@ -0,0 +1,132 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/pattern_fusion.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "graph_rebuilder.h"
+#include "pattern.h"
+#include "fusion/fusion_rule.h"
+#include "fusion/gelu_fusion.h"
+#include "fusion/hardswish_fusion.h"
+#include "fusion/layernorm_fusion.h"
+#include "fusion/rmsnorm_fusion.h"
+#include "fusion/softmax_fusion.h"
+#include "fusion/swish_fusion.h"
+
+namespace tim {
+namespace transform {
+namespace {
+
+using FusionRules =
+    std::vector<std::pair<std::string, std::shared_ptr<fusion::FusionRule>>>;
+
+#define REGISTER_FUSION(name) \
+  rules.emplace_back(#name, std::make_shared<fusion::name##Fusion>())
+
+// Rules registered first take the ops when matches overlap
+FusionRules CreateFusionRules() {
+  FusionRules rules;
+  REGISTER_FUSION(LayerNorm);
+#if defined(VSI_FEAT_OP_RMSNORM) && defined(VX_RMS_NORM_VX_SUPPORT) && \
+    VX_RMS_NORM_VX_SUPPORT
+  REGISTER_FUSION(RMSNorm);
+#endif
+  REGISTER_FUSION(Gelu);
+  REGISTER_FUSION(HardSwish);
+  REGISTER_FUSION(Swish);
+  REGISTER_FUSION(Softmax);
+  return rules;
+}
+
+#undef REGISTER_FUSION
+
+struct FusedSubgraph {
+  uint32_t rule;
+  fusion::Match match;
+};
+
+}  // namespace
+
+std::pair<std::shared_ptr<vx::Graph>,
+          std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+PatternFusion(const std::shared_ptr<vx::Graph>& src_graph,
+              std::shared_ptr<vx::Context>& ctx,
+              std::map<std::string, uint32_t>* fused_count) {
+  std::vector<std::shared_ptr<vx::Operation>> sorted;
+  if (!SortOps(src_graph, sorted)) {
+    VSILOGE("Graph has a cycle, patterns are not fused.");
+    return std::make_pair(nullptr, std::map<std::shared_ptr<vx::Tensor>,
+                                            std::shared_ptr<vx::Tensor>>());
+  }
+
+  auto rules = CreateFusionRules();
+  fusion::Matcher matcher(src_graph);
+  std::map<std::shared_ptr<vx::Operation>, FusedSubgraph> roots;
+  std::set<std::shared_ptr<vx::Operation>> fused_ops;
+  // Visit consumers first so a pattern is matched from its last op and not
+  // from a smaller pattern inside of it
+  for (auto op = sorted.rbegin(); op != sorted.rend(); ++op) {
+    if (fused_ops.count(*op)) continue;
+    bool matched = false;
+    for (uint32_t i = 0; i < rules.size() && !matched; ++i) {
+      for (const auto& pattern : rules[i].second->Patterns()) {
+        fusion::Match match;
+        if (!matcher.MatchAt(pattern, *op, match) ||
+            !rules[i].second->Accept(match)) {
+          continue;
+        }
+        auto ops = match.ops();
+        if (std::any_of(ops.begin(), ops.end(),
+                        [&fused_ops](const std::shared_ptr<vx::Operation>& o) {
+                          return fused_ops.count(o) != 0;
+                        })) {
+          continue;
+        }
+        fused_ops.insert(ops.begin(), ops.end());
+        roots[*op] = FusedSubgraph{i, std::move(match)};
+        matched = true;
+        break;
+      }
+    }
+  }
+
+  GraphRebuilder rebuilder(src_graph, ctx);
+  for (const auto& op : sorted) {
+    auto root = roots.find(op);
+    if (root != roots.end()) {
+      const auto& rule = rules[root->second.rule];
+      rule.second->Rewrite(root->second.match, op, rebuilder);
+      if (fused_count) ++(*fused_count)[rule.first];
+    } else if (fused_ops.count(op) == 0) {
+      rebuilder.Clone(op);
+    }
+  }
+  return std::make_pair(rebuilder.graph(), rebuilder.io_map());
+}
+
+}  // namespace transform
+}  // namespace tim
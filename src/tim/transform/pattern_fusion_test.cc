@@ -0,0 +1,224 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/pattern_fusion.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+namespace {
+
+class PatternFusionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ctx_ = tim::vx::Context::Create();
+    graph_ = ctx_->CreateGraph();
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape_,
+                                   tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape_,
+                                    tim::vx::TensorAttribute::OUTPUT);
+    input_ = graph_->CreateTensor(input_spec);
+    output_ = graph_->CreateTensor(output_spec);
+  }
+
+  std::shared_ptr<tim::vx::Tensor> Transient(
+      const tim::vx::ShapeType& shape = {}) {
+    tim::vx::TensorSpec spec(tim::vx::DataType::FLOAT32,
+                             shape.empty() ? shape_ : shape,
+                             tim::vx::TensorAttribute::TRANSIENT);
+    return graph_->CreateTensor(spec);
+  }
+
+  std::shared_ptr<tim::vx::Tensor> Scalar(float value) {
+    tim::vx::TensorSpec spec(tim::vx::DataType::FLOAT32, {1},
+                             tim::vx::TensorAttribute::CONSTANT);
+    return graph_->CreateTensor(spec, &value);
+  }
+
+  template <typename OpType, typename... Params>
+  std::shared_ptr<tim::vx::Tensor> Apply(
+      const std::vector<std::shared_ptr<tim::vx::Tensor>>& inputs,
+      std::shared_ptr<tim::vx::Tensor> output, Params... params) {
+    graph_->CreateOperation<OpType>(params...)
+        ->BindInputs(inputs)
+        .BindOutput(output);
+    return output;
+  }
+
+  // Fuse the graph and check it computes the same as the decomposed one
+  // with `expected_ops` ops left
+  void ExpectFused(const std::string& rule, uint32_t expected_ops) {
+    std::map<std::string, uint32_t> fused_count;
+    auto fused = tim::transform::PatternFusion(graph_, ctx_, &fused_count);
+    ASSERT_NE(fused.first, nullptr);
+    EXPECT_EQ(fused_count[rule], 1u);
+    EXPECT_EQ(fused.first->OpVector().size(), expected_ops);
+
+    auto golden = RunGraph(graph_, input_, output_, input_data_);
+    auto result = RunGraph(fused.first, fused.second[input_],
+                           fused.second[output_], input_data_);
+    EXPECT_TRUE(ArraysMatch(golden, result, 1e-3f));
+  }
+
+  tim::vx::ShapeType shape_{8, 2};
+  std::vector<float> input_data_{-4.0f, -3.0f, -2.5f, -1.0f, -0.5f, 0.0f,
+                                 0.25f, 0.5f,  1.0f,  1.5f,  2.0f,  2.5f,
+                                 3.0f,  3.5f,  4.0f,  6.0f};
+  std::shared_ptr<tim::vx::Context> ctx_;
+  std::shared_ptr<tim::vx::Graph> graph_;
+  std::shared_ptr<tim::vx::Tensor> input_;
+  std::shared_ptr<tim::vx::Tensor> output_;
+};
+
+// Both axes have the same size
+class PatternFusionSquareTest : public PatternFusionTest {
+ protected:
+  PatternFusionSquareTest() { shape_ = {4, 4}; }
+};
+
+}  // namespace
+
+TEST_F(PatternFusionTest, gelu_erf) {
+  namespace ops = tim::vx::ops;
+  // x * (1 + erf(x / sqrt(2))) * 0.5
+  auto t = Apply<ops::Div>({input_, Scalar(std::sqrt(2.0f))}, Transient());
+  t = Apply<ops::Erf>({t}, Transient());
+  t = Apply<ops::Add>({t, Scalar(1.0f)}, Transient());
+  t = Apply<ops::Multiply>({input_, t}, Transient());
+  Apply<ops::Multiply>({t, Scalar(0.5f)}, output_);
+  ExpectFused("Gelu", 1);
+}
+
+TEST_F(PatternFusionTest, gelu_tanh) {
+  namespace ops = tim::vx::ops;
+  // (x * 0.5) * (1 + tanh(0.7978846 * (x + 0.044715 * x^3)))
+  auto t = Apply<ops::Pow>({input_, Scalar(3.0f)}, Transient());
+  t = Apply<ops::Multiply>({Scalar(0.044715f), t}, Transient());
+  t = Apply<ops::Add>({input_, t}, Transient());
+  t = Apply<ops::Multiply>({t, Scalar(0.7978846f)}, Transient());
+  t = Apply<ops::Tanh>({t}, Transient());
+  t = Apply<ops::Add>({t, Scalar(1.0f)}, Transient());
+  auto half = Apply<ops::Multiply>({input_, Scalar(0.5f)}, Transient());
+  Apply<ops::Multiply>({half, t}, output_);
+  ExpectFused("Gelu", 1);
+}
+
+TEST_F(PatternFusionTest, silu) {
+  namespace ops = tim::vx::ops;
+  auto t = Apply<ops::Sigmoid>({input_}, Transient());
+  Apply<ops::Multiply>({t, input_}, output_);
+  ExpectFused("Swish", 1);
+}
+
+TEST_F(PatternFusionTest, hardswish) {
+  namespace ops = tim::vx::ops;
+  // x * relu6(x + 3) / 6
+  auto t = Apply<ops::Add>({input_, Scalar(3.0f)}, Transient());
+  t = Apply<ops::Relu6>({t}, Transient());
+  t = Apply<ops::Multiply>({input_, t}, Transient());
+  Apply<ops::Div>({t, Scalar(6.0f)}, output_);
+  ExpectFused("HardSwish", 1);
+}
+
+TEST_F(PatternFusionTest, layernorm) {
+  namespace ops = tim::vx::ops;
+  tim::vx::ShapeType reduced({1, shape_[1]});
+  std::vector<float> gamma_data = {0.5f, 1.0f, 1.5f, 2.0f,
+                                   2.5f, 3.0f, 3.5f, 4.0f};
+  std::vector<float> beta_data = {0.0f, 0.1f, 0.2f, 0.3f,
+                                  0.4f, 0.5f, 0.6f, 0.7f};
+  tim::vx::TensorSpec param_spec(tim::vx::DataType::FLOAT32, {shape_[0]},
+                                 tim::vx::TensorAttribute::CONSTANT);
+  auto gamma = graph_->CreateTensor(param_spec, gamma_data.data());
+  auto beta = graph_->CreateTensor(param_spec, beta_data.data());
+
+  // (x - mean) / sqrt(mean((x - mean)^2) + eps) * gamma + beta
+  auto mean = Apply<ops::ReduceMean>({input_}, Transient(reduced),
+                                     std::vector<int32_t>({0}), true);
+  auto d = Apply<ops::Sub>({input_, mean}, Transient());
+  auto t = Apply<ops::Pow>({d, Scalar(2.0f)}, Transient());
+  t = Apply<ops::ReduceMean>({t}, Transient(reduced),
+                             std::vector<int32_t>({0}), true);
+  t = Apply<ops::Add>({t, Scalar(1e-5f)}, Transient(reduced));
+  t = Apply<ops::Sqrt>({t}, Transient(reduced));
+  t = Apply<ops::Div>({d, t}, Transient());
+  t = Apply<ops::Multiply>({t, gamma}, Transient());
+  Apply<ops::Add>({t, beta}, output_);
+  ExpectFused("LayerNorm", 1);
+}
+
+TEST_F(PatternFusionSquareTest, layernorm_param_on_other_axis) {
+  namespace ops = tim::vx::ops;
+  // gamma has as many values as the normalized axis 0 but scales along
+  // axis 1, so it stays a Multiply after the fused LayerNorm
+  tim::vx::ShapeType reduced({1, shape_[1]});
+  std::vector<float> gamma_data = {0.5f, 1.0f, 1.5f, 2.0f};
+  tim::vx::TensorSpec gamma_spec(tim::vx::DataType::FLOAT32, reduced,
+                                 tim::vx::TensorAttribute::CONSTANT);
+  auto gamma = graph_->CreateTensor(gamma_spec, gamma_data.data());
+
+  auto mean = Apply<ops::ReduceMean>({input_}, Transient(reduced),
+                                     std::vector<int32_t>({0}), true);
+  auto d = Apply<ops::Sub>({input_, mean}, Transient());
+  auto t = Apply<ops::Pow>({d, Scalar(2.0f)}, Transient());
+  t = Apply<ops::ReduceMean>({t}, Transient(reduced),
+                             std::vector<int32_t>({0}), true);
+  t = Apply<ops::Add>({t, Scalar(1e-5f)}, Transient(reduced));
+  t = Apply<ops::Sqrt>({t}, Transient(reduced));
+  t = Apply<ops::Div>({d, t}, Transient());
+  Apply<ops::Multiply>({t, gamma}, output_);
+  ExpectFused("LayerNorm", 2);
+}
+
+TEST_F(PatternFusionTest, softmax) {
+  namespace ops = tim::vx::ops;
+  tim::vx::ShapeType reduced({1, shape_[1]});
+  // e = exp(x - max(x)), e / sum(e)
+  auto max = Apply<ops::ReduceMax>({input_}, Transient(reduced),
+                                   std::vector<int32_t>({0}), true);
+  auto t = Apply<ops::Sub>({input_, max}, Transient());
+  auto e = Apply<ops::Exp>({t}, Transient());
+  auto sum = Apply<ops::ReduceSum>({e}, Transient(reduced),
+                                   std::vector<int32_t>({0}), true);
+  Apply<ops::Div>({e, sum}, output_);
+  ExpectFused("Softmax", 1);
+}
+
+TEST_F(PatternFusionTest, keep_shared_intermediate) {
+  namespace ops = tim::vx::ops;
+  // The sigmoid is read outside of the SiLU pattern, so nothing is fused
+  auto sigmoid = Apply<ops::Sigmoid>({input_}, Transient());
+  auto t = Apply<ops::Multiply>({input_, sigmoid}, Transient());
+  Apply<ops::Add>({t, sigmoid}, output_);
+
+  std::map<std::string, uint32_t> fused_count;
+  auto fused = tim::transform::PatternFusion(graph_, ctx_, &fused_count);
+  ASSERT_NE(fused.first, nullptr);
+  EXPECT_TRUE(fused_count.empty());
+  EXPECT_EQ(fused.first->OpVector().size(), 3u);
+}
@@ -0,0 +1,282 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/transform/layout_inference.h"
+#include "permute_vector.h"
+#include "op_impl.h"
+#include "test_utils.h"
+
+#include <cmath>
+#include <functional>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using BindOp = std::function<void(const std::shared_ptr<tim::vx::Graph>&,
+                                  const std::shared_ptr<tim::vx::Tensor>&,
+                                  const std::shared_ptr<tim::vx::Tensor>&)>;
+
+// CWHN conv -> op -> CWHN conv with identity kernels: the op takes the layout
+// of the first conv, so only the graph input and output need a transpose.
+void ExpectLayoutKept(const BindOp& bind, const std::vector<float>& in_data,
+                      const std::vector<float>& golden,
+                      float tolerance = 1e-5f) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType io_shape({2, 2, 1, 1});       // CWHN
+  tim::vx::ShapeType kernel_shape({2, 1, 1, 2});   // IcWHOc
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec kernel_spec(tim::vx::DataType::FLOAT32, kernel_shape,
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+
+  std::vector<float> identity = {1, 0, 0, 1};
+  auto input = graph->CreateTensor(input_spec);
+  auto kernel0 = graph->CreateTensor(kernel_spec, identity.data());
+  auto kernel1 = graph->CreateTensor(kernel_spec, identity.data());
+  auto conv0_out = graph->CreateTensor(transient_spec);
+  auto op_out = graph->CreateTensor(transient_spec);
+  auto output = graph->CreateTensor(output_spec);
+
+  std::array<uint32_t, 2> stride({1, 1});
+  std::array<uint32_t, 2> dilation({1, 1});
+  auto conv0 = graph->CreateOperation<tim::vx::ops::Conv2d>(
+      tim::vx::PadType::VALID, stride, dilation, 0, tim::vx::DataLayout::CWHN,
+      tim::vx::DataLayout::IcWHOc);
+  (*conv0).BindInputs({input, kernel0}).BindOutputs({conv0_out});
+  bind(graph, conv0_out, op_out);
+  auto conv1 = graph->CreateOperation<tim::vx::ops::Conv2d>(
+      tim::vx::PadType::VALID, stride, dilation, 0, tim::vx::DataLayout::CWHN,
+      tim::vx::DataLayout::IcWHOc);
+  (*conv1).BindInputs({op_out, kernel1}).BindOutputs({output});
+
+  auto transform = tim::transform::LayoutInference(graph, ctx);
+  auto infer_graph = transform.first;
+  uint32_t transposes = 0;
+  for (const auto& op : infer_graph->OpVector()) {
+    if (op->impl()->kind_ == VSI_NN_OP_PERMUTE) ++transposes;
+  }
+  EXPECT_EQ(transposes, 2u);
+
+  auto graph_io_map = transform.second;
+  auto infer_input = graph_io_map[input];
+  auto infer_output = graph_io_map[output];
+  EXPECT_TRUE(infer_graph->Compile());
+  EXPECT_TRUE(infer_input->CopyDataToTensor(in_data.data(),
+                                            in_data.size() * sizeof(float)));
+  EXPECT_TRUE(infer_graph->Run());
+
+  std::vector<float> out_data(golden.size());
+  EXPECT_TRUE(infer_output->CopyDataFromTensor(out_data.data()));
+  EXPECT_TRUE(ArraysMatch(golden, out_data, tolerance));
+}
+
+template <typename OpType, typename... Params>
+BindOp BindUnary(Params... parameters) {
+  return [parameters...](const std::shared_ptr<tim::vx::Graph>& graph,
+                         const std::shared_ptr<tim::vx::Tensor>& input,
+                         const std::shared_ptr<tim::vx::Tensor>& output) {
+    graph->CreateOperation<OpType>(parameters...)
+        ->BindInput(input)
+        .BindOutput(output);
+  };
+}
+
+// The right hand side is a constant in the layout of the source graph
+template <typename OpType>
+BindOp BindBinary(std::vector<float> rhs) {
+  return [rhs](const std::shared_ptr<tim::vx::Graph>& graph,
+               const std::shared_ptr<tim::vx::Tensor>& input,
+               const std::shared_ptr<tim::vx::Tensor>& output) {
+    tim::vx::TensorSpec rhs_spec(tim::vx::DataType::FLOAT32,
+                                 input->GetShape(),
+                                 tim::vx::TensorAttribute::CONSTANT);
+    auto rhs_t = graph->CreateTensor(rhs_spec, rhs.data());
+    graph->CreateOperation<OpType>()
+        ->BindInputs({input, rhs_t})
+        .BindOutput(output);
+  };
+}
+
+// Relational ops produce BOOL8, a cast brings it back to float for the conv
+template <typename OpType>
+BindOp BindRelational(std::vector<float> rhs) {
+  return [rhs](const std::shared_ptr<tim::vx::Graph>& graph,
+               const std::shared_ptr<tim::vx::Tensor>& input,
+               const std::shared_ptr<tim::vx::Tensor>& output) {
+    tim::vx::TensorSpec bool_spec(tim::vx::DataType::BOOL8, input->GetShape(),
+                                  tim::vx::TensorAttribute::TRANSIENT);
+    auto compared = graph->CreateTensor(bool_spec);
+    BindBinary<OpType>(rhs)(graph, input, compared);
+    graph->CreateOperation<tim::vx::ops::Cast>()
+        ->BindInput(compared)
+        .BindOutput(output);
+  };
+}
+
+}  // namespace
+
+TEST(Floor, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Floor>(), {-1.5, -0.5, 0.5, 2.5},
+                   {-2, -1, 0, 2});
+}
+
+TEST(Ceil, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Ceil>(), {-1.5, -0.5, 0.5, 2.5},
+                   {-1, 0, 1, 3});
+}
+
+TEST(Round, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Round>(), {-1.4, -0.6, 0.4, 2.6},
+                   {-1, -1, 0, 3});
+}
+
+// float -> int32 -> float, both casts keep the layout
+TEST(Cast, between_cwhn_conv2d) {
+  auto bind = [](const std::shared_ptr<tim::vx::Graph>& graph,
+                 const std::shared_ptr<tim::vx::Tensor>& input,
+                 const std::shared_ptr<tim::vx::Tensor>& output) {
+    tim::vx::TensorSpec int_spec(tim::vx::DataType::INT32, input->GetShape(),
+                                 tim::vx::TensorAttribute::TRANSIENT);
+    auto as_int = graph->CreateTensor(int_spec);
+    BindUnary<tim::vx::ops::Cast>()(graph, input, as_int);
+    BindUnary<tim::vx::ops::Cast>()(graph, as_int, output);
+  };
+  ExpectLayoutKept(bind, {1, 2, 3, 4}, {1, 2, 3, 4});
+}
+
+TEST(Rcp, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Rcp>(), {1, 2, 4, -0.5},
+                   {1, 0.5, 0.25, -2}, 1e-3f);
+}
+
+TEST(Sign, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Sign>(), {-2, 0, 3, -0.5},
+                   {-1, 0, 1, -1});
+}
+
+TEST(SoftSign, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindUnary<tim::vx::ops::SoftSign>(), {-1, 0, 1, 3},
+                   {-0.5, 0, 0.5, 0.75}, 1e-3f);
+}
+
+TEST(Linear, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Linear>(2.0f, 1.0f), {-1, 0, 1, 3},
+                   {-1, 1, 3, 7}, 1e-3f);
+}
+
+TEST(Gelu, between_cwhn_conv2d) {
+  std::vector<float> in_data = {-2, -0.5, 0.5, 2};
+  std::vector<float> golden;
+  for (float x : in_data) {
+    float inner = std::sqrt(2.0f / 3.14159265f) * (x + 0.044715f * x * x * x);
+    golden.push_back(0.5f * x * (1.0f + std::tanh(inner)));
+  }
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Gelu>(true), in_data, golden,
+                   1e-3f);
+}
+
+#ifdef _VSI_NN_OP_SELU_H
+TEST(Selu, between_cwhn_conv2d) {
+  const float alpha = 1.67326f;
+  const float gamma = 1.0507f;
+  std::vector<float> in_data = {-2, -0.5, 0.5, 2};
+  std::vector<float> golden;
+  for (float x : in_data) {
+    golden.push_back(gamma * (x > 0 ? x : alpha * (std::exp(x) - 1.0f)));
+  }
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Selu>(alpha, gamma), in_data,
+                   golden, 1e-3f);
+}
+#endif
+
+#ifdef _VSI_NN_OP_CELU_H
+TEST(Celu, between_cwhn_conv2d) {
+  const float alpha = 2.0f;
+  std::vector<float> in_data = {-2, -0.5, 0.5, 2};
+  std::vector<float> golden;
+  for (float x : in_data) {
+    golden.push_back(x > 0 ? x : alpha * (std::exp(x / alpha) - 1.0f));
+  }
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Celu>(alpha), in_data, golden,
+                   1e-3f);
+}
+#endif
+
+TEST(Clip, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Clip>(-1.0f, 2.0f),
+                   {-3, -0.5, 1.5, 4}, {-1, -0.5, 1.5, 2});
+}
+
+TEST(Erf, between_cwhn_conv2d) {
+  std::vector<float> in_data = {-2, -0.5, 0.5, 2};
+  std::vector<float> golden;
+  for (float x : in_data) {
+    golden.push_back(std::erf(x));
+  }
+  ExpectLayoutKept(BindUnary<tim::vx::ops::Erf>(), in_data, golden, 1e-3f);
+}
+
+TEST(FloorDiv, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindBinary<tim::vx::ops::FloorDiv>({2, 2, 4, 2}),
+                   {-3, -1, 6, 5}, {-2, -1, 1, 2});
+}
+
+TEST(Greater, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindRelational<tim::vx::ops::Greater>({0, 1, 1, 3}),
+                   {-1, 2, 1, 3}, {0, 1, 0, 0});
+}
+
+TEST(GreaterOrEqual, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindRelational<tim::vx::ops::GreaterOrEqual>({0, 1, 1, 3}),
+                   {-1, 2, 1, 3}, {0, 1, 1, 1});
+}
+
+TEST(Less, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindRelational<tim::vx::ops::Less>({0, 1, 1, 3}),
+                   {-1, 2, 1, 3}, {1, 0, 0, 0});
+}
+
+TEST(LessOrEqual, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindRelational<tim::vx::ops::LessOrEqual>({0, 1, 1, 3}),
+                   {-1, 2, 1, 3}, {1, 0, 1, 1});
+}
+
+TEST(NotEqual, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindRelational<tim::vx::ops::NotEqual>({0, 1, 1, 3}),
+                   {-1, 2, 1, 3}, {1, 1, 0, 0});
+}
+
+TEST(Equal, between_cwhn_conv2d) {
+  ExpectLayoutKept(BindRelational<tim::vx::ops::Equal>({0, 1, 1, 3}),
+                   {-1, 2, 1, 3}, {0, 0, 1, 1});
+}
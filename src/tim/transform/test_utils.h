@@ -0,0 +1,36 @@
+#ifndef TIM_TRANSFORM_TEST_UTILS_H_
+#define TIM_TRANSFORM_TEST_UTILS_H_
+
+#include <memory>
+#include <vector>
+#include "tim/vx/graph.h"
+#include "tim/vx/tensor.h"
+#include "../vx/test_utils.h"
+
+// Compile graph, copy input_data into input, run it once and read
+// output_size elements back from output
+template <typename T>
+inline std::vector<T> RunGraph(std::shared_ptr<tim::vx::Graph>& graph,
+                               const std::shared_ptr<tim::vx::Tensor>& input,
+                               const std::shared_ptr<tim::vx::Tensor>& output,
+                               const std::vector<T>& input_data,
+                               size_t output_size) {
+  EXPECT_TRUE(graph->Compile());
+  EXPECT_TRUE(input->CopyDataToTensor(input_data.data(),
+                                      input_data.size() * sizeof(T)));
+  EXPECT_TRUE(graph->Run());
+  std::vector<T> out(output_size);
+  EXPECT_TRUE(output->CopyDataFromTensor(out.data()));
+  return out;
+}
+
+// Same as above for an output as large as the input
+template <typename T>
+inline std::vector<T> RunGraph(std::shared_ptr<tim::vx::Graph>& graph,
+                               const std::shared_ptr<tim::vx::Tensor>& input,
+                               const std::shared_ptr<tim::vx::Tensor>& output,
+                               const std::vector<T>& input_data) {
+  return RunGraph(graph, input, output, input_data, input_data.size());
+}
+
+#endif /* TIM_TRANSFORM_TEST_UTILS_H_ */
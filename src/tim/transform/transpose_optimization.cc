@@ -0,0 +1,347 @@
+/****************************************************************************
+ *
+ *    Copyright (c) 2020-2023 Vivante Corporation
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in
+ *    all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *    DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+#include "tim/transform/transpose_optimization.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "builtin_op_impl.h"
+#include "const_data.h"
+#include "graph_rebuilder.h"
+#include "permute_vector.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+#include "tim/vx/ops/transpose.h"
+
+namespace tim {
+namespace transform {
+namespace {
+
+// Ops computing every element on its own, they commute with any transpose
+bool IsLayoutAgnosticUnary(int32_t kind) {
+  switch (kind) {
+    case VSI_NN_OP_RELU:
+    case VSI_NN_OP_RELU1:
+    case VSI_NN_OP_RELU6:
+    case VSI_NN_OP_RELUN:
+    case VSI_NN_OP_LEAKY_RELU:
+    case VSI_NN_OP_SIGMOID:
+    case VSI_NN_OP_TANH:
+    case VSI_NN_OP_ABS:
+    case VSI_NN_OP_NEG:
+    case VSI_NN_OP_EXP:
+    case VSI_NN_OP_LOG:
+    case VSI_NN_OP_SQRT:
+    case VSI_NN_OP_RSQRT:
+    case VSI_NN_OP_SQUARE:
+    case VSI_NN_OP_SIN:
+    case VSI_NN_OP_COS:
+    case VSI_NN_OP_ELU:
+    case VSI_NN_OP_SELU:
+    case VSI_NN_OP_CELU:
+    case VSI_NN_OP_GELU:
+    case VSI_NN_OP_ERF:
+    case VSI_NN_OP_HARD_SIGMOID:
+    case VSI_NN_OP_SWISH:
+    case VSI_NN_OP_MISH:
+    case VSI_NN_OP_SOFTRELU:
+    case VSI_NN_OP_LINEAR:
+    case VSI_NN_OP_CLIP:
+    case VSI_NN_OP_ROUND:
+    case VSI_NN_OP_FLOOR:
+    case VSI_NN_OP_CEIL:
+    case VSI_NN_OP_DATACONVERT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Broadcast per dimension, they commute with a transpose applied to all inputs
+bool IsLayoutAgnosticBinary(int32_t kind) {
+  switch (kind) {
+    case VSI_NN_OP_ADD:
+    case VSI_NN_OP_SUBTRACT:
+    case VSI_NN_OP_MULTIPLY:
+    case VSI_NN_OP_DIVIDE:
+    case VSI_NN_OP_MAXIMUM:
+    case VSI_NN_OP_MINIMUM:
+    case VSI_NN_OP_POW:
+    case VSI_NN_OP_FLOORDIV:
+      return true;
+    default:
+      return false;
+  }
+}
+
+IPermuteVectorPtr MakePermuteVector(const std::vector<uint32_t>& perm) {
+  auto pv = MakeShared(perm.size());
+  for (uint32_t i = 0; i < perm.size(); ++i) {
+    pv->At(i) = perm[i];
+  }
+  return pv;
+}
+
+IPermuteVectorPtr TransposePerm(const std::shared_ptr<vx::Operation>& op) {
+  auto node = op->impl()->node();
+  return MakePermuteVector(std::vector<uint32_t>(
+      node->nn_param.permute.perm,
+      node->nn_param.permute.perm + node->nn_param.permute.dim_num));
+}
+
+bool IsIdentity(const IPermuteVectorPtr& pv) { return !pv || pv->IsAligned(); }
+
+bool SamePermute(const IPermuteVectorPtr& a, const IPermuteVectorPtr& b) {
+  return a->Rank() == b->Rank() && a->AsStdVec() == b->AsStdVec();
+}
+
+class TransposeOptimizer {
+ public:
+  TransposeOptimizer(const std::shared_ptr<vx::Graph>& src_graph,
+                     std::shared_ptr<vx::Context>& ctx)
+      : rebuilder_(src_graph, ctx) {}
+
+  bool Run();
+
+  GraphRebuilder& rebuilder() { return rebuilder_; }
+  uint32_t sunk_ops() const { return sunk_ops_; }
+
+ private:
+  bool HasSingleConsumer(const std::shared_ptr<vx::Tensor>& t,
+                         const std::shared_ptr<vx::Operation>& op) const;
+  IPermuteVectorPtr Pending(const std::shared_ptr<vx::Tensor>& t) const;
+  std::shared_ptr<vx::Tensor> Materialize(const std::shared_ptr<vx::Tensor>& t);
+  std::shared_ptr<vx::Tensor> CreateOutput(const std::shared_ptr<vx::Tensor>& t,
+                                           const IPermuteVectorPtr& pv);
+  void FoldTranspose(const std::shared_ptr<vx::Operation>& op);
+  bool TrySink(const std::shared_ptr<vx::Operation>& op);
+  void Emit(const std::shared_ptr<vx::Operation>& op);
+
+  // Source tensors map to tensors of the rebuilt graph stored transposed by
+  // pending_
+  GraphRebuilder rebuilder_;
+  // tensor_in_src -> transpose not applied to its mapped tensor yet
+  std::map<std::shared_ptr<vx::Tensor>, IPermuteVectorPtr> pending_;
+  // tensor_in_src -> mapped tensor with its pending transpose applied
+  std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>
+      materialized_;
+  uint32_t sunk_ops_{0};
+};
+
+bool TransposeOptimizer::HasSingleConsumer(
+    const std::shared_ptr<vx::Tensor>& t,
+    const std::shared_ptr<vx::Operation>& op) const {
+  if (rebuilder_.IsGraphOutput(t)) return false;
+  for (const auto& consumer : rebuilder_.src_graph()->GetConsumersOp(t)) {
+    if (consumer != op) return false;
+  }
+  return true;
+}
+
+IPermuteVectorPtr TransposeOptimizer::Pending(
+    const std::shared_ptr<vx::Tensor>& t) const {
+  auto it = pending_.find(t);
+  return it == pending_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<vx::Tensor> TransposeOptimizer::CreateOutput(
+    const std::shared_ptr<vx::Tensor>& t, const IPermuteVectorPtr& pv) {
+  if (IsIdentity(pv)) {
+    return rebuilder_.MapOutput(t);
+  }
+  // When the only consumer transposes `t` back into a graph output, write
+  // that output directly and let the transpose fold away
+  auto consumers = rebuilder_.src_graph()->GetConsumersOp(t);
+  if (consumers.size() == 1 && !rebuilder_.IsGraphOutput(t) &&
+      consumers[0]->impl()->kind_ == VSI_NN_OP_PERMUTE) {
+    auto landed =
+        rebuilder_.GraphOutput(consumers[0]->impl()->OutputsTensor()[0]);
+    auto q = TransposePerm(consumers[0]);
+    if (landed && q->Rank() == pv->Rank() && pv->Add(q)->IsAligned()) {
+      return landed;
+    }
+  }
+  // Stored as `t` before applying `pv`
+  auto spec = t->GetSpec().AsTransientSpec();
+  if (spec.shape_.size() == pv->Rank()) {
+    vx::ShapeType shape(spec.shape_.size());
+    for (uint32_t i = 0; i < pv->Rank(); ++i) {
+      shape[pv->At(i)] = spec.shape_[i];
+    }
+    spec.SetShape(shape);
+  }
+  return rebuilder_.graph()->CreateTensor(spec);
+}
+
+std::shared_ptr<vx::Tensor> TransposeOptimizer::Materialize(
+    const std::shared_ptr<vx::Tensor>& t) {
+  auto cached = materialized_.find(t);
+  if (cached != materialized_.end()) {
+    return cached->second;
+  }
+  auto mapped = rebuilder_.Mapped(t);
+  auto pv = Pending(t);
+  auto output = rebuilder_.GraphOutput(t);
+  bool to_output = output && output != mapped;
+  if (IsIdentity(pv) && !to_output) {
+    return mapped;
+  }
+  // A graph output aliasing another tensor still needs an op writing it
+  auto target = to_output ? output
+                          : rebuilder_.graph()->CreateTensor(
+                                t->GetSpec().AsTransientSpec());
+  auto perm =
+      pv ? pv->AsStdVec() : MakeShared(t->GetShape().size())->AsStdVec();
+  rebuilder_.graph()
+      ->CreateOperation<vx::ops::Transpose>(perm)
+      ->BindInput(mapped)
+      .BindOutput(target);
+  materialized_[t] = target;
+  return target;
+}
+
+void TransposeOptimizer::FoldTranspose(
+    const std::shared_ptr<vx::Operation>& op) {
+  auto in = op->impl()->InputsTensor()[0];
+  auto out = op->impl()->OutputsTensor()[0];
+  auto pv = TransposePerm(op);
+  auto in_pv = Pending(in);
+  if (in_pv && in_pv->Rank() == pv->Rank()) {
+    // (x.T(p)).T(q) == x.T(p.Add(q))
+    rebuilder_.Map(out, rebuilder_.Mapped(in));
+    pv = in_pv->Add(pv);
+  } else {
+    rebuilder_.Map(out, Materialize(in));
+  }
+  pending_[out] = pv;
+}
+
+bool TransposeOptimizer::TrySink(const std::shared_ptr<vx::Operation>& op) {
+  auto kind = op->impl()->kind_;
+  auto inputs = op->impl()->InputsTensor();
+  auto outputs = op->impl()->OutputsTensor();
+  if (outputs.size() != 1 || outputs[0]->GetQuantization().Type() ==
+                                 vx::QuantType::SYMMETRIC_PER_CHANNEL) {
+    return false;
+  }
+
+  IPermuteVectorPtr pv;
+  if (IsLayoutAgnosticUnary(kind) && inputs.size() == 1) {
+    pv = Pending(inputs[0]);
+    if (IsIdentity(pv) || !HasSingleConsumer(inputs[0], op)) return false;
+  } else if (IsLayoutAgnosticBinary(kind) && inputs.size() == 2) {
+    for (const auto& in : inputs) {
+      // A single element is the same in any layout
+      if (in->IsConstTensor() && in->GetSpec().GetElementNum() == 1) continue;
+      auto in_pv = Pending(in);
+      if (IsIdentity(in_pv) || !HasSingleConsumer(in, op) ||
+          (pv && !SamePermute(pv, in_pv))) {
+        return false;
+      }
+      pv = in_pv;
+    }
+    if (!pv) return false;
+  } else {
+    return false;
+  }
+
+  auto cloned_op = op->Clone(rebuilder_.graph());
+  for (const auto& in : inputs) {
+    cloned_op->BindInput(rebuilder_.Mapped(in));
+  }
+  auto out = CreateOutput(outputs[0], pv);
+  cloned_op->BindOutput(out);
+  rebuilder_.Map(outputs[0], out);
+  pending_[outputs[0]] = pv;
+  ++sunk_ops_;
+  return true;
+}
+
+void TransposeOptimizer::Emit(const std::shared_ptr<vx::Operation>& op) {
+  auto cloned_op = op->Clone(rebuilder_.graph());
+  for (const auto& in : op->impl()->InputsTensor()) {
+    cloned_op->BindInput(Materialize(in));
+  }
+  std::vector<std::shared_ptr<vx::Tensor>> outs;
+  for (const auto& out : op->impl()->OutputsTensor()) {
+    outs.push_back(rebuilder_.MapOutput(out));
+  }
+  cloned_op->BindOutputs(outs);
+}
+
+bool TransposeOptimizer::Run() {
+  std::vector<std::shared_ptr<vx::Operation>> sorted;
+  if (!SortOps(rebuilder_.src_graph(), sorted)) {
+    VSILOGE("Graph has a cycle, transposes are not optimized.");
+    return false;
+  }
+
+  for (const auto& op : sorted) {
+    if (op->impl()->kind_ == VSI_NN_OP_PERMUTE) {
+      FoldTranspose(op);
+    } else if (!TrySink(op)) {
+      Emit(op);
+    }
+  }
+
+  // Land transposes still pending on graph outputs
+  for (const auto& out : rebuilder_.src_graph()->OutputsTensor()) {
+    if (rebuilder_.IsMapped(out)) Materialize(out);
+  }
+  return true;
+}
+
+}  // namespace
+
+std::pair<std::shared_ptr<vx::Graph>,
+          std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+TransposeOptimization(const std::shared_ptr<vx::Graph>& src_graph,
+                      std::shared_ptr<vx::Context>& ctx,
+                      TransposeOptimizationStats* stats) {
+  TransposeOptimizer optimizer(src_graph, ctx);
+  if (!optimizer.Run()) {
+    return std::make_pair(nullptr, std::map<std::shared_ptr<vx::Tensor>,
+                                            std::shared_ptr<vx::Tensor>>());
+  }
+
+  if (stats) {
+    auto count_transposes =
+        [](std::vector<std::shared_ptr<vx::Operation>>& ops) {
+      return static_cast<uint32_t>(std::count_if(
+          ops.begin(), ops.end(), [](const std::shared_ptr<vx::Operation>& op) {
+            return op->impl()->kind_ == VSI_NN_OP_PERMUTE;
+          }));
+    };
+    stats->transposes_before = count_transposes(src_graph->OpVector());
+    stats->transposes_after =
+        count_transposes(optimizer.rebuilder().graph()->OpVector());
+    stats->sunk_ops = optimizer.sunk_ops();
+  }
+  return std::make_pair(optimizer.rebuilder().graph(),
+                        optimizer.rebuilder().io_map());
+}
+
+}  // namespace transform
+}  // namespace tim
@@ -0,0 +1,199 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/transpose_optimization.h"
+#include "tim/transform/layout_inference.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+
+TEST(TransposeOptimization, compose_and_cancel) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType io_shape({2, 3, 4});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto input = src_graph->CreateTensor(input_spec);
+  auto t0 = src_graph->CreateTensor(input_spec.AsTransientSpec());
+  auto t1 = src_graph->CreateTensor(input_spec.AsTransientSpec());
+  auto t2 = src_graph->CreateTensor(input_spec.AsTransientSpec());
+  auto output = src_graph->CreateTensor(output_spec);
+
+  // {1, 2, 0} three times is identity, and so is {0, 1, 2}
+  auto perm = std::vector<uint32_t>({1, 2, 0});
+  src_graph->CreateOperation<tim::vx::ops::Transpose>(perm)
+      ->BindInput(input).BindOutput(t0);
+  src_graph->CreateOperation<tim::vx::ops::Transpose>(perm)
+      ->BindInput(t0).BindOutput(t1);
+  src_graph->CreateOperation<tim::vx::ops::Transpose>(
+      std::vector<uint32_t>({0, 1, 2}))->BindInput(t1).BindOutput(t2);
+  src_graph->CreateOperation<tim::vx::ops::Transpose>(perm)
+      ->BindInput(t2).BindOutput(output);
+
+  tim::transform::TransposeOptimizationStats stats;
+  auto result = tim::transform::TransposeOptimization(src_graph, ctx, &stats);
+  ASSERT_NE(result.first, nullptr);
+  EXPECT_EQ(stats.transposes_before, 4u);
+  // only the copy into the graph output is left
+  EXPECT_EQ(stats.transposes_after, 1u);
+
+  std::vector<float> in_data(24);
+  for (size_t i = 0; i < in_data.size(); ++i) in_data[i] = i;
+  auto opt_graph = result.first;
+  EXPECT_TRUE(opt_graph->Compile());
+  EXPECT_TRUE(result.second[input]->CopyDataToTensor(
+      in_data.data(), in_data.size() * sizeof(float)));
+  EXPECT_TRUE(opt_graph->Run());
+  std::vector<float> out_data(in_data.size());
+  EXPECT_TRUE(result.second[output]->CopyDataFromTensor(out_data.data()));
+  EXPECT_EQ(in_data, out_data);
+}
+
+TEST(TransposeOptimization, sink_through_elementwise) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType io_shape({2, 3});
+  tim::vx::ShapeType trans_shape({3, 2});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec trans_spec(tim::vx::DataType::FLOAT32, trans_shape,
+                                 tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec scalar_spec(tim::vx::DataType::FLOAT32, {1},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  float two = 2.0f;
+  auto input0 = src_graph->CreateTensor(input_spec);
+  auto input1 = src_graph->CreateTensor(input_spec);
+  auto scalar = src_graph->CreateTensor(scalar_spec, &two);
+  auto t0 = src_graph->CreateTensor(trans_spec);
+  auto t1 = src_graph->CreateTensor(trans_spec);
+  auto t2 = src_graph->CreateTensor(trans_spec);
+  auto t3 = src_graph->CreateTensor(trans_spec);
+  auto t4 = src_graph->CreateTensor(trans_spec);
+  auto output = src_graph->CreateTensor(output_spec);
+
+  // output = T(relu(T(in0)) + T(in1) * 2)
+  auto perm = std::vector<uint32_t>({1, 0});
+  src_graph->CreateOperation<tim::vx::ops::Transpose>(perm)
+      ->BindInput(input0).BindOutput(t0);
+  src_graph->CreateOperation<tim::vx::ops::Relu>()->BindInput(t0).BindOutput(t1);
+  src_graph->CreateOperation<tim::vx::ops::Transpose>(perm)
+      ->BindInput(input1).BindOutput(t2);
+  src_graph->CreateOperation<tim::vx::ops::Multiply>()
+      ->BindInputs({t2, scalar}).BindOutput(t3);
+  src_graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({t1, t3}).BindOutput(t4);
+  src_graph->CreateOperation<tim::vx::ops::Transpose>(perm)
+      ->BindInput(t4).BindOutput(output);
+
+  tim::transform::TransposeOptimizationStats stats;
+  auto result = tim::transform::TransposeOptimization(src_graph, ctx, &stats);
+  ASSERT_NE(result.first, nullptr);
+  EXPECT_EQ(stats.transposes_before, 3u);
+  EXPECT_EQ(stats.transposes_after, 0u);
+  EXPECT_EQ(stats.Removed(), 3u);
+  EXPECT_EQ(stats.sunk_ops, 3u);
+
+  std::vector<float> in0 = {-1, 2, -3, 4, -5, 6};
+  std::vector<float> in1 = {1, 1, 1, 1, 1, 1};
+  std::vector<float> golden = {2, 4, 2, 6, 2, 8};
+  auto opt_graph = result.first;
+  EXPECT_TRUE(opt_graph->Compile());
+  EXPECT_TRUE(result.second[input0]->CopyDataToTensor(
+      in0.data(), in0.size() * sizeof(float)));
+  EXPECT_TRUE(result.second[input1]->CopyDataToTensor(
+      in1.data(), in1.size() * sizeof(float)));
+  EXPECT_TRUE(opt_graph->Run());
+  std::vector<float> out_data(golden.size());
+  EXPECT_TRUE(result.second[output]->CopyDataFromTensor(out_data.data()));
+  EXPECT_TRUE(ArraysMatch(golden, out_data, 1e-5f));
+}
+
+TEST(TransposeOptimization, nhwc_conv_transpose_round_trip) {
+  auto ctx = tim::vx::Context::Create();
+  auto src_graph = ctx->CreateGraph();
+
+  // conv -> transpose -> inverse transpose -> conv in NHWC, as exporters
+  // emit around layout sensitive ops. Layout inference lowers the pair
+  // and the permutes it adds around the convs into a chain of transposes
+  const uint32_t channels = 16, size = 32;
+  tim::vx::ShapeType io_shape({channels, size, size, 1});  // CWHN
+  tim::vx::ShapeType whcn_shape({size, size, channels, 1});
+  tim::vx::ShapeType kernel_shape({channels, 3, 3, channels});  // IcWHOc
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec trans_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                 tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec whcn_spec(tim::vx::DataType::FLOAT32, whcn_shape,
+                                tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec kernel_spec(tim::vx::DataType::FLOAT32, kernel_shape,
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  std::vector<float> kernel_data(kernel_spec.GetElementNum(), 0.01f);
+  auto input = src_graph->CreateTensor(input_spec);
+  auto kernel = src_graph->CreateTensor(kernel_spec, kernel_data.data());
+  auto t0 = src_graph->CreateTensor(trans_spec);
+  auto t1 = src_graph->CreateTensor(whcn_spec);
+  auto t2 = src_graph->CreateTensor(trans_spec);
+  auto output = src_graph->CreateTensor(output_spec);
+  auto create_conv = [&]() {
+    return src_graph->CreateOperation<tim::vx::ops::Conv2d>(
+        channels, tim::vx::PadType::SAME, std::array<uint32_t, 2>({3, 3}),
+        std::array<uint32_t, 2>({1, 1}), std::array<uint32_t, 2>({1, 1}),
+        std::array<uint32_t, 4>({0, 0, 0, 0}), 0, tim::vx::DataLayout::CWHN,
+        tim::vx::DataLayout::IcWHOc);
+  };
+  create_conv()->BindInputs({input, kernel}).BindOutput(t0);
+  src_graph->CreateOperation<tim::vx::ops::Transpose>(
+      std::vector<uint32_t>({1, 2, 0, 3}))->BindInput(t0).BindOutput(t1);
+  src_graph->CreateOperation<tim::vx::ops::Transpose>(
+      std::vector<uint32_t>({2, 0, 1, 3}))->BindInput(t1).BindOutput(t2);
+  create_conv()->BindInputs({t2, kernel}).BindOutput(output);
+
+  auto infer = tim::transform::LayoutInference(src_graph, ctx);
+  tim::transform::TransposeOptimizationStats stats;
+  auto opt = tim::transform::TransposeOptimization(infer.first, ctx, &stats);
+  ASSERT_NE(opt.first, nullptr);
+  EXPECT_GT(stats.Removed(), 0u);
+
+  std::vector<float> in_data(input_spec.GetElementNum());
+  for (size_t i = 0; i < in_data.size(); ++i) in_data[i] = i % 7;
+  auto infer_out = RunGraph(infer.first, infer.second[input],
+                            infer.second[output], in_data);
+  auto opt_out = RunGraph(opt.first, opt.second[infer.second[input]],
+                          opt.second[infer.second[output]], in_data);
+  EXPECT_TRUE(ArraysMatch(infer_out, opt_out, 1e-4f));
+
+  RecordProperty("transposes_before", stats.transposes_before);
+  RecordProperty("transposes_after", stats.transposes_after);
+}
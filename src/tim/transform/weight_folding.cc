@@ -0,0 +1,536 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/weight_folding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "builtin_op_impl.h"
+#include "const_data.h"
+#include "graph_rebuilder.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/operation.h"
+#include "tim/vx/ops/conv2d.h"
+#include "tim/vx/ops/deconv.h"
+#include "tim/vx/ops/groupedconv2d.h"
+
+namespace tim {
+namespace transform {
+namespace {
+
+std::vector<float> ReadFloatData(const std::shared_ptr<vx::Tensor>& t) {
+  std::vector<float> values;
+  float* data = t->ConvertTensorToFloat32Data();
+  if (data) {
+    values.assign(data, data + t->GetSpec().GetElementNum());
+    vsi_nn_Free(data);
+  }
+  return values;
+}
+
+// Values of constant `t` holding one value per channel or a single one
+std::vector<float> ReadChannelData(const std::shared_ptr<vx::Tensor>& t,
+                                   uint32_t channels) {
+  if (!t->IsConstTensor()) return {};
+  auto values = ReadFloatData(t);
+  if (values.size() == 1) values.assign(channels, values[0]);
+  if (values.size() != channels) values.clear();
+  return values;
+}
+
+size_t Stride(const vx::ShapeType& shape, uint32_t dim) {
+  size_t stride = 1;
+  for (uint32_t i = 0; i < dim; ++i) stride *= shape[i];
+  return stride;
+}
+
+bool QuantRange(vx::DataType dtype, int64_t& qmin, int64_t& qmax) {
+  switch (dtype) {
+    case vx::DataType::INT8:
+      qmin = std::numeric_limits<int8_t>::min();
+      qmax = std::numeric_limits<int8_t>::max();
+      return true;
+    case vx::DataType::UINT8:
+      qmin = std::numeric_limits<uint8_t>::min();
+      qmax = std::numeric_limits<uint8_t>::max();
+      return true;
+    case vx::DataType::INT16:
+      qmin = std::numeric_limits<int16_t>::min();
+      qmax = std::numeric_limits<int16_t>::max();
+      return true;
+    case vx::DataType::INT32:
+      qmin = std::numeric_limits<int32_t>::min();
+      qmax = std::numeric_limits<int32_t>::max();
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Weights and bias of these specs are encoded again after folding
+bool CanEncode(const vx::TensorSpec& spec) {
+  int64_t qmin, qmax;
+  switch (spec.quantization_.Type()) {
+    case vx::QuantType::NONE:
+      return spec.datatype_ == vx::DataType::FLOAT32 ||
+             spec.datatype_ == vx::DataType::FLOAT16;
+    case vx::QuantType::ASYMMETRIC:
+    case vx::QuantType::SYMMETRIC_PER_CHANNEL:
+      return QuantRange(spec.datatype_, qmin, qmax);
+    default:
+      return false;
+  }
+}
+
+template <typename T>
+void Quantize(const std::vector<float>& values, const vx::TensorSpec& spec,
+              void* raw) {
+  int64_t qmin, qmax;
+  QuantRange(spec.datatype_, qmin, qmax);
+  const auto& quant = spec.quantization_;
+  bool per_channel = quant.Type() == vx::QuantType::SYMMETRIC_PER_CHANNEL;
+  uint32_t dim = per_channel ? quant.ChannelDim() : 0;
+  size_t stride = per_channel ? Stride(spec.shape_, dim) : 1;
+  T* out = static_cast<T*>(raw);
+  for (size_t i = 0; i < values.size(); ++i) {
+    uint32_t c = per_channel ? (i / stride) % spec.shape_[dim] : 0;
+    double zp = per_channel ? 0 : quant.ZeroPoints()[0];
+    double q = std::round(values[i] / quant.Scales()[c]) + zp;
+    out[i] = static_cast<T>(std::min<double>(std::max<double>(q, qmin), qmax));
+  }
+}
+
+std::shared_ptr<void> Encode(const std::shared_ptr<vx::Graph>& graph,
+                             const vx::TensorSpec& spec,
+                             const std::vector<float>& values) {
+  size_t bytes = spec.GetByteSize();
+  auto raw = AllocConstData(graph, bytes);
+  if (spec.quantization_.Type() == vx::QuantType::NONE) {
+    if (spec.datatype_ == vx::DataType::FLOAT32) {
+      memcpy(raw.get(), values.data(), bytes);
+    } else {
+      vsi_nn_dtype_t dtype;
+      memset(&dtype, 0, sizeof(dtype));
+      dtype.vx_type = VSI_NN_TYPE_FLOAT16;
+      vsi_nn_DtypeConvertFloat32ToRawData(
+          const_cast<float*>(values.data()), values.size(),
+          static_cast<uint8_t*>(raw.get()), bytes, &dtype);
+    }
+    return raw;
+  }
+  switch (spec.datatype_) {
+    case vx::DataType::INT8:
+      Quantize<int8_t>(values, spec, raw.get());
+      break;
+    case vx::DataType::UINT8:
+      Quantize<uint8_t>(values, spec, raw.get());
+      break;
+    case vx::DataType::INT16:
+      Quantize<int16_t>(values, spec, raw.get());
+      break;
+    default:
+      Quantize<int32_t>(values, spec, raw.get());
+      break;
+  }
+  return raw;
+}
+
+// Fit the quantization of `spec` to the range of folded `values`, keeping
+// symmetric quantization symmetric
+void FitQuantization(vx::TensorSpec& spec, const std::vector<float>& values) {
+  auto& quant = spec.quantization_;
+  int64_t qmin, qmax;
+  if (quant.Type() == vx::QuantType::NONE ||
+      !QuantRange(spec.datatype_, qmin, qmax)) {
+    return;
+  }
+  if (quant.Type() == vx::QuantType::SYMMETRIC_PER_CHANNEL) {
+    uint32_t dim = quant.ChannelDim();
+    size_t stride = Stride(spec.shape_, dim);
+    std::vector<float> absmax(spec.shape_[dim], 0.0f);
+    for (size_t i = 0; i < values.size(); ++i) {
+      uint32_t c = (i / stride) % spec.shape_[dim];
+      absmax[c] = std::max(absmax[c], std::fabs(values[i]));
+    }
+    for (uint32_t c = 0; c < absmax.size(); ++c) {
+      if (absmax[c] > 0) quant.Scales()[c] = absmax[c] / qmax;
+    }
+    return;
+  }
+  auto range = std::minmax_element(values.begin(), values.end());
+  float lo = std::min(0.0f, *range.first);
+  float hi = std::max(0.0f, *range.second);
+  if (hi == lo) return;
+  if (quant.ZeroPoints()[0] == 0 && qmin < 0) {
+    quant.Scales()[0] = std::max(-lo, hi) / qmax;
+  } else {
+    float scale = (hi - lo) / (qmax - qmin);
+    quant.Scales()[0] = scale;
+    quant.ZeroPoints()[0] = static_cast<int32_t>(std::min<double>(
+        std::max<double>(std::round(qmin - lo / scale), qmin), qmax));
+  }
+}
+
+// Spec of the folded bias, int32 at input scale times weight scale for
+// quantized weights
+vx::TensorSpec BiasSpec(const std::shared_ptr<vx::Tensor>& bias,
+                        const vx::TensorSpec& input_spec,
+                        const vx::TensorSpec& weight_spec, uint32_t channels) {
+  const auto& weight_quant = weight_spec.quantization_;
+  if (weight_quant.Type() == vx::QuantType::NONE) {
+    return bias ? bias->GetSpec()
+                : vx::TensorSpec(vx::DataType::FLOAT32, {channels},
+                                 vx::TensorAttribute::CONSTANT);
+  }
+  float input_scale = input_spec.quantization_.Scales()[0];
+  if (weight_quant.Type() == vx::QuantType::SYMMETRIC_PER_CHANNEL) {
+    std::vector<float> scales;
+    for (float scale : weight_quant.Scales()) {
+      scales.push_back(input_scale * scale);
+    }
+    vx::Quantization quant(vx::QuantType::SYMMETRIC_PER_CHANNEL, 0, scales,
+                           std::vector<int32_t>(channels, 0));
+    return vx::TensorSpec(vx::DataType::INT32, {channels},
+                          vx::TensorAttribute::CONSTANT, quant);
+  }
+  vx::Quantization quant(vx::QuantType::ASYMMETRIC,
+                         input_scale * weight_quant.Scales()[0], 0);
+  return vx::TensorSpec(vx::DataType::INT32, {channels},
+                        vx::TensorAttribute::CONSTANT, quant);
+}
+
+// Channel dim of the output of an op with weights, -1 for other ops
+int32_t OutputChannelDim(const std::shared_ptr<vx::Operation>& op) {
+  switch (op->impl()->kind_) {
+    case VSI_NN_OP_CONV2D:
+    case VSI_NN_OP_GROUPED_CONV2D:
+    case VSI_NN_OP_DECONVOLUTION:
+      return op->impl()->layout_ == vx::DataLayout::CWHN ? 0 : 2;
+    case VSI_NN_OP_FCL2:
+      return 0;
+    default:
+      return -1;
+  }
+}
+
+struct KernelDims {
+  int32_t oc;
+  int32_t ic;
+};
+
+KernelDims KernelChannelDims(vx::DataLayout layout) {
+  switch (layout) {
+    case vx::DataLayout::WHIcOc:
+      return {3, 2};
+    case vx::DataLayout::IcWHOc:
+      return {3, 0};
+    case vx::DataLayout::OcIcWH:
+      return {0, 1};
+    case vx::DataLayout::IcOcWH:
+      return {1, 0};
+    default:
+      return {-1, -1};
+  }
+}
+
+KernelDims WeightChannelDims(const std::shared_ptr<vx::Operation>& op) {
+  switch (op->impl()->kind_) {
+    case VSI_NN_OP_CONV2D:
+      return KernelChannelDims(
+          std::static_pointer_cast<vx::ops::Conv2d>(op)->KernelDataLayout());
+    case VSI_NN_OP_GROUPED_CONV2D:
+      return KernelChannelDims(
+          std::static_pointer_cast<vx::ops::GroupedConv2d>(op)
+              ->KernelDataLayout());
+    case VSI_NN_OP_DECONVOLUTION:
+      return KernelChannelDims(
+          std::static_pointer_cast<vx::ops::DeConv2d>(op)->KernelDataLayout());
+    case VSI_NN_OP_FCL2:
+      return {1, 0};
+    default:
+      return {-1, -1};
+  }
+}
+
+// Values of constant `c` per output channel, empty unless `c` broadcasts to
+// an output of `rank` dims along `channel_dim` only
+std::vector<float> BroadcastChannelData(const std::shared_ptr<vx::Tensor>& c,
+                                        size_t rank, uint32_t channel_dim,
+                                        uint32_t channels) {
+  const auto& shape = c->GetShape();
+  if (shape.size() > rank) return {};
+  for (uint32_t i = 0; i < shape.size(); ++i) {
+    if (shape[i] != 1 && (i != channel_dim || shape[i] != channels)) {
+      return {};
+    }
+  }
+  return ReadChannelData(c, channels);
+}
+
+// An op with constant weights whose output is scaled and shifted per
+// channel by the ops folded into it so far
+struct PendingFold {
+  std::shared_ptr<vx::Operation> op;
+  uint32_t channels;
+  uint32_t channel_dim;
+  uint32_t weight_dim;
+  std::vector<float> weight;
+  std::vector<float> bias;
+  uint32_t folded{0};
+};
+
+class WeightFolder {
+ public:
+  WeightFolder(const std::shared_ptr<vx::Graph>& src_graph,
+               std::shared_ptr<vx::Context>& ctx)
+      : rebuilder_(src_graph, ctx) {}
+
+  void Run(const std::vector<std::shared_ptr<vx::Operation>>& sorted) {
+    for (const auto& op : sorted) {
+      if (Fold(op)) continue;
+      // Producers of the inputs go first, also when `op` itself is held back
+      for (const auto& input : op->impl()->InputsTensor()) {
+        auto pending = pending_.find(input);
+        if (pending == pending_.end()) continue;
+        Emit(pending->second, input);
+        pending_.erase(pending);
+      }
+      if (Defer(op)) continue;
+      rebuilder_.Clone(op);
+    }
+  }
+
+  GraphRebuilder& rebuilder() { return rebuilder_; }
+  const WeightFoldingStats& stats() const { return stats_; }
+
+ private:
+  bool HasSingleConsumer(const std::shared_ptr<vx::Tensor>& t) {
+    return !rebuilder_.IsGraphOutput(t) &&
+           rebuilder_.src_graph()->GetConsumersOp(t).size() == 1;
+  }
+
+  // Hold back an op with constant weights until its consumer is seen
+  bool Defer(const std::shared_ptr<vx::Operation>& op) {
+    int32_t channel_dim = OutputChannelDim(op);
+    auto inputs = op->impl()->InputsTensor();
+    auto outputs = op->impl()->OutputsTensor();
+    if (channel_dim < 0 || inputs.size() < 2 || outputs.size() != 1) {
+      return false;
+    }
+    const auto& weight = inputs[1];
+    auto bias = inputs.size() > 2 ? inputs[2] : nullptr;
+    const auto& output_shape = outputs[0]->GetShape();
+    if (!HasSingleConsumer(outputs[0]) || !weight->IsConstTensor() ||
+        (bias && !bias->IsConstTensor()) ||
+        output_shape.size() <= static_cast<size_t>(channel_dim)) {
+      return false;
+    }
+
+    const auto& weight_shape = weight->GetShape();
+    auto dims = WeightChannelDims(op);
+    if (dims.oc < 0 || weight_shape.size() <=
+                           static_cast<size_t>(std::max(dims.oc, dims.ic))) {
+      return false;
+    }
+    // Transient outputs may be left to shape inference
+    uint32_t channels = output_shape[channel_dim];
+    if (channels == 0) channels = weight_shape[dims.oc];
+    int32_t weight_dim = dims.oc;
+    if (weight_shape[dims.oc] != channels) {
+      // Depthwise kernels have a multiplier of 1 in place of output channels
+      if (weight_shape[dims.oc] != 1 || weight_shape[dims.ic] != channels) {
+        return false;
+      }
+      weight_dim = dims.ic;
+    }
+
+    const auto& weight_spec = weight->GetSpec();
+    if (!CanEncode(weight_spec) || (bias && !CanEncode(bias->GetSpec()))) {
+      return false;
+    }
+    const auto& weight_quant = weight_spec.quantization_;
+    if (weight_quant.Type() != vx::QuantType::NONE &&
+        (inputs[0]->GetSpec().quantization_.Type() !=
+             vx::QuantType::ASYMMETRIC ||
+         (weight_quant.Type() == vx::QuantType::SYMMETRIC_PER_CHANNEL &&
+          weight_quant.ChannelDim() != weight_dim))) {
+      return false;
+    }
+
+    PendingFold fold{op,
+                     channels,
+                     static_cast<uint32_t>(channel_dim),
+                     static_cast<uint32_t>(weight_dim),
+                     ReadFloatData(weight),
+                     bias ? ReadFloatData(bias)
+                          : std::vector<float>(channels, 0.0f)};
+    if (fold.bias.size() != channels) return false;
+    pending_[outputs[0]] = std::move(fold);
+    return true;
+  }
+
+  // Fold `op` into the pending op producing its input when it scales and
+  // shifts each channel by constants
+  bool Fold(const std::shared_ptr<vx::Operation>& op) {
+    auto kind = op->impl()->kind_;
+    auto inputs = op->impl()->InputsTensor();
+    if (inputs.empty()) return false;
+    size_t data_index = 0;
+    auto pending = pending_.find(inputs[0]);
+    // Mul and Add take the folded tensor on either side
+    if (pending == pending_.end() && inputs.size() == 2 &&
+        (kind == VSI_NN_OP_MULTIPLY || kind == VSI_NN_OP_ADD)) {
+      data_index = 1;
+      pending = pending_.find(inputs[1]);
+    }
+    if (pending == pending_.end()) return false;
+
+    auto& fold = pending->second;
+    size_t rank = inputs[data_index]->GetShape().size();
+    auto node = op->impl()->node();
+    std::vector<float> scale(fold.channels, 1.0f);
+    std::vector<float> shift(fold.channels, 0.0f);
+    if (kind == VSI_NN_OP_BATCH_NORM) {
+      if (inputs.size() != 5 || rank < 2) return false;
+      uint32_t dim =
+          op->impl()->layout_ == vx::DataLayout::CWHN ? 0 : rank - 2;
+      if (dim != fold.channel_dim) return false;
+      auto mean = ReadChannelData(inputs[1], fold.channels);
+      auto var = ReadChannelData(inputs[2], fold.channels);
+      auto gamma = ReadChannelData(inputs[3], fold.channels);
+      auto beta = ReadChannelData(inputs[4], fold.channels);
+      if (mean.empty() || var.empty() || gamma.empty() || beta.empty()) {
+        return false;
+      }
+      float eps = node->nn_param.batch_norm.eps;
+      for (uint32_t c = 0; c < fold.channels; ++c) {
+        scale[c] = gamma[c] / std::sqrt(var[c] + eps);
+        shift[c] = beta[c] - mean[c] * scale[c];
+      }
+    } else if (kind == VSI_NN_OP_MULTIPLY || kind == VSI_NN_OP_DIVIDE ||
+               kind == VSI_NN_OP_ADD || kind == VSI_NN_OP_SUBTRACT) {
+      if (inputs.size() != 2) return false;
+      auto values = BroadcastChannelData(inputs[1 - data_index], rank,
+                                         fold.channel_dim, fold.channels);
+      if (values.empty()) return false;
+      for (uint32_t c = 0; c < fold.channels; ++c) {
+        switch (kind) {
+          case VSI_NN_OP_MULTIPLY:
+            scale[c] = values[c] * node->nn_param.multiply.scale;
+            break;
+          case VSI_NN_OP_DIVIDE:
+            if (values[c] == 0) return false;
+            scale[c] = node->nn_param.divide.scale / values[c];
+            break;
+          case VSI_NN_OP_ADD:
+            shift[c] = values[c];
+            break;
+          default:
+            shift[c] = -values[c];
+            break;
+        }
+      }
+    } else {
+      return false;
+    }
+
+    const auto& weight_shape = fold.op->impl()->InputsTensor()[1]->GetShape();
+    size_t stride = Stride(weight_shape, fold.weight_dim);
+    for (size_t i = 0; i < fold.weight.size(); ++i) {
+      fold.weight[i] *= scale[(i / stride) % fold.channels];
+    }
+    for (uint32_t c = 0; c < fold.channels; ++c) {
+      fold.bias[c] = fold.bias[c] * scale[c] + shift[c];
+    }
+    ++fold.folded;
+    if (kind == VSI_NN_OP_BATCH_NORM) {
+      ++stats_.batchnorms;
+    } else {
+      ++stats_.elementwise;
+    }
+
+    PendingFold folded = std::move(fold);
+    pending_.erase(pending);
+    auto output = op->impl()->OutputsTensor()[0];
+    if (HasSingleConsumer(output)) {
+      pending_[output] = std::move(folded);
+    } else {
+      Emit(folded, output);
+    }
+    return true;
+  }
+
+  // Create the pending op with its folded weights, writing to `output`
+  void Emit(const PendingFold& fold,
+            const std::shared_ptr<vx::Tensor>& output) {
+    if (fold.folded == 0) {
+      rebuilder_.Clone(fold.op);
+      return;
+    }
+    auto& graph = rebuilder_.graph();
+    auto inputs = fold.op->impl()->InputsTensor();
+    auto weight_spec = inputs[1]->GetSpec();
+    FitQuantization(weight_spec, fold.weight);
+    auto bias_spec = BiasSpec(inputs.size() > 2 ? inputs[2] : nullptr,
+                              inputs[0]->GetSpec(), weight_spec, fold.channels);
+    auto weight = CreateConstTensor(graph, weight_spec,
+                                    Encode(graph, weight_spec, fold.weight));
+    auto bias = CreateConstTensor(graph, bias_spec,
+                                  Encode(graph, bias_spec, fold.bias));
+    auto cloned = fold.op->Clone(graph);
+    cloned->BindInputs({rebuilder_.Mapped(inputs[0]), weight, bias});
+    cloned->BindOutput(rebuilder_.MapOutput(output));
+  }
+
+  GraphRebuilder rebuilder_;
+  std::map<std::shared_ptr<vx::Tensor>, PendingFold> pending_;
+  WeightFoldingStats stats_;
+};
+
+}  // namespace
+
+std::pair<std::shared_ptr<vx::Graph>,
+          std::map<std::shared_ptr<vx::Tensor>, std::shared_ptr<vx::Tensor>>>
+WeightFolding(const std::shared_ptr<vx::Graph>& src_graph,
+              std::shared_ptr<vx::Context>& ctx, WeightFoldingStats* stats) {
+  std::vector<std::shared_ptr<vx::Operation>> sorted;
+  if (!SortOps(src_graph, sorted)) {
+    VSILOGE("Graph has a cycle, weights are not folded.");
+    return std::make_pair(nullptr, std::map<std::shared_ptr<vx::Tensor>,
+                                            std::shared_ptr<vx::Tensor>>());
+  }
+
+  WeightFolder folder(src_graph, ctx);
+  folder.Run(sorted);
+  if (stats) *stats = folder.stats();
+  return std::make_pair(folder.rebuilder().graph(),
+                        folder.rebuilder().io_map());
+}
+
+}  // namespace transform
+}  // namespace tim
@@ -0,0 +1,295 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/transform/weight_folding.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdlib>
+
+TEST(WeightFolding, conv_batchnorm_mul_add) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::ShapeType input_shape({4, 4, 2, 1});
+  tim::vx::ShapeType output_shape({4, 4, 3, 1});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, input_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32,
+                                     output_shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, output_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec weight_spec(tim::vx::DataType::FLOAT32, {3, 3, 2, 3},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec channel_spec(tim::vx::DataType::FLOAT32, {3},
+                                   tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec mul_spec(tim::vx::DataType::FLOAT32, {1, 1, 3, 1},
+                               tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec scalar_spec(tim::vx::DataType::FLOAT32, {1},
+                                  tim::vx::TensorAttribute::CONSTANT);
+
+  std::vector<float> weight_data(3 * 3 * 2 * 3);
+  for (size_t i = 0; i < weight_data.size(); ++i) {
+    weight_data[i] = static_cast<float>(i % 7) * 0.25f - 0.75f;
+  }
+  std::vector<float> bias_data{0.5f, -0.25f, 1.0f};
+  std::vector<float> mean_data{0.1f, -0.2f, 0.3f};
+  std::vector<float> var_data{1.5f, 0.5f, 2.0f};
+  std::vector<float> gamma_data{0.8f, 1.2f, -0.5f};
+  std::vector<float> beta_data{0.0f, 0.3f, -0.1f};
+  std::vector<float> mul_data{2.0f, -1.0f, 0.5f};
+  float add_data = 0.75f;
+
+  auto input = graph->CreateTensor(input_spec);
+  auto weight = graph->CreateTensor(weight_spec, weight_data.data());
+  auto bias = graph->CreateTensor(channel_spec, bias_data.data());
+  auto conv_out = graph->CreateTensor(transient_spec);
+  auto bn_out = graph->CreateTensor(transient_spec);
+  auto mul_out = graph->CreateTensor(transient_spec);
+  auto output = graph->CreateTensor(output_spec);
+
+  auto conv = graph->CreateOperation<tim::vx::ops::Conv2d>(
+      tim::vx::PadType::SAME, std::array<uint32_t, 2>({1, 1}),
+      std::array<uint32_t, 2>({1, 1}));
+  (*conv).BindInputs({input, weight, bias}).BindOutput(conv_out);
+  auto bn = graph->CreateOperation<tim::vx::ops::BatchNorm>(1e-5f);
+  (*bn)
+      .BindInputs({conv_out,
+                   graph->CreateTensor(channel_spec, mean_data.data()),
+                   graph->CreateTensor(channel_spec, var_data.data()),
+                   graph->CreateTensor(channel_spec, gamma_data.data()),
+                   graph->CreateTensor(channel_spec, beta_data.data())})
+      .BindOutput(bn_out);
+  auto mul = graph->CreateOperation<tim::vx::ops::Multiply>();
+  (*mul)
+      .BindInputs({graph->CreateTensor(mul_spec, mul_data.data()), bn_out})
+      .BindOutput(mul_out);
+  auto add = graph->CreateOperation<tim::vx::ops::Add>();
+  (*add)
+      .BindInputs({mul_out, graph->CreateTensor(scalar_spec, &add_data)})
+      .BindOutput(output);
+
+  tim::transform::WeightFoldingStats stats;
+  auto folded = tim::transform::WeightFolding(graph, ctx, &stats);
+  ASSERT_NE(folded.first, nullptr);
+  EXPECT_EQ(stats.batchnorms, 1u);
+  EXPECT_EQ(stats.elementwise, 2u);
+  EXPECT_EQ(stats.Removed(), 3u);
+  EXPECT_EQ(folded.first->OpVector().size(), 1u);
+
+  std::vector<float> input_data(4 * 4 * 2);
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = static_cast<float>(i % 5) - 2.0f;
+  }
+  auto golden = RunGraph(graph, input, output, input_data, 4 * 4 * 3);
+  auto result = RunGraph(folded.first, folded.second[input],
+                         folded.second[output], input_data, 4 * 4 * 3);
+  EXPECT_TRUE(ArraysMatch(golden, result, 1e-3f));
+}
+
+TEST(WeightFolding, quantized_fc_mul) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::Quantization input_quant(tim::vx::QuantType::ASYMMETRIC, 0.1f, 128);
+  tim::vx::Quantization weight_quant(tim::vx::QuantType::ASYMMETRIC, 0.05f,
+                                     128);
+  tim::vx::Quantization bias_quant(tim::vx::QuantType::ASYMMETRIC, 0.005f, 0);
+  tim::vx::Quantization fc_quant(tim::vx::QuantType::ASYMMETRIC, 0.1f, 128);
+  tim::vx::Quantization mul_quant(tim::vx::QuantType::ASYMMETRIC, 0.02f, 0);
+  tim::vx::Quantization output_quant(tim::vx::QuantType::ASYMMETRIC, 0.2f,
+                                     128);
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::UINT8, {4, 2},
+                                 tim::vx::TensorAttribute::INPUT, input_quant);
+  tim::vx::TensorSpec weight_spec(tim::vx::DataType::UINT8, {4, 3},
+                                  tim::vx::TensorAttribute::CONSTANT,
+                                  weight_quant);
+  tim::vx::TensorSpec bias_spec(tim::vx::DataType::INT32, {3},
+                                tim::vx::TensorAttribute::CONSTANT,
+                                bias_quant);
+  tim::vx::TensorSpec fc_spec(tim::vx::DataType::UINT8, {3, 2},
+                              tim::vx::TensorAttribute::TRANSIENT, fc_quant);
+  tim::vx::TensorSpec mul_spec(tim::vx::DataType::UINT8, {3},
+                               tim::vx::TensorAttribute::CONSTANT, mul_quant);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::UINT8, {3, 2},
+                                  tim::vx::TensorAttribute::OUTPUT,
+                                  output_quant);
+
+  std::vector<uint8_t> weight_data{148, 108, 138, 128, 118, 158,
+                                   128, 98,  168, 133, 123, 113};
+  std::vector<int32_t> bias_data{100, -200, 40};
+  std::vector<uint8_t> mul_data{100, 50, 150};
+  auto input = graph->CreateTensor(input_spec);
+  auto fc_out = graph->CreateTensor(fc_spec);
+  auto output = graph->CreateTensor(output_spec);
+  auto fc = graph->CreateOperation<tim::vx::ops::FullyConnected>(0, 3);
+  (*fc).BindInputs({input, graph->CreateTensor(weight_spec, weight_data.data()),
+                    graph->CreateTensor(bias_spec, bias_data.data())})
+      .BindOutput(fc_out);
+  auto mul = graph->CreateOperation<tim::vx::ops::Multiply>();
+  (*mul)
+      .BindInputs({fc_out, graph->CreateTensor(mul_spec, mul_data.data())})
+      .BindOutput(output);
+
+  tim::transform::WeightFoldingStats stats;
+  auto folded = tim::transform::WeightFolding(graph, ctx, &stats);
+  ASSERT_NE(folded.first, nullptr);
+  EXPECT_EQ(stats.Removed(), 1u);
+  EXPECT_EQ(folded.first->OpVector().size(), 1u);
+
+  std::vector<uint8_t> input_data{138, 118, 148, 108, 128, 158, 98, 133};
+  // Float reference of the folded ops, without the rounding of fc_out
+  std::vector<int32_t> golden(3 * 2);
+  for (uint32_t n = 0; n < 2; ++n) {
+    for (uint32_t c = 0; c < 3; ++c) {
+      float sum = bias_data[c] * 0.005f;
+      for (uint32_t i = 0; i < 4; ++i) {
+        sum += (input_data[n * 4 + i] - 128) * 0.1f *
+               (weight_data[c * 4 + i] - 128) * 0.05f;
+      }
+      float value = sum * mul_data[c] * 0.02f;
+      golden[n * 3 + c] = static_cast<int32_t>(std::round(value / 0.2f)) + 128;
+    }
+  }
+  auto result = RunGraph(folded.first, folded.second[input],
+                         folded.second[output], input_data, 3 * 2);
+  for (size_t i = 0; i < golden.size(); ++i) {
+    EXPECT_LE(std::abs(static_cast<int32_t>(result[i]) - golden[i]), 1)
+        << "at " << i;
+  }
+}
+
+TEST(WeightFolding, conv_conv) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::ShapeType shape({4, 4, 2, 1});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, shape,
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec weight_spec(tim::vx::DataType::FLOAT32, {3, 3, 2, 2},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec bias_spec(tim::vx::DataType::FLOAT32, {2},
+                                tim::vx::TensorAttribute::CONSTANT);
+
+  std::vector<float> weight_data(3 * 3 * 2 * 2);
+  for (size_t i = 0; i < weight_data.size(); ++i) {
+    weight_data[i] = static_cast<float>(i % 5) * 0.25f - 0.5f;
+  }
+  std::vector<float> bias_data{0.5f, -0.25f};
+  auto input = graph->CreateTensor(input_spec);
+  auto conv0_out = graph->CreateTensor(transient_spec);
+  auto output = graph->CreateTensor(output_spec);
+  // The intermediate tensor has a single consumer, which is deferred too
+  auto conv0 = graph->CreateOperation<tim::vx::ops::Conv2d>(
+      tim::vx::PadType::SAME, std::array<uint32_t, 2>({1, 1}),
+      std::array<uint32_t, 2>({1, 1}));
+  (*conv0)
+      .BindInputs({input, graph->CreateTensor(weight_spec, weight_data.data()),
+                   graph->CreateTensor(bias_spec, bias_data.data())})
+      .BindOutput(conv0_out);
+  auto conv1 = graph->CreateOperation<tim::vx::ops::Conv2d>(
+      tim::vx::PadType::SAME, std::array<uint32_t, 2>({1, 1}),
+      std::array<uint32_t, 2>({1, 1}));
+  (*conv1)
+      .BindInputs({conv0_out,
+                   graph->CreateTensor(weight_spec, weight_data.data()),
+                   graph->CreateTensor(bias_spec, bias_data.data())})
+      .BindOutput(output);
+
+  tim::transform::WeightFoldingStats stats;
+  auto folded = tim::transform::WeightFolding(graph, ctx, &stats);
+  ASSERT_NE(folded.first, nullptr);
+  EXPECT_EQ(stats.Removed(), 0u);
+  EXPECT_EQ(folded.first->OpVector().size(), 2u);
+
+  std::vector<float> input_data(4 * 4 * 2);
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = static_cast<float>(i % 5) - 2.0f;
+  }
+  auto golden = RunGraph(graph, input, output, input_data, 4 * 4 * 2);
+  auto result = RunGraph(folded.first, folded.second[input],
+                         folded.second[output], input_data, 4 * 4 * 2);
+  EXPECT_TRUE(ArraysMatch(golden, result, 1e-3f));
+}
+
+TEST(WeightFolding, fc_fc_mul) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {4, 2},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, {4, 2},
+                                     tim::vx::TensorAttribute::TRANSIENT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {4, 2},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  tim::vx::TensorSpec weight_spec(tim::vx::DataType::FLOAT32, {4, 4},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec channel_spec(tim::vx::DataType::FLOAT32, {4},
+                                   tim::vx::TensorAttribute::CONSTANT);
+
+  std::vector<float> weight_data(4 * 4);
+  for (size_t i = 0; i < weight_data.size(); ++i) {
+    weight_data[i] = static_cast<float>(i % 3) * 0.5f - 0.5f;
+  }
+  std::vector<float> bias_data{0.5f, -0.25f, 1.0f, 0.0f};
+  std::vector<float> mul_data{2.0f, -1.0f, 0.5f, 1.5f};
+  auto input = graph->CreateTensor(input_spec);
+  auto fc0_out = graph->CreateTensor(transient_spec);
+  auto fc1_out = graph->CreateTensor(transient_spec);
+  auto output = graph->CreateTensor(output_spec);
+  auto fc0 = graph->CreateOperation<tim::vx::ops::FullyConnected>(0, 4);
+  (*fc0)
+      .BindInputs({input, graph->CreateTensor(weight_spec, weight_data.data()),
+                   graph->CreateTensor(channel_spec, bias_data.data())})
+      .BindOutput(fc0_out);
+  auto fc1 = graph->CreateOperation<tim::vx::ops::FullyConnected>(0, 4);
+  (*fc1)
+      .BindInputs({fc0_out,
+                   graph->CreateTensor(weight_spec, weight_data.data()),
+                   graph->CreateTensor(channel_spec, bias_data.data())})
+      .BindOutput(fc1_out);
+  auto mul = graph->CreateOperation<tim::vx::ops::Multiply>();
+  (*mul)
+      .BindInputs({fc1_out,
+                   graph->CreateTensor(channel_spec, mul_data.data())})
+      .BindOutput(output);
+
+  tim::transform::WeightFoldingStats stats;
+  auto folded = tim::transform::WeightFolding(graph, ctx, &stats);
+  ASSERT_NE(folded.first, nullptr);
+  EXPECT_EQ(stats.elementwise, 1u);
+  EXPECT_EQ(folded.first->OpVector().size(), 2u);
+
+  std::vector<float> input_data{1.0f, -2.0f, 0.5f, 3.0f,
+                                -1.0f, 0.0f, 2.5f, -0.5f};
+  auto golden = RunGraph(graph, input, output, input_data, 4 * 2);
+  auto result = RunGraph(folded.first, folded.second[input],
+                         folded.second[output], input_data, 4 * 2);
+  EXPECT_TRUE(ArraysMatch(golden, result, 1e-3f));
+}
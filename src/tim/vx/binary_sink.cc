@@ -0,0 +1,119 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/vx/binary_sink.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "vsi_nn_pub.h"
+
+namespace tim {
+namespace vx {
+
+void* VectorBinarySink::Reserve(size_t size) {
+  buf_.resize(size);
+  return buf_.data();
+}
+
+bool VectorBinarySink::Commit(size_t size) {
+  if (size > buf_.size()) {
+    return false;
+  }
+  buf_.resize(size);
+  return true;
+}
+
+void* MemoryBinarySink::Reserve(size_t size) {
+  if (size > capacity_) {
+    VSILOGE("Binary of %zu bytes exceeds sink capacity %zu", size, capacity_);
+    return nullptr;
+  }
+  return base_;
+}
+
+bool MemoryBinarySink::Commit(size_t size) {
+  if (size > capacity_) {
+    return false;
+  }
+  size_ = size;
+  return true;
+}
+
+FileBinarySink::~FileBinarySink() { Unmap(); }
+
+void FileBinarySink::Unmap() {
+  if (map_) {
+    munmap(map_, map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+  }
+}
+
+void* FileBinarySink::Reserve(size_t size) {
+  Unmap();
+  struct stat st;
+  if (0 != fstat(fd_, &st)) {
+    VSILOGE("Stat binary sink fd fail: %s", strerror(errno));
+    return nullptr;
+  }
+  file_size_ = st.st_size;
+  if (file_size_ < offset_ + size &&
+      0 != ftruncate(fd_, static_cast<off_t>(offset_ + size))) {
+    VSILOGE("Grow binary sink file fail: %s", strerror(errno));
+    return nullptr;
+  }
+
+  // mmap offsets must be page aligned
+  uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  uint64_t aligned = offset_ & ~(page - 1);
+  map_delta_ = static_cast<size_t>(offset_ - aligned);
+  map_size_ = size + map_delta_;
+  void* addr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd_, static_cast<off_t>(aligned));
+  if (MAP_FAILED == addr) {
+    VSILOGE("Map binary sink file fail: %s", strerror(errno));
+    map_size_ = 0;
+    return nullptr;
+  }
+  map_ = addr;
+  return static_cast<char*>(map_) + map_delta_;
+}
+
+bool FileBinarySink::Commit(size_t size) {
+  if (!map_ || size + map_delta_ > map_size_) {
+    return false;
+  }
+  Unmap();
+  // Drop the slack reserved past the binary if the file was grown for it
+  uint64_t end = std::max<uint64_t>(file_size_, offset_ + size);
+  return 0 == ftruncate(fd_, static_cast<off_t>(end));
+}
+
+}  // namespace vx
+}  // namespace tim
@@ -34,6 +34,7 @@ struct CompileOptionImpl {
   using RelaxModeType = std::tuple<std::string, bool, bool, bool>;
   CompileOptionImpl() {
     relax_mode_ = RelaxModeType(std::string("RelaxMode"), false, false, false);
+    cache_max_bytes_ = kDefaultCacheMaxBytes;
     #if defined(ENABLE_PLATFORM)
     device_id_ = 0;
     #endif
@@ -61,8 +62,17 @@ struct CompileOptionImpl {
 #endif
 
   RelaxModeType relax_mode_;
+
+  static constexpr uint64_t kDefaultCacheMaxBytes = 1ULL << 30;
+  std::string cache_dir_;
+  uint64_t cache_max_bytes_;
+
+  bool batch_split_{false};
+  uint32_t max_batch_split_{0};
 };
 
+constexpr uint64_t CompileOptionImpl::kDefaultCacheMaxBytes;
+
 CompileOption::CompileOption() : impl_(new CompileOptionImpl()) {}
 
 bool CompileOption::isRelaxMode() const { return this->impl_->RelaxMode(); }
@@ -71,6 +81,38 @@ bool CompileOption::setRelaxMode(bool enable) {
   return this->impl_->RelaxMode() = enable;
 }
 
+const std::string& CompileOption::getCacheDir() const {
+  return this->impl_->cache_dir_;
+}
+
+void CompileOption::setCacheDir(const std::string& dir) {
+  this->impl_->cache_dir_ = dir;
+}
+
+uint64_t CompileOption::getCacheMaxBytes() const {
+  return this->impl_->cache_max_bytes_;
+}
+
+void CompileOption::setCacheMaxBytes(uint64_t max_bytes) {
+  this->impl_->cache_max_bytes_ = max_bytes;
+}
+
+bool CompileOption::isBatchSplit() const {
+  return this->impl_->batch_split_;
+}
+
+void CompileOption::setBatchSplit(bool enable) {
+  this->impl_->batch_split_ = enable;
+}
+
+uint32_t CompileOption::getMaxBatchSplit() const {
+  return this->impl_->max_batch_split_;
+}
+
+void CompileOption::setMaxBatchSplit(uint32_t max_split) {
+  this->impl_->max_batch_split_ = max_split;
+}
+
 #if defined(ENABLE_PLATFORM)
   void CompileOption::setDeviceId(::tim::vx::platform::IDevice::device_id_t device) {
     this->impl_->setDeviceId(device);
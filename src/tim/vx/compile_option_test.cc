@@ -33,4 +33,28 @@ TEST(compile_option, relax_mode) {
   EXPECT_TRUE(opt.isRelaxMode() == true);
 
   EXPECT_TRUE(tim::vx::CompileOption::DefaultOptions.isRelaxMode() == false);
-}
\ No newline at end of file
+}
+TEST(compile_option, cache_dir) {
+  tim::vx::CompileOption opt;
+
+  EXPECT_TRUE(opt.getCacheDir().empty());
+  EXPECT_EQ(opt.getCacheMaxBytes(), 1ULL << 30);
+  opt.setCacheDir("/tmp/tim_vx_cache");
+  opt.setCacheMaxBytes(4096);
+  EXPECT_EQ(opt.getCacheDir(), "/tmp/tim_vx_cache");
+  EXPECT_EQ(opt.getCacheMaxBytes(), 4096u);
+
+  EXPECT_TRUE(tim::vx::CompileOption::DefaultOptions.getCacheDir().empty());
+}
+TEST(compile_option, batch_split) {
+  tim::vx::CompileOption opt;
+
+  EXPECT_FALSE(opt.isBatchSplit());
+  EXPECT_EQ(opt.getMaxBatchSplit(), 0u);
+  opt.setBatchSplit(true);
+  opt.setMaxBatchSplit(2);
+  EXPECT_TRUE(opt.isBatchSplit());
+  EXPECT_EQ(opt.getMaxBatchSplit(), 2u);
+
+  EXPECT_FALSE(tim::vx::CompileOption::DefaultOptions.isBatchSplit());
+}
@@ -0,0 +1,253 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "compiled_graph_cache.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "hash_utils.h"
+#include "tim/vx/compile_option.h"
+#include "vsi_nn_pub.h"
+
+namespace tim {
+namespace vx {
+
+namespace {
+
+constexpr char kMagic[8] = {'T', 'I', 'M', 'V', 'X', 'N', 'B', 'G'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr char kSuffix[] = ".nbg";
+
+struct EntryHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t payload_size;
+  uint64_t payload_hash;
+};
+
+std::atomic<uint64_t> cache_hits(0);
+std::atomic<uint64_t> cache_misses(0);
+std::atomic<uint64_t> cache_stores(0);
+std::atomic<uint64_t> cache_evictions(0);
+
+bool MakeDirs(const std::string& dir) {
+  for (size_t pos = 1; pos <= dir.size(); ++pos) {
+    if (pos != dir.size() && dir[pos] != '/') continue;
+    std::string sub = dir.substr(0, pos);
+    if (0 != mkdir(sub.c_str(), 0755) && EEXIST != errno) {
+      VSILOGE("Create cache directory %s fail: %s", sub.c_str(),
+              strerror(errno));
+      return false;
+    }
+  }
+  return true;
+}
+
+bool EndsWith(const std::string& str, const char* suffix) {
+  size_t len = strlen(suffix);
+  return str.size() >= len && 0 == str.compare(str.size() - len, len, suffix);
+}
+
+}  // namespace
+
+CompileCacheStats GetCompileCacheStats() {
+  CompileCacheStats stats;
+  stats.hits = cache_hits.load();
+  stats.misses = cache_misses.load();
+  stats.stores = cache_stores.load();
+  stats.evictions = cache_evictions.load();
+  return stats;
+}
+
+void ResetCompileCacheStats() {
+  cache_hits = 0;
+  cache_misses = 0;
+  cache_stores = 0;
+  cache_evictions = 0;
+}
+
+CompiledGraphCache::CompiledGraphCache(const std::string& dir,
+                                       uint64_t max_bytes)
+    : dir_(dir), max_bytes_(max_bytes) {
+  while (dir_.size() > 1 && '/' == dir_.back()) {
+    dir_.pop_back();
+  }
+}
+
+std::string CompiledGraphCache::EntryPath(const std::string& key) const {
+  return dir_ + "/" + key + kSuffix;
+}
+
+bool CompiledGraphCache::Load(const std::string& key,
+                              std::vector<char>& nbg) const {
+  std::string path = EntryPath(key);
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (!fp) {
+    cache_misses++;
+    return false;
+  }
+
+  EntryHeader header;
+  struct stat st;
+  bool valid = 0 == fstat(fileno(fp), &st) &&
+               (1 == fread(&header, sizeof(header), 1, fp)) &&
+               0 == memcmp(header.magic, kMagic, sizeof(kMagic)) &&
+               kFormatVersion == header.version;
+  // The payload has to fill the rest of the file exactly, a truncated or
+  // garbled size must not drive the allocation
+  valid = valid && header.payload_size > 0 &&
+          static_cast<uint64_t>(st.st_size) >= sizeof(header) &&
+          header.payload_size ==
+              static_cast<uint64_t>(st.st_size) - sizeof(header);
+  if (valid) {
+    nbg.resize(header.payload_size);
+    valid = 1 == fread(nbg.data(), nbg.size(), 1, fp) &&
+            HashBytes(nbg.data(), nbg.size()) == header.payload_hash;
+  }
+  fclose(fp);
+
+  if (!valid) {
+    VSILOGW("Drop corrupted compile cache entry %s", path.c_str());
+    nbg.clear();
+    unlink(path.c_str());
+    cache_misses++;
+    return false;
+  }
+  return true;
+}
+
+void CompiledGraphCache::Touch(const std::string& key) const {
+  // Refresh modification time, it is the LRU key for eviction.
+  utime(EntryPath(key).c_str(), nullptr);
+  cache_hits++;
+}
+
+bool CompiledGraphCache::Store(const std::string& key,
+                               const std::vector<char>& nbg) const {
+  if (nbg.empty() || !MakeDirs(dir_)) {
+    return false;
+  }
+
+  EntryHeader header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kFormatVersion;
+  header.reserved = 0;
+  header.payload_size = nbg.size();
+  header.payload_hash = HashBytes(nbg.data(), nbg.size());
+
+  // Write to a private file first, rename is atomic within a directory.
+  std::string path = EntryPath(key);
+  // mkstemp gives each writer its own file, so threads or processes storing
+  // the same key don't interleave their output
+  std::string tmp_path = path + ".tmp.XXXXXX";
+  int fd = mkstemp(&tmp_path[0]);
+  if (fd < 0) {
+    VSILOGW("Open compile cache entry %s fail: %s", tmp_path.c_str(),
+            strerror(errno));
+    return false;
+  }
+  // mkstemp creates the file owner-only, entries are readable like before
+  fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  FILE* fp = fdopen(fd, "wb");
+  if (!fp) {
+    VSILOGW("Open compile cache entry %s fail: %s", tmp_path.c_str(),
+            strerror(errno));
+    close(fd);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  bool ok = 1 == fwrite(&header, sizeof(header), 1, fp) &&
+            1 == fwrite(nbg.data(), nbg.size(), 1, fp);
+  ok = (0 == fclose(fp)) && ok;
+  if (!ok || 0 != rename(tmp_path.c_str(), path.c_str())) {
+    VSILOGW("Write compile cache entry %s fail", path.c_str());
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  cache_stores++;
+
+  Evict(path);
+  return true;
+}
+
+void CompiledGraphCache::Remove(const std::string& key) const {
+  unlink(EntryPath(key).c_str());
+  cache_misses++;
+}
+
+void CompiledGraphCache::Evict(const std::string& keep) const {
+  if (0 == max_bytes_) {
+    return;
+  }
+
+  struct Entry {
+    std::string path;
+    time_t mtime;
+    uint64_t size;
+  };
+  std::vector<Entry> entries;
+  uint64_t total = 0;
+
+  DIR* dir = opendir(dir_.c_str());
+  if (!dir) {
+    return;
+  }
+  while (struct dirent* ent = readdir(dir)) {
+    std::string name(ent->d_name);
+    if (!EndsWith(name, kSuffix)) continue;
+    std::string path = dir_ + "/" + name;
+    struct stat st;
+    if (0 != stat(path.c_str(), &st) || !S_ISREG(st.st_mode)) continue;
+    entries.push_back({path, st.st_mtime, static_cast<uint64_t>(st.st_size)});
+    total += st.st_size;
+  }
+  closedir(dir);
+
+  if (total <= max_bytes_) {
+    return;
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+  for (const auto& entry : entries) {
+    if (total <= max_bytes_) break;
+    if (entry.path == keep) continue;
+    if (0 == unlink(entry.path.c_str())) {
+      total -= entry.size;
+      cache_evictions++;
+    }
+  }
+}
+
+}  // namespace vx
+}  // namespace tim
@@ -0,0 +1,66 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_COMPILED_GRAPH_CACHE_H_
+#define TIM_VX_COMPILED_GRAPH_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tim {
+namespace vx {
+
+/// On-disk store of compiled graph binaries (NBG), one file per key.
+/// Files are written atomically so several processes may share a directory.
+/// Eviction is least-recently-used by file modification time, a hit
+/// refreshes the time stamp of its entry.
+class CompiledGraphCache {
+ public:
+  /// max_bytes: budget for all entries in dir, 0 means unlimited.
+  CompiledGraphCache(const std::string& dir, uint64_t max_bytes);
+
+  /// Read the binary stored under key. Counts a miss if there is no valid
+  /// entry, the caller reports the outcome of a read with Touch or Remove.
+  bool Load(const std::string& key, std::vector<char>& nbg) const;
+  /// Mark the entry of key as used once its binary is loaded. Counts a hit.
+  void Touch(const std::string& key) const;
+  /// Store the binary under key and evict old entries over budget.
+  bool Store(const std::string& key, const std::vector<char>& nbg) const;
+  /// Drop the entry of key when the stored binary can't be loaded. Counts a
+  /// miss.
+  void Remove(const std::string& key) const;
+
+ private:
+  std::string EntryPath(const std::string& key) const;
+  /// Drop least recently used entries, except keep, until the budget holds.
+  void Evict(const std::string& keep) const;
+
+  std::string dir_;
+  uint64_t max_bytes_;
+};
+
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_COMPILED_GRAPH_CACHE_H_ */
@@ -24,6 +24,7 @@
 #ifndef TIM_VX_CONTEXT_PRIVATE_H_
 #define TIM_VX_CONTEXT_PRIVATE_H_
 #include "tim/vx/context.h"
+#include "tensor_cache.h"
 #include "vsi_nn_pub.h"
 
 namespace tim {
@@ -38,9 +39,12 @@ class ContextImpl : public Context {
   std::shared_ptr<Graph> CreateGraph(const CompileOption&) override;
   bool isClOnly() override;
   bool hasSP() override;
+  /// Constant tensors of this context, deduplicated within each graph
+  ConstantTensorCache& TensorCache() { return tensor_cache_; }
 
  protected:
   vsi_nn_context_t context_;
+  ConstantTensorCache tensor_cache_;
 };
 
 }  // namespace vx
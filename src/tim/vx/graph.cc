@@ -23,15 +23,16 @@
 *****************************************************************************/
 #include "tim/vx/graph.h"
 #include <algorithm>
-
-#ifdef ENABLE_TENSOR_CACHE
-#include <openssl/evp.h>
+#include <cinttypes>
+#include <cstdio>
 #include <cstring>
-#endif
+#include <iterator>
 
+#include "compiled_graph_cache.h"
 #include "context_private.h"
 #include "graph_private.h"
 #include "op_impl.h"
+#include "hash_utils.h"
 #include "tensor_private.h"
 #include "tim/vx/context.h"
 #include "tim/vx/ops/nbg.h"
@@ -40,44 +41,86 @@
 
 namespace tim {
 namespace vx {
-#ifdef ENABLE_TENSOR_CACHE
-#define MD5_SECRET_LEN_16 (16)
-#define MD5_BYTE_STRING_LEN (4)
-const std::string calculateMd5Secret32(const std::string& src) {
-  std::string md5String;
-  EVP_MD_CTX* mdctx;
-  const EVP_MD* md;
-  uint32_t md_len;
-  unsigned char md_value[MD5_SECRET_LEN_16] = {0};
-  char tmp[MD5_BYTE_STRING_LEN] = {0};
-
-  md = EVP_md5();
-  if (md == NULL) {
-    printf("Unknown EVP_md5 message.");
-  }
-  mdctx = EVP_MD_CTX_new();
-  if (!EVP_DigestInit_ex(mdctx, md, NULL)) {
-    printf("EVP_MD_CTX initialization failed.");
-    EVP_MD_CTX_free(mdctx);
-  }
-  if (!EVP_DigestUpdate(mdctx, src.c_str(), src.size())) {
-    printf("EVP_MD_CTX update failed.");
-    EVP_MD_CTX_free(mdctx);
-  }
-  if (!EVP_DigestFinal_ex(mdctx, md_value, &md_len)) {
-    printf("EVP_MD_CTX finalization failed.");
-    EVP_MD_CTX_free(mdctx);
-  }
-  EVP_MD_CTX_free(mdctx);
-
-  for (int i = 0; i < MD5_SECRET_LEN_16; ++i) {
-    memset(tmp, 0x00, sizeof(tmp));
-    snprintf(tmp, sizeof(tmp), "%02X", md_value[i]);
-    md5String += tmp;
-  }
-  return md5String;
+
+namespace {
+// Bump when the layout of the compile cache key material changes
+constexpr char kCompileCacheKeyTag[] = "tim-vx-compile-cache-2";
+
+template <typename T>
+void AppendKey(std::string& material, const T& value) {
+  material.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void AppendKey(std::string& material, const std::vector<T>& values) {
+  AppendKey(material, values.size());
+  if (!values.empty()) {
+    material.append(reinterpret_cast<const char*>(values.data()),
+                    values.size() * sizeof(T));
+  }
+}
+
+void AppendKey(std::string& material, const char* str) {
+  std::string value(str ? str : "");
+  AppendKey(material, value.size());
+  material.append(value);
+}
+
+void AppendKey(std::string& material, const TensorSpec& spec) {
+  const Quantization& quant = spec.quantization_;
+  AppendKey(material, spec.datatype_);
+  AppendKey(material, spec.attr_);
+  AppendKey(material, spec.shape_);
+  AppendKey(material, quant.Type());
+  AppendKey(material, quant.ChannelDim());
+  AppendKey(material, quant.Scales());
+  AppendKey(material, quant.ZeroPoints());
+  AppendKey(material, quant.Fl());
+}
+
+// Structs are keyed field by field, their padding bytes are undefined
+
+void AppendKey(std::string& material, const vsi_nn_hw_config_t& config) {
+  std::string target_name(
+      config.target_name,
+      strnlen(config.target_name, sizeof(config.target_name)));
+  AppendKey(material, target_name.c_str());
+  AppendKey(material, config.evis.ver);
+  AppendKey(material, config.subGroupSize);
+  AppendKey(material, config.use_40bits_va);
+  AppendKey(material, config.support_stream_processor);
+  AppendKey(material, config.sp_exec_count);
+  AppendKey(material, config.sp_vector_depth);
+  AppendKey(material, config.sp_per_core_vector_depth);
+  AppendKey(material, config.support_ffd);
+}
+
+void AppendKey(std::string& material,
+               const vsi_nn_runtime_option_t& options) {
+  AppendKey(material, options.enable_shader);
+  AppendKey(material, options.enable_opcheck);
+  AppendKey(material, options.enable_concat_optimize);
+  AppendKey(material, options.enable_i8_to_u8);
+  AppendKey(material, options.enable_dataconvert_optimize);
+  AppendKey(material, options.enable_stream_processor);
+  AppendKey(material, options.enable_rgb88_planar_nhwc);
+  AppendKey(material, options.enable_slice_optimize);
+  AppendKey(material, options.enable_batch_opt);
+  AppendKey(material, options.enable_save_file_type);
+  AppendKey(material, options.enable_use_image_process);
+  AppendKey(material, options.enable_use_from_handle);
+  AppendKey(material, options.config);
 }
-#endif
+
+void AppendKey(std::string& material, const vsi_nn_vx_param_t& param) {
+  AppendKey(material, param.overflow_policy);
+  AppendKey(material, param.rounding_policy);
+  AppendKey(material, param.down_scale_size_rounding);
+  AppendKey(material, param.has_relu);
+  AppendKey(material, param.accumulator_bits);
+  AppendKey(material, param.platform);
+}
+}  // namespace
 
 const std::vector<std::shared_ptr<Tensor>> Graph::GetConstantInputs() const {
   std::vector<std::shared_ptr<Tensor>> const_inputs;
@@ -88,65 +131,58 @@ const std::vector<std::shared_ptr<Tensor>> Graph::GetConstantInputs() const {
   return const_inputs;
 }
 
+bool Graph::GetOpParamDigest(const Operation* op, uint64_t& digest) const {
+  auto it = op_index_.find(op);
+  if (op_index_.end() == it) {
+    return false;
+  }
+  digest = it->second.param_digest;
+  return true;
+}
+
+bool Graph::CompileToBinary(BinarySink& sink) {
+  size_t size = 0;
+  if (!CompileToBinary(nullptr, &size)) {
+    return false;
+  }
+  void* buf = sink.Reserve(size);
+  return buf && CompileToBinary(buf, &size) && sink.Commit(size);
+}
+
+BatchSplitReport Graph::GetBatchSplitReport() const {
+  return BatchSplitReport();
+}
+
 GraphImpl::GraphImpl(ContextImpl* context, const CompileOption& options)
     : context_(context),
       graph_(vsi_nn_CreateGraph(context_->context(), 0, 0)),
       tensor_placeholder_(nullptr),
       not_consumed_input_cnt_(0),
       not_consumed_output_cnt_(0),
+#ifdef ENABLE_TENSOR_CACHE
+      tensor_cache_scope_(context->TensorCache().NewScope()),
+#endif
       options_(options) {}
 
-GraphImpl::~GraphImpl() { vsi_nn_ReleaseGraph(&graph_); }
-
-#ifdef ENABLE_TENSOR_CACHE
-std::map<std::string, std::shared_ptr<tim::vx::Tensor>>&
-GraphImpl::GetTensorCacheMap() {
-  return cached_tensor_;
-}
-
-const std::string GraphImpl::CalculateCacheKey(const TensorSpec& spec,
-                                               const void* data) {
-  std::string md5_key;
-  uint32_t data_size = 1;
-  for (auto it = spec.shape_.begin(); it != spec.shape_.end(); ++it) {
-    data_size *= *it;
-  }
-  switch (spec.datatype_) {
-    case DataType::INT16:
-    case DataType::UINT16:
-    case DataType::FLOAT16:
-      data_size *= 2;
-      break;
-    case DataType::INT32:
-    case DataType::UINT32:
-    case DataType::FLOAT32:
-      data_size *= 4;
-      break;
-    case DataType::INT64:
-      data_size *= 8;
-      break;
-    default:
-      break;
-  }
-  if (data_size < 512) {
-    md5_key = calculateMd5Secret32(std::string((const char*)data, data_size));
-  } else {
-    md5_key = calculateMd5Secret32(
-        std::string((const char*)data, 512));  //Take first 512 bytes
+GraphImpl::~GraphImpl() {
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    WaitAsyncRunLocked();
   }
-  return md5_key;
+  vsi_nn_ReleaseGraph(&graph_);
+  borrowed_buffers_.clear();
 }
 
+#ifdef ENABLE_TENSOR_CACHE
 std::shared_ptr<Tensor> GraphImpl::GetTensorFromCache(const TensorSpec& spec,
                                                       const void* data) {
-  std::shared_ptr<tim::vx::Tensor> tensor;
-  std::string md5_key = CalculateCacheKey(spec, data);
-  if (GetTensorCacheMap().find(md5_key) != GetTensorCacheMap().end() &&
-      GetTensorCacheMap()[md5_key]->GetSpec() == spec) {
-    tensor = GetTensorCacheMap()[md5_key];
-  } else {
+  auto& cache = context_->TensorCache();
+  size_t bytes = ConstantTensorCache::DataBytes(spec);
+  uint64_t hash = HashBytes(data, bytes);
+  auto tensor = cache.Lookup(tensor_cache_scope_, spec, data, bytes, hash);
+  if (!tensor) {
     tensor = std::make_shared<TensorImpl>(this, spec, data);
-    GetTensorCacheMap()[md5_key] = tensor;
+    cache.Insert(tensor_cache_scope_, hash, tensor);
   }
   return tensor;
 }
@@ -198,68 +234,100 @@ std::vector<std::shared_ptr<Operation>>& GraphImpl::OpVector() {
 
 std::map<std::shared_ptr<Tensor>, std::vector<std::shared_ptr<Operation>>>&
 GraphImpl::TensorConsumer() {
-  return tensor_consumers_;
+  if (!consumers_ordered_) {
+    ordered_tensor_consumers_.insert(
+        std::make_move_iterator(tensor_consumers_.begin()),
+        std::make_move_iterator(tensor_consumers_.end()));
+    tensor_consumers_.clear();
+    consumers_ordered_ = true;
+  }
+  return ordered_tensor_consumers_;
 }
 
 std::map<std::shared_ptr<Tensor>, std::shared_ptr<Operation>>&
 GraphImpl::TensorProducer() {
-  return tensor_producer_;
+  if (!producer_ordered_) {
+    ordered_tensor_producer_.insert(
+        std::make_move_iterator(tensor_producer_.begin()),
+        std::make_move_iterator(tensor_producer_.end()));
+    tensor_producer_.clear();
+    producer_ordered_ = true;
+  }
+  return ordered_tensor_producer_;
+}
+
+std::shared_ptr<Operation> GraphImpl::FindOp(const Operation* op) const {
+  auto it = op_index_.find(op);
+  if (op_index_.end() == it) {
+    return nullptr;
+  }
+  return it->second.op.lock();
 }
 
 void GraphImpl::UpdateTensorConsumersMap(const std::shared_ptr<Tensor>& tensor,
                                          const Operation* op) {
-  for (const auto& added_op : op_vector_) {
-    if (added_op.get() == op) {
-      tensor_consumers_[tensor].push_back(added_op);
-    }
+  auto added_op = FindOp(op);
+  if (added_op) {
+    WithConsumers([&](auto& consumers) {
+      consumers[tensor].push_back(added_op);
+    });
   }
 }
 
 void GraphImpl::RenewTensorConsumersMap(
     const std::shared_ptr<Tensor>& org_tensor,
     const std::shared_ptr<Tensor>& dst_tensor, const Operation* op) {
-  auto exist_op = std::find_if(
-      op_vector_.begin(), op_vector_.end(),
-      [op](std::shared_ptr<Operation> oper) { return oper.get() == op; });
-  if (exist_op == op_vector_.end()) {
+  auto exist_op = FindOp(op);
+  if (!exist_op) {
     return;  //given op cannot be found
   } else {
-    auto consumer_to_remove = tensor_consumers_.find(org_tensor);
-    if (consumer_to_remove != tensor_consumers_.end())
-      tensor_consumers_.erase(consumer_to_remove);
-    tensor_consumers_[dst_tensor].push_back(*exist_op);
+    WithConsumers([&](auto& consumers) {
+      auto consumer_to_remove = consumers.find(org_tensor);
+      if (consumer_to_remove != consumers.end())
+        consumers.erase(consumer_to_remove);
+      consumers[dst_tensor].push_back(exist_op);
+    });
   }
 }
 
 void GraphImpl::UpdateTensorProducerMap(const std::shared_ptr<Tensor>& tensor,
                                         const Operation* op) {
-  for (const auto& added_op : op_vector_) {
-    if (added_op.get() == op) {
-      tensor_producer_[tensor] = added_op;
-    }
+  auto added_op = FindOp(op);
+  if (added_op) {
+    WithProducer([&](auto& producer) { producer[tensor] = added_op; });
   }
 }
 
 const std::vector<std::shared_ptr<Operation>> GraphImpl::GetConsumersOp(
     std::shared_ptr<Tensor> tensor) const {
-  auto consumers = tensor_consumers_.find(tensor);
-  if (tensor_consumers_.end() != consumers) {
-    return consumers->second;
-  } else {
+  std::vector<std::shared_ptr<Operation>> ops;
+  bool found = false;
+  WithConsumers([&](const auto& consumers) {
+    auto it = consumers.find(tensor);
+    if (consumers.end() != it) {
+      ops = it->second;
+      found = true;
+    }
+  });
+  if (!found) {
     VSILOGD("Tensor has no consumers, may be graph output.");
-    return {};
   }
+  return ops;
 }
 
 std::shared_ptr<Operation> GraphImpl::GetProducerOp(
     std::shared_ptr<Tensor> tensor) {
-  auto producer = tensor_producer_.find(tensor);
-  if (tensor_producer_.end() != producer) {
-    return producer->second;
-  } else {
+  std::shared_ptr<Operation> op;
+  WithProducer([&](const auto& producer) {
+    auto it = producer.find(tensor);
+    if (producer.end() != it) {
+      op = it->second;
+    }
+  });
+  if (!op) {
     VSILOGD("Tensor has no producer, may be graph input.");
-    return {};
   }
+  return op;
 }
 
 void GraphImpl::PrintGraph() const { vsi_nn_PrintGraph(this->graph_); }
@@ -301,6 +369,11 @@ std::shared_ptr<Tensor> GraphImpl::CreateTensor(const TensorSpec& spec,
   return tensor;
 }
 
+std::shared_ptr<Tensor> GraphImpl::CreateTensor(
+    const TensorSpec& spec, const BorrowedBufferDesc& buffer) {
+  return std::make_shared<TensorImpl>(this, spec, buffer);
+}
+
 std::shared_ptr<Tensor> GraphImpl::CreateIOTensor(const TensorSpec& spec,
                                                   void* data) {
   auto tensor = std::make_shared<TensorImpl>(this, spec, data);
@@ -325,9 +398,7 @@ std::shared_ptr<Tensor> GraphImpl::CreateTensorPlaceHolder() {
   return tensor_placeholder_;
 }
 
-bool GraphImpl::Setup() {
-  bool status = true;
-
+void GraphImpl::ApplyGraphAttributes() {
   auto major = vsi_nn_GetVersionMajor();
   auto minor = vsi_nn_GetVersionMinor();
   auto patch = vsi_nn_GetVersionPatch();
@@ -342,11 +413,26 @@ bool GraphImpl::Setup() {
   }
   vsi_nn_SetGraphFastMode(graph_, is_fast_mode);
 
+  if (options_.isBatchSplit()) {
+    if (VSI_SUCCESS !=
+        vsi_nn_SetGraphBatchSplitLimit(graph_, options_.getMaxBatchSplit())) {
+      VSILOGW("Driver doesn't support batch split, option is ignored.");
+    } else {
+      vsi_nn_SetRunTimeVariable(graph_, "VSI_VX_ENABLE_BATCH_OPT", "1");
+    }
+  }
+
 #if defined(ENABLE_PLATFORM)
   auto id = options_.getDeviceId();
   vxSetGraphAttribute(graph_->g, VX_GRAPH_DEVICE_INDEX_VIV, (void*)(&id),
                       sizeof(id));
 #endif
+}
+
+bool GraphImpl::Setup() {
+  bool status = true;
+
+  ApplyGraphAttributes();
 
   std::call_once(setio_once_, [&status, this]() {
     status = (vsi_nn_SetGraphInputs(this->graph_, this->inputs_.data(),
@@ -374,6 +460,11 @@ bool GraphImpl::Compile() {
         "Graph has free output, OUTPUT tensor may be created but not "
         "consumed.");
   }
+  if (!options_.getCacheDir().empty()) {
+    std::call_once(verify_graph_once_,
+                   [&status, this]() { status = CompileWithCache(); });
+    return status;
+  }
   status = Setup();
   std::call_once(verify_graph_once_, [&status, this]() {
     status = (VSI_SUCCESS == vsi_nn_VerifyGraph(this->graph_));
@@ -382,13 +473,327 @@ bool GraphImpl::Compile() {
   return status;
 }
 
+bool GraphImpl::CompileToBinary(BinarySink& sink) {
+  if (!nbg_buf_.empty()) {
+    void* buf = sink.Reserve(nbg_buf_.size());
+    if (!buf) {
+      return false;
+    }
+    memcpy(buf, nbg_buf_.data(), nbg_buf_.size());
+    return sink.Commit(nbg_buf_.size());
+  }
+  if (!Setup()) {
+    return false;
+  }
+  // vxGenerateNBG only writes a binary whose exact size was queried first,
+  // and the query is a full generation pass in the driver. Both passes are
+  // unavoidable, only the intermediate copy is saved
+  size_t size = 0;
+  if (VSI_SUCCESS != vsi_nn_GenerateNBG(graph_, nullptr, &size) || 0 == size) {
+    VSILOGE("Query binary graph size fail");
+    return false;
+  }
+  void* buf = sink.Reserve(size);
+  if (!buf) {
+    return false;
+  }
+  if (VSI_SUCCESS != vsi_nn_GenerateNBG(graph_, buf, &size)) {
+    VSILOGE("Generate binary graph fail");
+    return false;
+  }
+  return sink.Commit(size);
+}
+
 bool GraphImpl::CompileToBinary(void* buf, size_t* size) {
+  if (!nbg_buf_.empty()) {
+    // Graph was loaded from the compile cache, hand out the cached binary
+    if (buf) {
+      memcpy(buf, nbg_buf_.data(), nbg_buf_.size());
+    }
+    *size = nbg_buf_.size();
+    return true;
+  }
   return ((Setup()) && (VSI_SUCCESS == vsi_nn_GenerateNBG(graph_, buf, size)));
 }
 
+BatchSplitReport GraphImpl::GetBatchSplitReport() const {
+  BatchSplitReport report;
+  report.enabled = options_.isBatchSplit();
+  report.node_count = graph_->node_num;
+#if VX_GRAPH_BATCH_OPT_SUPPORT
+  // A graph loaded from the compile cache is a single NBG node, its nodes
+  // were split when the binary was generated and aren't reported
+  report.supported = true;
+  std::unordered_map<const vsi_nn_node_t*, const Operation*> node_op;
+  for (const auto& op : op_vector_) {
+    node_op[op->impl()->node()] = op.get();
+  }
+  for (uint32_t i = 0; i < graph_->node_num; ++i) {
+    vsi_nn_node_t* node = vsi_nn_GetNode(graph_, i);
+    vsi_size_t split = vsi_nn_GetNodeBatchSplitNum(node);
+    if (split <= 1) {
+      continue;
+    }
+    BatchSplitReport::Node entry;
+    auto it = node_op.find(node);
+    entry.op = node_op.end() == it ? nullptr : it->second;
+    entry.name = vsi_nn_OpGetName(node->op);
+    entry.split = static_cast<uint32_t>(split);
+    report.split_nodes.push_back(entry);
+  }
+#endif
+  return report;
+}
+
+bool GraphImpl::CompileWithCache() {
+  bool cacheable = false;
+  std::string key = CalculateCompileCacheKey(cacheable);
+  if (!cacheable) {
+    VSILOGD("Graph can't be keyed for the compile cache, compile it directly.");
+    return Setup() && (VSI_SUCCESS == vsi_nn_VerifyGraph(graph_));
+  }
+
+  CompiledGraphCache cache(options_.getCacheDir(),
+                           options_.getCacheMaxBytes());
+  std::vector<char> nbg;
+  if (cache.Load(key, nbg)) {
+    if (LoadCompiledGraph(nbg)) {
+      cache.Touch(key);
+      return true;
+    }
+    VSILOGW("Load compiled graph %s from cache fail, recompile it.",
+            key.c_str());
+    cache.Remove(key);
+  }
+
+  if (!Setup()) {
+    return false;
+  }
+  VectorBinarySink sink(nbg);
+  if (CompileToBinary(sink)) {
+    cache.Store(key, nbg);
+  } else {
+    VSILOGW("Generate NBG fail, graph is not stored in compile cache.");
+  }
+  return VSI_SUCCESS == vsi_nn_VerifyGraph(graph_);
+}
+
+std::string GraphImpl::CalculateCompileCacheKey(bool& cacheable) {
+  cacheable = false;
+  std::string material(kCompileCacheKeyTag);
+
+  // Toolchain: ovxlib, driver and hardware configuration
+  vsi_nn_context_t ctx = context_->context();
+  AppendKey(material, vsi_nn_GetVersion());
+  char impl_name[VX_MAX_IMPLEMENTATION_NAME] = {0};
+  vx_uint16 vx_version = 0;
+  vxQueryContext(ctx->c, VX_CONTEXT_IMPLEMENTATION, impl_name,
+                 sizeof(impl_name));
+  vxQueryContext(ctx->c, VX_CONTEXT_VERSION, &vx_version, sizeof(vx_version));
+  AppendKey(material, impl_name);
+  AppendKey(material, vx_version);
+  AppendKey(material, ctx->config);
+  AppendKey(material, ctx->options);
+  AppendKey(material, options_.isRelaxMode());
+  AppendKey(material, options_.isBatchSplit());
+  AppendKey(material, options_.getMaxBatchSplit());
+#if defined(ENABLE_PLATFORM)
+  AppendKey(material, options_.getDeviceId());
+#endif
+
+  // Topology: ops in creation order, tensors numbered by first use
+  std::unordered_map<const Tensor*, uint32_t> tensor_index;
+  auto append_tensor = [&material, &tensor_index, this](
+                           const std::shared_ptr<Tensor>& tensor) -> bool {
+    if (!tensor || VSI_NN_TENSOR_ID_NA == tensor->GetId()) {
+      AppendKey(material, UINT32_MAX);
+      return true;
+    }
+    auto it = tensor_index.find(tensor.get());
+    if (tensor_index.end() != it) {
+      AppendKey(material, it->second);
+      return true;
+    }
+    uint32_t index = static_cast<uint32_t>(tensor_index.size());
+    tensor_index[tensor.get()] = index;
+    AppendKey(material, index);
+    AppendKey(material, tensor->GetSpec());
+    if (tensor->IsConstTensor()) {
+      vsi_nn_tensor_t* vsi_tensor = vsi_nn_GetTensor(graph_, tensor->GetId());
+      uint8_t* data =
+          vsi_tensor ? vsi_nn_ConvertTensorToData(graph_, vsi_tensor) : nullptr;
+      if (!data) {
+        return false;
+      }
+      uint32_t bytes =
+          vsi_nn_GetTensorSize(vsi_tensor->attr.size, vsi_tensor->attr.dim_num,
+                               vsi_tensor->attr.dtype.vx_type);
+      AppendKey(material, HashBytes(data, bytes));
+      vsi_nn_Free(data);
+    }
+    return true;
+  };
+
+  for (const auto& op : op_vector_) {
+    auto entry = op_index_.find(op.get());
+    if (op_index_.end() == entry || !entry->second.param_reproducible) {
+      return std::string();
+    }
+    AppendKey(material, op->impl()->kind_);
+    AppendKey(material, entry->second.param_digest);
+    vsi_nn_node_t* node = op->impl()->node();
+    if (node) {
+      AppendKey(material, node->vx_param);
+    }
+    auto inputs = op->impl()->InputsTensor();
+    auto outputs = op->impl()->OutputsTensor();
+    AppendKey(material, inputs.size());
+    for (const auto& tensor : inputs) {
+      if (!append_tensor(tensor)) return std::string();
+    }
+    AppendKey(material, outputs.size());
+    for (const auto& tensor : outputs) {
+      if (!append_tensor(tensor)) return std::string();
+    }
+  }
+
+  // Graph IO order decides the binding order of the compiled binary
+  AppendKey(material, inputs_tensor_.size());
+  for (const auto& tensor : inputs_tensor_) {
+    if (!append_tensor(tensor)) return std::string();
+  }
+  AppendKey(material, outputs_tensor_.size());
+  for (const auto& tensor : outputs_tensor_) {
+    if (!append_tensor(tensor)) return std::string();
+  }
+
+  char key[33] = {0};
+  snprintf(key, sizeof(key), "%016" PRIx64 "%016" PRIx64,
+           HashBytes(material.data(), material.size(), 0),
+           HashBytes(material.data(), material.size(), 0x5bd1e995ULL));
+  cacheable = true;
+  return key;
+}
+
+bool GraphImpl::LoadCompiledGraph(std::vector<char>& nbg) {
+  vsi_nn_graph_t* nbg_graph = vsi_nn_CreateGraph(context_->context(), 0, 0);
+  if (!nbg_graph) {
+    return false;
+  }
+
+  // Contents written to inputs before Compile() live in the low-level tensors
+  // which are re-created below
+  std::vector<std::vector<uint8_t>> input_data(inputs_tensor_.size());
+  for (size_t i = 0; i < inputs_tensor_.size(); ++i) {
+    vsi_nn_tensor_t* vsi_tensor =
+        vsi_nn_GetTensor(graph_, inputs_tensor_[i]->GetId());
+    if (vsi_tensor) {
+      input_data[i].resize(
+          vsi_nn_GetTensorSize(vsi_tensor->attr.size, vsi_tensor->attr.dim_num,
+                               vsi_tensor->attr.dtype.vx_type));
+      if (!inputs_tensor_[i]->CopyDataFromTensor(input_data[i].data())) {
+        input_data[i].clear();
+      }
+    }
+  }
+
+  vsi_nn_graph_t* origin_graph = graph_;
+  graph_ = nbg_graph;
+  nbg_buf_ = std::move(nbg);
+
+  bool status = true;
+  for (const auto& tensor : inputs_tensor_) {
+    status = status && static_cast<TensorImpl*>(tensor.get())->Rebind();
+  }
+  for (const auto& tensor : outputs_tensor_) {
+    status = status && static_cast<TensorImpl*>(tensor.get())->Rebind();
+  }
+  if (status) {
+    nbg_op_ = std::make_shared<ops::NBG>(this, nbg_buf_.data(),
+                                         inputs_tensor_.size(),
+                                         outputs_tensor_.size());
+    nbg_op_->BindInputs(inputs_tensor_).BindOutputs(outputs_tensor_);
+    ApplyGraphAttributes();
+    status = vsi_nn_SetGraphInputs(graph_, inputs_.data(), inputs_.size()) &&
+             vsi_nn_SetGraphOutputs(graph_, outputs_.data(), outputs_.size()) &&
+             (VSI_SUCCESS == vsi_nn_SetupGraph(graph_, true)) &&
+             (VSI_SUCCESS == vsi_nn_VerifyGraph(graph_));
+  }
+
+  if (!status) {
+    // Tensors keep their ids, pointing back at the original graph restores
+    // them
+    nbg_op_.reset();
+    vsi_nn_ReleaseGraph(&graph_);
+    graph_ = origin_graph;
+    nbg = std::move(nbg_buf_);
+    nbg_buf_.clear();
+    return false;
+  }
+
+  for (size_t i = 0; i < inputs_tensor_.size(); ++i) {
+    if (!input_data[i].empty()) {
+      inputs_tensor_[i]->CopyDataToTensor(input_data[i].data(),
+                                          input_data[i].size());
+    }
+  }
+  // Nothing runs on the original graph any more
+  vsi_nn_ReleaseGraph(&origin_graph);
+  // Inputs, outputs and setup were done on the NBG graph
+  std::call_once(setio_once_, []() {});
+  std::call_once(setup_once_, []() {});
+  return true;
+}
+
 bool GraphImpl::Run() {
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    WaitAsyncRunLocked();
+  }
   return ((Compile()) && (VSI_SUCCESS == vsi_nn_RunGraph(graph_)));
 }
 
+std::future<bool> GraphImpl::RunAsync() {
+  std::unique_lock<std::mutex> lock(async_mutex_);
+  WaitAsyncRunLocked();
+  lock.unlock();
+  if (!Compile()) {
+    std::promise<bool> failed;
+    failed.set_value(false);
+    return failed.get_future();
+  }
+
+  auto run = std::make_shared<AsyncRun>();
+  run->graph = graph_;
+  lock.lock();
+  if (VSI_SUCCESS == vsi_nn_AsyncRunGraph(graph_)) {
+    async_run_ = run;
+  } else {
+    VSILOGE("Schedule graph fail");
+    run->done = true;
+  }
+  lock.unlock();
+  // Waiting is deferred to the thread calling get(), no worker is involved.
+  // The graph waits for the run before it is released, so the future never
+  // touches a released graph.
+  return std::async(std::launch::deferred, [run]() { return run->Wait(); });
+}
+
+void GraphImpl::WaitAsyncRunLocked() {
+  if (async_run_) {
+    async_run_->Wait();
+    async_run_.reset();
+  }
+}
+
+bool GraphImpl::AsyncRun::Wait() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!done) {
+    status = (VSI_SUCCESS == vsi_nn_AsyncRunWait(graph));
+    done = true;
+  }
+  return status;
+}
+
 }  // namespace vx
 }  // namespace tim
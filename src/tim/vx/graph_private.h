@@ -30,9 +30,11 @@
 #include <mutex>
 #include <utility>
 #include <map>
+#include <unordered_map>
 
 #include "tim/vx/tensor.h"
 #include "tim/vx/compile_option.h"
+#include "tim/vx/ops/nbg.h"
 #include "context_private.h"
 
 #include "vsi_nn_pub.h"
@@ -46,10 +48,9 @@ class GraphImpl : public Graph {
             const CompileOption& options = CompileOption::DefaultOptions);
   ~GraphImpl();
 #ifdef ENABLE_TENSOR_CACHE
+  /// Return the constant tensor of this graph holding data, create it on miss
   std::shared_ptr<Tensor> GetTensorFromCache(const TensorSpec& spec,
                                              const void* data);
-  const std::string CalculateCacheKey(const TensorSpec& spec, const void* data);
-  std::map<std::string, std::shared_ptr<tim::vx::Tensor>>& GetTensorCacheMap();
 #endif
 
   void SetCompileOption(const CompileOption& new_option) override;
@@ -87,17 +88,26 @@ class GraphImpl : public Graph {
                                        const void* data = nullptr) override;
   std::shared_ptr<Tensor> CreateTensor(const TensorSpec& spec,
                                        const DmaBufferDesc& dmafd) override;
+  std::shared_ptr<Tensor> CreateTensor(
+      const TensorSpec& spec, const BorrowedBufferDesc& buffer) override;
   std::shared_ptr<Tensor> CreateIOTensor(const TensorSpec& spec,
                                          void* data = nullptr) override;
   std::shared_ptr<Tensor> CreateTensorPlaceHolder() override;
 
   bool Compile() override;
   bool CompileToBinary(void* buf, size_t* size) override;
+  bool CompileToBinary(BinarySink& sink) override;
+  BatchSplitReport GetBatchSplitReport() const override;
   bool Run() override;
+  std::future<bool> RunAsync() override;
   void ProduceInput() { not_consumed_input_cnt_++; }
   void ProduceOutput() { not_consumed_output_cnt_++; }
   void ConsumeInput() { not_consumed_input_cnt_--; }
   void ConsumeOutput() { not_consumed_output_cnt_--; }
+  /// Keep borrowed constant memory alive until the low-level graph is released
+  void RetainBorrowedBuffer(std::shared_ptr<const void> buffer) {
+    borrowed_buffers_.push_back(std::move(buffer));
+  }
 
  protected:
   ContextImpl* context_;
@@ -112,18 +122,86 @@ class GraphImpl : public Graph {
   int32_t not_consumed_input_cnt_;
   std::vector<std::shared_ptr<Tensor>> outputs_tensor_;
   int32_t not_consumed_output_cnt_;
-  std::map<std::shared_ptr<Tensor>, std::vector<std::shared_ptr<Operation>>>
+  /// Tensor consumer/producer tables are hashed while the graph is built.
+  /// The first TensorConsumer()/TensorProducer() call moves the table into
+  /// the ordered map handed out to the caller, which is authoritative from
+  /// then on since the caller may edit it.
+  std::unordered_map<std::shared_ptr<Tensor>,
+                     std::vector<std::shared_ptr<Operation>>>
       tensor_consumers_;
-  std::map<std::shared_ptr<Tensor>, std::shared_ptr<Operation>>
+  std::unordered_map<std::shared_ptr<Tensor>, std::shared_ptr<Operation>>
       tensor_producer_;
+  std::map<std::shared_ptr<Tensor>, std::vector<std::shared_ptr<Operation>>>
+      ordered_tensor_consumers_;
+  std::map<std::shared_ptr<Tensor>, std::shared_ptr<Operation>>
+      ordered_tensor_producer_;
+  bool consumers_ordered_ = false;
+  bool producer_ordered_ = false;
 #ifdef ENABLE_TENSOR_CACHE
-  std::map<std::string, std::shared_ptr<tim::vx::Tensor>> cached_tensor_;
+  /// Scope of this graph in the context tensor cache
+  uint64_t tensor_cache_scope_;
 #endif
   CompileOption options_;
+  /// Caller's memory referenced by constant tensors of graph_
+  std::vector<std::shared_ptr<const void>> borrowed_buffers_;
+  /// Compiled binary loaded from the compile cache, referenced by nbg_op_
+  std::vector<char> nbg_buf_;
+  std::shared_ptr<ops::NBG> nbg_op_;
+  /// State of one RunAsync(), shared with the future handed out for it
+  struct AsyncRun {
+    /// Wait for the run unless done, return its status
+    bool Wait();
+
+    std::mutex mutex;
+    vsi_nn_graph_t* graph{nullptr};
+    bool done{false};
+    bool status{false};
+  };
+  /// Guards async_run_, the in-flight asynchronous run if any
+  std::mutex async_mutex_;
+  std::shared_ptr<AsyncRun> async_run_;
 
  private:
   /// Setup graph
   bool Setup();
+  /// Apply version, fast mode and device options to the low-level graph
+  void ApplyGraphAttributes();
+  /// Compile through the on-disk cache configured in options_
+  bool CompileWithCache();
+  /// Key of this graph in the compile cache, cacheable is false if the graph
+  /// holds something which can't be hashed by value
+  std::string CalculateCompileCacheKey(bool& cacheable);
+  /// Replace the low-level graph by a single NBG node running nbg
+  bool LoadCompiledGraph(std::vector<char>& nbg);
+  /// Wait for the in-flight asynchronous run, caller holds async_mutex_
+  void WaitAsyncRunLocked();
+  /// Return the handle of an op owned by this graph, or nullptr
+  std::shared_ptr<Operation> FindOp(const Operation* op) const;
+  /// Call fn with whichever consumer/producer table is authoritative
+  template <typename Fn>
+  void WithConsumers(Fn fn) const {
+    if (consumers_ordered_) {
+      fn(ordered_tensor_consumers_);
+    } else {
+      fn(tensor_consumers_);
+    }
+  }
+  template <typename Fn>
+  void WithConsumers(Fn fn) {
+    if (consumers_ordered_) {
+      fn(ordered_tensor_consumers_);
+    } else {
+      fn(tensor_consumers_);
+    }
+  }
+  template <typename Fn>
+  void WithProducer(Fn fn) {
+    if (producer_ordered_) {
+      fn(ordered_tensor_producer_);
+    } else {
+      fn(tensor_producer_);
+    }
+  }
 };
 
 }  // namespace vx
@@ -21,12 +21,24 @@
 *    DEALINGS IN THE SOFTWARE.
 *
 *****************************************************************************/
+#include "tim/vx/compile_option.h"
 #include "tim/vx/context.h"
 #include "tim/vx/graph.h"
 #include "tim/vx/ops.h"
+#include "tim/vx/tensor.h"
 
 #include "gtest/gtest.h"
+#include "compiled_graph_cache.h"
 
+#include <dirent.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
 #include <vector>
 
 TEST(graph, gen_binary_graph_with_empty_graph) {
@@ -90,6 +102,443 @@ TEST(graph, gen_binary_graph_with_simple_add) {
     EXPECT_EQ(output, expected_out);
 }
 
+TEST(graph, gen_binary_graph_with_sink) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType io_shape({1,1,1,1});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    auto input_t0 = graph->CreateTensor(input_spec);
+    auto input_t1 = graph->CreateTensor(input_spec);
+    auto output_t = graph->CreateTensor(output_spec);
+
+    auto add = graph->CreateOperation<tim::vx::ops::Add>();
+    (*add).BindInputs({input_t0, input_t1}).BindOutputs({output_t});
+
+    std::vector<char> nbg_buf;
+    tim::vx::VectorBinarySink sink(nbg_buf);
+    EXPECT_TRUE(graph->CompileToBinary(sink));
+    EXPECT_FALSE(nbg_buf.empty());
+
+    // a region smaller than the binary is rejected
+    std::vector<char> small_buf(1);
+    tim::vx::MemoryBinarySink small_sink(small_buf.data(), small_buf.size());
+    EXPECT_FALSE(graph->CompileToBinary(small_sink));
+
+    auto nbg_graph = ctx->CreateGraph();
+    auto nbg_in0 = nbg_graph->CreateTensor(input_spec);
+    auto nbg_in1 = nbg_graph->CreateTensor(input_spec);
+    auto nbg_out = nbg_graph->CreateTensor(output_spec);
+
+    float in = 1.0f;
+    float expected_out = 2.0f;
+    EXPECT_TRUE(nbg_in0->CopyDataToTensor(&in, sizeof(in)));
+    EXPECT_TRUE(nbg_in1->CopyDataToTensor(&in, sizeof(in)));
+
+    auto nbg_node = nbg_graph->CreateOperation<tim::vx::ops::NBG>(
+        (nbg_buf.data()), /*num_of_input*/ 2,
+        /*num_of_output*/ 1);
+    (*nbg_node).BindInputs({nbg_in0, nbg_in1}).BindOutputs({nbg_out});
+    EXPECT_TRUE(nbg_graph->Run());
+
+    float output = 0.0f;
+    EXPECT_TRUE(nbg_out->CopyDataFromTensor(&output));
+    EXPECT_EQ(output, expected_out);
+}
+
+TEST(graph, gen_binary_graph_to_file) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType io_shape({1,1,1,1});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    auto input_t0 = graph->CreateTensor(input_spec);
+    auto input_t1 = graph->CreateTensor(input_spec);
+    auto output_t = graph->CreateTensor(output_spec);
+    graph->CreateOperation<tim::vx::ops::Add>()->BindInputs({input_t0, input_t1}).BindOutputs({output_t});
+
+    char path[] = "/tmp/tim_vx_nbg_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    unlink(path);
+    // The binary goes after a header, at an offset that isn't page aligned
+    const char header[] = "nbg";
+    ASSERT_EQ(write(fd, header, sizeof(header)), static_cast<ssize_t>(sizeof(header)));
+    {
+        tim::vx::FileBinarySink sink(fd, sizeof(header));
+        EXPECT_TRUE(graph->CompileToBinary(sink));
+    }
+    off_t file_size = lseek(fd, 0, SEEK_END);
+    ASSERT_GT(file_size, static_cast<off_t>(sizeof(header)));
+    std::vector<char> file(file_size);
+    ASSERT_EQ(pread(fd, file.data(), file.size(), 0), static_cast<ssize_t>(file.size()));
+    close(fd);
+    EXPECT_EQ(0, memcmp(file.data(), header, sizeof(header)));
+
+    auto nbg_graph = ctx->CreateGraph();
+    auto nbg_in0 = nbg_graph->CreateTensor(input_spec);
+    auto nbg_in1 = nbg_graph->CreateTensor(input_spec);
+    auto nbg_out = nbg_graph->CreateTensor(output_spec);
+    auto nbg_node = nbg_graph->CreateOperation<tim::vx::ops::NBG>(
+        file.data() + sizeof(header), /*num_of_input*/ 2,
+        /*num_of_output*/ 1);
+    (*nbg_node).BindInputs({nbg_in0, nbg_in1}).BindOutputs({nbg_out});
+
+    float in = 1.0f;
+    EXPECT_TRUE(nbg_in0->CopyDataToTensor(&in, sizeof(in)));
+    EXPECT_TRUE(nbg_in1->CopyDataToTensor(&in, sizeof(in)));
+    EXPECT_TRUE(nbg_graph->Run());
+    float output = 0.0f;
+    EXPECT_TRUE(nbg_out->CopyDataFromTensor(&output));
+    EXPECT_EQ(output, 2.0f);
+}
+
+TEST(graph, run_async_overlap_preprocess) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType io_shape({64, 64});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    auto input_t = graph->CreateTensor(input_spec);
+    auto output_t = graph->CreateTensor(output_spec);
+    graph->CreateOperation<tim::vx::ops::Relu>()->BindInput(input_t).BindOutput(output_t);
+    ASSERT_TRUE(graph->Compile());
+
+    const size_t num = 64 * 64;
+    const int requests = 4;
+    // request r feeds (i - num / 2) * (r + 1), relu keeps the positive half
+    auto preprocess = [num](int r, std::vector<float>& data) {
+        data.resize(num);
+        for (size_t i = 0; i < num; ++i) {
+            data[i] = (static_cast<float>(i) - num / 2) * (r + 1);
+        }
+    };
+
+    std::vector<float> current, next;
+    preprocess(0, current);
+    for (int r = 0; r < requests; ++r) {
+        EXPECT_TRUE(input_t->CopyDataToTensor(current.data(), num * sizeof(float)));
+        auto done = graph->RunAsync();
+        // prepare the next request on the CPU while the device executes
+        if (r + 1 < requests) {
+            preprocess(r + 1, next);
+        }
+        ASSERT_TRUE(done.get());
+
+        std::vector<float> output(num);
+        EXPECT_TRUE(output_t->CopyDataFromTensor(output.data()));
+        for (size_t i = 0; i < num; ++i) {
+            EXPECT_EQ(output[i], std::max(current[i], 0.0f));
+        }
+        std::swap(current, next);
+    }
+
+    // a dropped future is waited for by the next run
+    EXPECT_TRUE(input_t->CopyDataToTensor(current.data(), num * sizeof(float)));
+    graph->RunAsync();
+    EXPECT_TRUE(graph->Run());
+}
+
+#ifdef ENABLE_TENSOR_CACHE
+TEST(graph, constant_tensor_cache_full_content) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    // same first 512 bytes, different tail
+    std::vector<float> weight0(1024, 1.0f);
+    std::vector<float> weight1(weight0);
+    weight1.back() = 2.0f;
+    std::vector<float> weight2(weight0);
+
+    tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, {1024},
+                                   tim::vx::TensorAttribute::CONSTANT);
+    auto t0 = graph->CreateTensor(const_spec, weight0.data());
+    auto t1 = graph->CreateTensor(const_spec, weight1.data());
+    auto t2 = graph->CreateTensor(const_spec, weight2.data());
+    EXPECT_NE(t0, t1);
+    EXPECT_EQ(t0, t2);
+
+    // low-level tensors are graph local, another graph gets its own copy
+    auto other = ctx->CreateGraph();
+    auto t3 = other->CreateTensor(const_spec, weight0.data());
+    EXPECT_NE(t0, t3);
+    EXPECT_EQ(t3, other->CreateTensor(const_spec, weight2.data()));
+}
+#endif
+
+TEST(graph, producer_consumer_lookup) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+
+    tim::vx::ShapeType io_shape({2,2});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec transient_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::TRANSIENT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    auto input_t = graph->CreateTensor(input_spec);
+    auto mid_t = graph->CreateTensor(transient_spec);
+    auto output_t0 = graph->CreateTensor(output_spec);
+    auto output_t1 = graph->CreateTensor(output_spec);
+
+    auto relu = graph->CreateOperation<tim::vx::ops::Relu>();
+    (*relu).BindInput(input_t).BindOutput(mid_t);
+    auto add = graph->CreateOperation<tim::vx::ops::Add>();
+    (*add).BindInputs({mid_t, input_t}).BindOutput(output_t0);
+    auto neg = graph->CreateOperation<tim::vx::ops::Neg>();
+    (*neg).BindInput(mid_t).BindOutput(output_t1);
+
+    EXPECT_EQ(graph->GetProducerOp(input_t), nullptr);
+    EXPECT_EQ(graph->GetProducerOp(mid_t), relu);
+    EXPECT_EQ(graph->GetProducerOp(output_t0), add);
+    EXPECT_EQ(graph->GetProducerOp(output_t1), neg);
+
+    auto mid_consumers = graph->GetConsumersOp(mid_t);
+    ASSERT_EQ(mid_consumers.size(), 2u);
+    EXPECT_EQ(mid_consumers[0], add);
+    EXPECT_EQ(mid_consumers[1], neg);
+    EXPECT_EQ(graph->GetConsumersOp(input_t).size(), 2u);
+    EXPECT_TRUE(graph->GetConsumersOp(output_t0).empty());
+
+    // Edits through the exported maps are seen by later lookups
+    auto& consumers = graph->TensorConsumer();
+    auto& producer = graph->TensorProducer();
+    EXPECT_EQ(consumers[mid_t].size(), 2u);
+    EXPECT_EQ(producer[output_t1], neg);
+    consumers.erase(mid_t);
+    EXPECT_TRUE(graph->GetConsumersOp(mid_t).empty());
+    auto relu1 = graph->CreateOperation<tim::vx::ops::Relu>();
+    (*relu1).BindInput(output_t0).BindOutput(mid_t);
+    EXPECT_EQ(consumers[output_t0].size(), 1u);
+    EXPECT_EQ(graph->GetProducerOp(mid_t), relu1);
+}
+
+class GraphCompileCache : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        char cache_dir[] = "/tmp/tim_vx_compile_cache_XXXXXX";
+        ASSERT_NE(mkdtemp(cache_dir), nullptr);
+        cache_dir_ = cache_dir;
+    }
+
+    void TearDown() override {
+        if (cache_dir_.empty()) return;
+        if (DIR* dir = opendir(cache_dir_.c_str())) {
+            while (struct dirent* ent = readdir(dir)) {
+                std::string name(ent->d_name);
+                if ("." == name || ".." == name) continue;
+                unlink((cache_dir_ + "/" + name).c_str());
+            }
+            closedir(dir);
+        }
+        rmdir(cache_dir_.c_str());
+    }
+
+    std::string cache_dir_;
+};
+
+TEST_F(GraphCompileCache, hit) {
+    tim::vx::CompileOption opt;
+    opt.setCacheDir(cache_dir_);
+    tim::vx::ResetCompileCacheStats();
+
+    tim::vx::ShapeType io_shape({2,2});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    std::vector<float> in = {1.0f, -2.0f, 3.0f, -4.0f};
+    std::vector<float> expected_out = {2.0f, 0.0f, 6.0f, 0.0f};
+
+    auto ctx = tim::vx::Context::Create();
+    auto build_and_run = [&]() {
+        auto graph = ctx->CreateGraph(opt);
+        auto input_t = graph->CreateTensor(input_spec);
+        auto mid_t = graph->CreateTensor(input_spec.AsTransientSpec());
+        auto output_t = graph->CreateTensor(output_spec);
+        graph->CreateOperation<tim::vx::ops::Relu>()->BindInput(input_t).BindOutput(mid_t);
+        graph->CreateOperation<tim::vx::ops::Add>()->BindInputs({mid_t, mid_t}).BindOutput(output_t);
+
+        EXPECT_TRUE(input_t->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+        EXPECT_TRUE(graph->Compile());
+        EXPECT_TRUE(graph->Run());
+        std::vector<float> output(in.size());
+        EXPECT_TRUE(output_t->CopyDataFromTensor(output.data()));
+        EXPECT_EQ(output, expected_out);
+    };
+
+    build_and_run();
+    auto stats = tim::vx::GetCompileCacheStats();
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.stores, 1u);
+
+    // Same graph built again is served from the cache
+    build_and_run();
+    stats = tim::vx::GetCompileCacheStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.stores, 1u);
+}
+
+TEST_F(GraphCompileCache, concurrent_store_same_key) {
+    constexpr size_t kWriters = 8;
+    constexpr size_t kPayload = 1 << 20;
+    tim::vx::CompiledGraphCache cache(cache_dir_, 0);
+    std::vector<std::thread> writers;
+    for (size_t i = 0; i < kWriters; ++i) {
+        writers.emplace_back([&cache, i]() {
+            std::vector<char> nbg(kPayload, static_cast<char>('a' + i));
+            EXPECT_TRUE(cache.Store("same_key", nbg));
+        });
+    }
+    for (auto& writer : writers) writer.join();
+
+    // The entry is one writer's payload, not a mix of several
+    std::vector<char> nbg;
+    ASSERT_TRUE(cache.Load("same_key", nbg));
+    ASSERT_EQ(nbg.size(), kPayload);
+    EXPECT_EQ(std::count(nbg.begin(), nbg.end(), nbg[0]),
+              static_cast<std::ptrdiff_t>(kPayload));
+
+    // No temporary file is left behind
+    size_t files = 0;
+    if (DIR* dir = opendir(cache_dir_.c_str())) {
+        while (struct dirent* ent = readdir(dir)) {
+            std::string name(ent->d_name);
+            if ("." != name && ".." != name) files++;
+        }
+        closedir(dir);
+    }
+    EXPECT_EQ(files, 1u);
+}
+
+TEST(graph, batch_split_report) {
+    tim::vx::CompileOption opt;
+    opt.setBatchSplit(true);
+    opt.setMaxBatchSplit(2);
+
+    // WHCN with batch 4
+    tim::vx::ShapeType io_shape({2,2,1,4});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    std::vector<float> in(16);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<float>(i % 3) - 1.0f;
+    }
+
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph(opt);
+    auto input_t = graph->CreateTensor(input_spec);
+    auto output_t = graph->CreateTensor(output_spec);
+    auto relu = graph->CreateOperation<tim::vx::ops::Relu>();
+    relu->BindInput(input_t).BindOutput(output_t);
+
+    EXPECT_TRUE(input_t->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+    EXPECT_TRUE(graph->Compile());
+    EXPECT_TRUE(graph->Run());
+    std::vector<float> output(in.size());
+    EXPECT_TRUE(output_t->CopyDataFromTensor(output.data()));
+    for (size_t i = 0; i < in.size(); ++i) {
+        EXPECT_EQ(output[i], std::max(in[i], 0.0f));
+    }
+
+    auto report = graph->GetBatchSplitReport();
+    EXPECT_TRUE(report.enabled);
+    EXPECT_GE(report.node_count, 1u);
+    if (!report.supported) {
+        EXPECT_TRUE(report.split_nodes.empty());
+    }
+    for (const auto& node : report.split_nodes) {
+        EXPECT_EQ(node.op, relu.get());
+        EXPECT_GT(node.split, 1u);
+        EXPECT_LE(node.split, 2u);
+    }
+}
+
+TEST(graph, borrowed_constant_tensor) {
+    // Weights live in an mmapped file, as in a model loaded from disk
+    std::vector<float> weight = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    char path[] = "/tmp/tim_vx_weight_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    size_t bytes = weight.size() * sizeof(float);
+    ASSERT_EQ(write(fd, weight.data(), bytes), static_cast<ssize_t>(bytes));
+    void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    unlink(path);
+    ASSERT_NE(mapped, MAP_FAILED);
+
+    int released = 0;
+    auto unmap = [&](const void* data) {
+        munmap(const_cast<void*>(data), bytes);
+        released++;
+    };
+
+    tim::vx::ShapeType io_shape({4});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::CONSTANT);
+    std::vector<float> in = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    auto ctx = tim::vx::Context::Create();
+    {
+        auto graph = ctx->CreateGraph();
+        auto input_t = graph->CreateTensor(input_spec);
+        auto output_t0 = graph->CreateTensor(output_spec);
+        auto borrowed_t = graph->CreateTensor(const_spec, tim::vx::BorrowedBufferDesc{mapped, unmap});
+        EXPECT_FALSE(borrowed_t->CopyDataToTensor(in.data()));
+        graph->CreateOperation<tim::vx::ops::Add>()->BindInputs({input_t, borrowed_t}).BindOutput(output_t0);
+
+        EXPECT_TRUE(input_t->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+        EXPECT_TRUE(graph->Compile());
+        EXPECT_TRUE(graph->Run());
+        std::vector<float> output(in.size());
+        EXPECT_TRUE(output_t0->CopyDataFromTensor(output.data()));
+        EXPECT_EQ(output, std::vector<float>({2.0f, 3.0f, 4.0f, 5.0f}));
+        EXPECT_EQ(released, 0);
+    }
+    // Released once both the tensor and its graph are gone
+    EXPECT_EQ(released, 1);
+}
+
+TEST(graph, borrowed_misaligned_constant_tensor) {
+    tim::vx::ShapeType io_shape({4});
+    tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::INPUT);
+    tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::OUTPUT);
+    tim::vx::TensorSpec const_spec(tim::vx::DataType::FLOAT32, io_shape, tim::vx::TensorAttribute::CONSTANT);
+    std::vector<float> in = {1.0f, 1.0f, 1.0f, 1.0f};
+    // One float past a vector's start never meets the handle alignment
+    std::vector<float> weight = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    std::vector<float> expected(weight.begin() + 1, weight.end());
+
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+    auto input_t = graph->CreateTensor(input_spec);
+    auto output_t = graph->CreateTensor(output_spec);
+    // The buffer is copied and handed back right away, the release poisons
+    // it so anything still pointing at it shows in the results
+    int released = 0;
+    auto const_t = graph->CreateTensor(
+        const_spec, tim::vx::BorrowedBufferDesc{
+                        weight.data() + 1, [&](const void*) {
+                            memset(weight.data(), 0xff,
+                                   weight.size() * sizeof(float));
+                            released++;
+                        }});
+    EXPECT_EQ(released, 1);
+
+    std::vector<float> readback(expected.size());
+    EXPECT_TRUE(const_t->CopyDataFromTensor(readback.data()));
+    EXPECT_EQ(readback, expected);
+
+    graph->CreateOperation<tim::vx::ops::Add>()->BindInputs({input_t, const_t}).BindOutput(output_t);
+    EXPECT_TRUE(input_t->CopyDataToTensor(in.data(), in.size() * sizeof(float)));
+    EXPECT_TRUE(graph->Compile());
+    EXPECT_TRUE(graph->Run());
+    std::vector<float> output(in.size());
+    EXPECT_TRUE(output_t->CopyDataFromTensor(output.data()));
+    EXPECT_EQ(output, std::vector<float>({3.0f, 4.0f, 5.0f, 6.0f}));
+    EXPECT_EQ(released, 1);
+}
+
 // You can disable compile trace_test if only need replay
 // #undef ENABLE_API_TRACE
 #ifdef ENABLE_API_TRACE
@@ -0,0 +1,83 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "hash_utils.h"
+
+#include <cstring>
+
+namespace tim {
+namespace vx {
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed) {
+  const uint64_t m = 0xc6a4a7935bd1e995ULL;
+  const int r = 47;
+  uint64_t h = seed ^ (size * m);
+
+  auto bytes = static_cast<const uint8_t*>(data);
+  const size_t blocks = size / 8;
+  for (size_t i = 0; i < blocks; ++i) {
+    uint64_t k;
+    memcpy(&k, bytes + i * 8, sizeof(k));
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+  }
+
+  const uint8_t* tail = bytes + blocks * 8;
+  switch (size & 7) {
+    case 7:
+      h ^= uint64_t(tail[6]) << 48;
+      // fall through
+    case 6:
+      h ^= uint64_t(tail[5]) << 40;
+      // fall through
+    case 5:
+      h ^= uint64_t(tail[4]) << 32;
+      // fall through
+    case 4:
+      h ^= uint64_t(tail[3]) << 24;
+      // fall through
+    case 3:
+      h ^= uint64_t(tail[2]) << 16;
+      // fall through
+    case 2:
+      h ^= uint64_t(tail[1]) << 8;
+      // fall through
+    case 1:
+      h ^= uint64_t(tail[0]);
+      h *= m;
+      break;
+    default:
+      break;
+  }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+}  // namespace vx
+}  // namespace tim
@@ -0,0 +1,82 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef _VSI_NN_ID_TABLE_H
+#define _VSI_NN_ID_TABLE_H
+
+#include <stdint.h>
+#include "vsi_nn_types.h"
+
+#if defined(__cplusplus)
+extern "C"{
+#endif
+
+/**
+ * Dense table indexed by tensor or node id.
+ * Ids are handed out sequentially by the graph, so a flat array gives
+ * O(1) lookup and amortized O(1) insertion. Removed slots are set to NULL.
+ */
+typedef struct _vsi_nn_id_table
+{
+    /** Slot array, indexed by id */
+    void    ** items;
+    /** Number of allocated slots */
+    uint32_t   capacity;
+    /** Number of non-NULL slots */
+    uint32_t   size;
+} VSI_PUBLIC_TYPE vsi_nn_id_table_t;
+
+OVXLIB_API void vsi_nn_IdTableInit
+    (
+    vsi_nn_id_table_t * table
+    );
+
+OVXLIB_API void vsi_nn_IdTableDeinit
+    (
+    vsi_nn_id_table_t * table
+    );
+
+OVXLIB_API void * vsi_nn_IdTableGet
+    (
+    const vsi_nn_id_table_t * table,
+    uint32_t                  id
+    );
+
+OVXLIB_API vsi_bool vsi_nn_IdTableAdd
+    (
+    vsi_nn_id_table_t * table,
+    uint32_t            id,
+    void              * value
+    );
+
+OVXLIB_API void vsi_nn_IdTableRemove
+    (
+    vsi_nn_id_table_t * table,
+    uint32_t            id
+    );
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -34,6 +34,7 @@
 #include "vsi_nn_types.h"
 #include "vsi_nn_rnn.h"
 #include "utils/vsi_nn_map.h"
+#include "utils/vsi_nn_id_table.h"
 
 /**
  * Default max node input or output tensors' number.
@@ -85,8 +86,8 @@ struct VSI_PUBLIC_TYPE _vsi_nn_graph
     {
     /** @deprecated Never use tensors. */
     vsi_nn_tensor_t ** tensors;
-    /** Tensor table */
-    vsi_nn_map_t     * tensor_table;
+    /** Tensor table, indexed by tensor id */
+    vsi_nn_id_table_t * tensor_table;
     };
     union
     {
@@ -102,8 +103,8 @@ struct VSI_PUBLIC_TYPE _vsi_nn_graph
     {
     /** @deprecated: Never use nodes. */
     vsi_nn_node_t   ** nodes;
-    /** Node table */
-    vsi_nn_map_t     * node_table;
+    /** Node table, indexed by node id */
+    vsi_nn_id_table_t * node_table;
     };
     union
     {
@@ -800,6 +801,22 @@ OVXLIB_API vsi_bool vsi_nn_IsGraphFastMode
     const vsi_nn_graph_t* graph
     );
 
+/**
+ * Set batch split limit
+ * Limit how many parts a node is split into on batch dim when
+ * VSI_VX_ENABLE_BATCH_OPT is on.
+ *
+ * @param[in] graph Graph handle
+ * @param[in] limit Max split number, 0 means the core count of the device
+ * @return VSI_SUCCESS on success, or VSI_FAILURE if the driver doesn't
+ *         support batch split
+ */
+OVXLIB_API vsi_status vsi_nn_SetGraphBatchSplitLimit
+    (
+    vsi_nn_graph_t* graph,
+    uint32_t limit
+    );
+
 OVXLIB_API vsi_status vsi_nn_CopyTensorViaGraphs
     (
     vsi_nn_graph_t *src_graph,
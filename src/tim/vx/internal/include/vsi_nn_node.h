@@ -169,6 +169,18 @@ OVXLIB_API vsi_status vsi_nn_SetNodeBatchSplitNum
     vsi_nn_node_t* node,
     int8_t split_num
 );
+
+/**
+ * Get how much this node is divided into on batch dim.
+ *
+ * @param[in] node Node.
+ *
+ * @return Split number of the node, 0 if it is not decided yet.
+ */
+OVXLIB_API vsi_size_t vsi_nn_GetNodeBatchSplitNum
+(
+    vsi_nn_node_t* node
+);
 #endif
 
 /**
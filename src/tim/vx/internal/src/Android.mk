@@ -40,6 +40,7 @@ LOCAL_SRC_FILES +=      \
              utils/vsi_nn_code_generator.c   \
              utils/vsi_nn_binary_tree.c   \
              utils/vsi_nn_map.c   \
+             utils/vsi_nn_id_table.c   \
              utils/vsi_nn_hashmap.c   \
              utils/vsi_nn_link_list.c   \
              utils/vsi_nn_math.c   \
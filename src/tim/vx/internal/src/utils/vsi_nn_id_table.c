@@ -0,0 +1,154 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include "utils/vsi_nn_id_table.h"
+#include "vsi_nn_log.h"
+#include "vsi_nn_types.h"
+
+#define _ID_TABLE_MIN_CAPACITY    (64)
+
+static vsi_bool _id_table_reserve
+    (
+    vsi_nn_id_table_t * table,
+    uint32_t            id
+    )
+{
+    uint32_t capacity;
+    void ** items;
+
+    if( id < table->capacity )
+    {
+        return TRUE;
+    }
+    if( id >= UINT32_MAX - 1 )
+    {
+        /* Keep the top two ids free, they are reserved as NA/AUTO markers. */
+        VSILOGE( "Invalid id %u.", id );
+        return FALSE;
+    }
+    capacity = table->capacity > 0 ? table->capacity : _ID_TABLE_MIN_CAPACITY;
+    while( capacity <= id )
+    {
+        if( capacity > UINT32_MAX / 2 )
+        {
+            capacity = id + 1;
+            break;
+        }
+        capacity *= 2;
+    }
+    items = (void **)realloc( table->items, capacity * sizeof( void * ) );
+    if( NULL == items )
+    {
+        VSILOGE( "Grow id table to %u fail.", capacity );
+        return FALSE;
+    }
+    memset( &items[table->capacity], 0,
+        ( capacity - table->capacity ) * sizeof( void * ) );
+    table->items = items;
+    table->capacity = capacity;
+    return TRUE;
+} /* _id_table_reserve() */
+
+void vsi_nn_IdTableInit
+    (
+    vsi_nn_id_table_t * table
+    )
+{
+    if( NULL == table )
+    {
+        return;
+    }
+    memset( table, 0, sizeof( vsi_nn_id_table_t ) );
+} /* vsi_nn_IdTableInit() */
+
+void vsi_nn_IdTableDeinit
+    (
+    vsi_nn_id_table_t * table
+    )
+{
+    if( NULL == table )
+    {
+        return;
+    }
+    if( NULL != table->items )
+    {
+        free( table->items );
+    }
+    memset( table, 0, sizeof( vsi_nn_id_table_t ) );
+} /* vsi_nn_IdTableDeinit() */
+
+void * vsi_nn_IdTableGet
+    (
+    const vsi_nn_id_table_t * table,
+    uint32_t                  id
+    )
+{
+    if( NULL == table || id >= table->capacity )
+    {
+        return NULL;
+    }
+    return table->items[id];
+} /* vsi_nn_IdTableGet() */
+
+vsi_bool vsi_nn_IdTableAdd
+    (
+    vsi_nn_id_table_t * table,
+    uint32_t            id,
+    void              * value
+    )
+{
+    if( NULL == table || FALSE == _id_table_reserve( table, id ) )
+    {
+        return FALSE;
+    }
+    if( NULL == table->items[id] && NULL != value )
+    {
+        table->size += 1;
+    }
+    else if( NULL != table->items[id] && NULL == value )
+    {
+        table->size -= 1;
+    }
+    table->items[id] = value;
+    return TRUE;
+} /* vsi_nn_IdTableAdd() */
+
+void vsi_nn_IdTableRemove
+    (
+    vsi_nn_id_table_t * table,
+    uint32_t            id
+    )
+{
+    if( NULL == table || id >= table->capacity )
+    {
+        return;
+    }
+    if( NULL != table->items[id] )
+    {
+        table->items[id] = NULL;
+        table->size -= 1;
+    }
+} /* vsi_nn_IdTableRemove() */
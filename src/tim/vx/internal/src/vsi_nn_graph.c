@@ -38,6 +38,7 @@
 #include "vsi_nn_version.h"
 #include "utils/vsi_nn_util.h"
 #include "utils/vsi_nn_map.h"
+#include "utils/vsi_nn_id_table.h"
 #include "utils/vsi_nn_dtype_util.h"
 #include "vsi_nn_graph_optimization.h"
 #include "vsi_nn_error.h"
@@ -766,6 +767,7 @@ static vsi_status batchInference_graph
     vsi_size_t num_of_node_inputs = 0;
     vsi_size_t batchCount = 0;
     vsi_size_t batchNum = 1;
+    vsi_size_t batchLimit = 0;
 
     vx_hardware_caps_params_t   hw_param;
     vx_context  ctx = vxGetContext((vx_reference)graph->g);
@@ -784,6 +786,13 @@ static vsi_status batchInference_graph
 
     memset(&hw_param, 0, sizeof(vx_hardware_caps_params_t));
     status = vxQueryHardwareCaps(ctx, &hw_param, sizeof(vx_hardware_caps_params_t));
+    /*for some node with big batch num, should limit to max core count.*/
+    batchLimit = hw_param.coreCount == 0 ? 24 : hw_param.coreCount;
+    if (((vsi_nn_graph_prv_t*)graph)->batch_split_limit > 0 &&
+        ((vsi_nn_graph_prv_t*)graph)->batch_split_limit < batchLimit)
+    {
+        batchLimit = ((vsi_nn_graph_prv_t*)graph)->batch_split_limit;
+    }
 
     /*initial tensor shape*/
     status = setup_node(graph, nodes_list);
@@ -895,8 +904,7 @@ static vsi_status batchInference_graph
             for (batchCount = batchNum; batchCount > 1; batchCount--)
             {
 
-                /*for some node with big batch num, should limit to max core count.*/
-                if (batchCount > (hw_param.coreCount == 0?24 : hw_param.coreCount))
+                if (batchCount > batchLimit)
                 {
                     continue;
                 }
@@ -1357,11 +1365,11 @@ vsi_nn_graph_t * vsi_nn_CreateGraph
             ((vsi_nn_graph_prv_t*) graph)->options =
                 (vsi_nn_runtime_option_t *)malloc( sizeof( vsi_nn_runtime_option_t ));
             CHECK_PTR_FAIL_GOTO(((vsi_nn_graph_prv_t*) graph)->options, "Create graph options fail.", error);
-            graph->node_table = (vsi_nn_map_t *)malloc( sizeof( vsi_nn_map_t ) );
-            graph->tensor_table = (vsi_nn_map_t *)malloc( sizeof( vsi_nn_map_t ) );
+            graph->node_table = (vsi_nn_id_table_t *)malloc( sizeof( vsi_nn_id_table_t ) );
+            graph->tensor_table = (vsi_nn_id_table_t *)malloc( sizeof( vsi_nn_id_table_t ) );
             graph->isAllowFastMode = TRUE;
-            vsi_nn_MapInit( graph->node_table );
-            vsi_nn_MapInit( graph->tensor_table );
+            vsi_nn_IdTableInit( graph->node_table );
+            vsi_nn_IdTableInit( graph->tensor_table );
             vsi_nn_initOptions_runtime( ((vsi_nn_graph_prv_t*) graph)->options, ctx );
         }
         else
@@ -1394,6 +1402,7 @@ void vsi_nn_ReleaseGraph
             {
                 vsi_nn_RemoveNode( *graph, (vsi_nn_node_id_t)i );
             }
+            vsi_nn_IdTableDeinit( (*graph)->node_table );
             free( (*graph)->node_table );
         }
         if( NULL != ptr->g )
@@ -1406,6 +1415,7 @@ void vsi_nn_ReleaseGraph
             {
                 vsi_nn_RemoveTensor( *graph, (vsi_nn_tensor_id_t)i );
             }
+            vsi_nn_IdTableDeinit( (*graph)->tensor_table );
             free( (*graph)->tensor_table );
         }
         if( ptr->complete_signal.exists
@@ -1788,8 +1798,12 @@ static vsi_nn_tensor_id_t _add_tensor
 
     if( NULL != tensor )
     {
-        vsi_nn_MapAdd( graph->tensor_table, (vsi_nn_map_key_t)id, (void *)tensor );
-        graph->cur_tid ++;
+        vsi_nn_IdTableAdd( graph->tensor_table, id, (void *)tensor );
+        /* Explicit ids may skip ahead, keep cur_tid past the largest one. */
+        if( id >= graph->cur_tid )
+        {
+            graph->cur_tid = id + 1;
+        }
     }
     else
     {
@@ -1912,8 +1926,11 @@ vsi_nn_tensor_id_t vsi_nn_AttachTensorToGraph
         id = graph->cur_tid;
         graph->tensor_num = graph->cur_tid;
     }
-    graph->cur_tid ++;
-    vsi_nn_MapAdd( graph->tensor_table, (vsi_nn_map_key_t)id, (void *)tensor );
+    if( id >= graph->cur_tid )
+    {
+        graph->cur_tid = id + 1;
+    }
+    vsi_nn_IdTableAdd( graph->tensor_table, id, (void *)tensor );
     return id;
 } /* vsi_nn_AttachTensorToGraph() */
 
@@ -1942,8 +1959,7 @@ void vsi_nn_RemoveTensor
         if( NULL != tensor )
         {
             vsi_nn_ReleaseTensor( &tensor );
-            vsi_nn_MapRemove( graph->tensor_table,
-                    (vsi_nn_map_key_t)id );
+            vsi_nn_IdTableRemove( graph->tensor_table, id );
         }
     }
 } /* vsi_nn_RemoveTensor() */
@@ -1958,7 +1974,7 @@ vsi_nn_tensor_t * vsi_nn_GetTensor
     tensor = NULL;
     if( NULL != graph )
     {
-        tensor = vsi_nn_MapGet( graph->tensor_table, (vsi_nn_map_key_t)id );
+        tensor = (vsi_nn_tensor_t *)vsi_nn_IdTableGet( graph->tensor_table, id );
     }
     return tensor;
 } /* vsi_nn_GetTensor() */
@@ -1973,7 +1989,7 @@ vsi_nn_node_t * vsi_nn_GetNode
     node = NULL;
     if( NULL != graph )
     {
-        node = vsi_nn_MapGet( graph->node_table, (vsi_nn_map_key_t)id );
+        node = (vsi_nn_node_t *)vsi_nn_IdTableGet( graph->node_table, id );
     }
     return node;
 } /* vsi_nn_GetNode() */
@@ -2036,7 +2052,7 @@ vsi_nn_node_t * vsi_nn_AddNode
     node = vsi_nn_NewNode(graph, op, input_num, output_num);
     if( NULL != node )
     {
-        vsi_nn_MapAdd( graph->node_table, (vsi_nn_map_key_t)id, (void *)node );
+        vsi_nn_IdTableAdd( graph->node_table, id, (void *)node );
         graph->cur_nid ++;
         graph->node_num = graph->cur_nid;
     }
@@ -2132,7 +2148,7 @@ vsi_nn_node_t * vsi_nn_AddExternalNode
     }
     id = graph->cur_nid;
     if(NULL != node){
-        vsi_nn_MapAdd( graph->node_table, (vsi_nn_map_key_t)id, (void *)node );
+        vsi_nn_IdTableAdd( graph->node_table, id, (void *)node );
         graph->node_num = graph->cur_nid;
         graph->cur_nid ++;
     }
@@ -2153,8 +2169,7 @@ void vsi_nn_RemoveNode
         if( NULL != node )
         {
             vsi_nn_ReleaseNode( &node );
-            vsi_nn_MapRemove( graph->node_table,
-                    (vsi_nn_map_key_t)id );
+            vsi_nn_IdTableRemove( graph->node_table, id );
         }
     }
 } /* vsi_nn_RemoveNode() */
@@ -3242,6 +3257,26 @@ vsi_bool vsi_nn_IsGraphFastMode
     return NULL == graph ? FALSE : graph->isAllowFastMode;
 }
 
+vsi_status vsi_nn_SetGraphBatchSplitLimit
+    (
+    vsi_nn_graph_t* graph,
+    uint32_t limit
+    )
+{
+    vsi_status status = VSI_FAILURE;
+#if VX_GRAPH_BATCH_OPT_SUPPORT
+    if (graph)
+    {
+        ((vsi_nn_graph_prv_t*)graph)->batch_split_limit = limit;
+        status = VSI_SUCCESS;
+    }
+#else
+    VSI_UNREFERENCED(graph);
+    VSI_UNREFERENCED(limit);
+#endif
+    return status;
+}
+
 vsi_status vsi_nn_CopyTensorViaGraphs
     (
     vsi_nn_graph_t *src_graph,
@@ -263,6 +263,18 @@ vsi_status vsi_nn_SetNodeBatchSplitNum
     final:
     return status;
 }
+
+vsi_size_t vsi_nn_GetNodeBatchSplitNum
+(
+    vsi_nn_node_t* node
+)
+{
+    if (node == NULL)
+    {
+        return 0;
+    }
+    return ((vsi_nn_node_prv_t*)node)->split_num;
+}
 #endif
 
 vsi_status vsi_nn_update_node_attr
@@ -59,6 +59,10 @@ typedef struct _vsi_nn_graph_prv
     // Add graph internal attribute here...
     vsi_nn_swap_handle_cache_t swap_handle_cache;
     vsi_nn_runtime_option_t* options;
+#if VX_GRAPH_BATCH_OPT_SUPPORT
+    /* max number of parts a node is split into on batch dim, 0: core count */
+    vsi_size_t batch_split_limit;
+#endif
 } vsi_nn_graph_prv_t;
 
 /** Internal Node structure, internal use only. */
@@ -0,0 +1,272 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "dispatcher_private.h"
+
+#include <algorithm>
+
+#include "tim/vx/graph.h"
+#include "tim/vx/tensor.h"
+#include "vsi_nn_pub.h"
+
+namespace tim {
+namespace vx {
+namespace platform {
+
+std::shared_ptr<Dispatcher> Dispatcher::Create(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<std::shared_ptr<IExecutor>>& executors) {
+  auto dispatcher = std::make_shared<DispatcherImpl>(graph, executors);
+  if (!dispatcher->Init()) {
+    return nullptr;
+  }
+  return dispatcher;
+}
+
+DispatcherImpl::DispatcherImpl(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<std::shared_ptr<IExecutor>>& executors)
+    : graph_(graph), created_(Clock::now()) {
+  for (const auto& executor : executors) {
+    std::unique_ptr<Worker> worker(new Worker);
+    worker->executor = executor;
+    workers_.push_back(std::move(worker));
+  }
+}
+
+DispatcherImpl::~DispatcherImpl() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker->thread.joinable()) {
+      // A worker may drop the last reference to the dispatcher, it leaves
+      // its loop without touching the dispatcher again
+      if (worker->thread.get_id() == std::this_thread::get_id()) {
+        worker->thread.detach();
+      } else {
+        worker->thread.join();
+      }
+    }
+  }
+  // Requests the workers left behind can't run anymore
+  for (auto& worker : workers_) {
+    for (auto& request : worker->queue) {
+      if (request.done) {
+        request.done(false);
+      }
+    }
+  }
+}
+
+bool DispatcherImpl::Init() {
+  if (!graph_ || workers_.empty()) {
+    VSILOGE("Dispatcher needs a graph and at least one executor");
+    return false;
+  }
+  for (auto& worker : workers_) {
+    worker->executable = worker->executor->Compile(graph_);
+    if (!worker->executable) {
+      VSILOGE("Compile graph for executor failed");
+      return false;
+    }
+    for (const auto& input : graph_->InputsTensor()) {
+      worker->inputs.push_back(
+          worker->executable->AllocateTensor(input->GetSpec()));
+    }
+    for (const auto& output : graph_->OutputsTensor()) {
+      worker->outputs.push_back(
+          worker->executable->AllocateTensor(output->GetSpec()));
+    }
+    worker->executable->SetInputs(worker->inputs);
+    worker->executable->SetOutputs(worker->outputs);
+    if (!worker->executable->Verify()) {
+      VSILOGE("Executable NBG compile failed");
+      return false;
+    }
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->thread = std::thread(
+        &DispatcherImpl::WorkerLoop, this, i,
+        std::weak_ptr<DispatcherImpl>(shared_from_this()));
+  }
+  return true;
+}
+
+bool DispatcherImpl::Submit(const Request& request) {
+  const auto& inputs = workers_.front()->inputs;
+  const auto& outputs = workers_.front()->outputs;
+  if (request.inputs.size() != inputs.size() ||
+      request.input_bytes.size() != inputs.size() ||
+      request.outputs.size() != outputs.size()) {
+    VSILOGE("Request buffers don't match the graph inputs and outputs");
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+      return false;
+    }
+    Worker* target = workers_.front().get();
+    for (auto& worker : workers_) {
+      if (worker->queue.size() < target->queue.size()) {
+        target = worker.get();
+      }
+    }
+    target->queue.push_back(request);
+    ++submitted_;
+    max_queued_ = std::max(max_queued_, ++queued_);
+  }
+  // Idle workers which are not the target may steal the request
+  work_cv_.notify_all();
+  return true;
+}
+
+bool DispatcherImpl::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this]() { return 0 == queued_ && 0 == running_; });
+  bool status = status_;
+  status_ = true;
+  return status;
+}
+
+void DispatcherImpl::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+}
+
+Dispatcher::Stats DispatcherImpl::GetStats() const {
+  Stats stats;
+  auto lifetime_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                         Clock::now() - created_)
+                         .count();
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats.queue_depth = queued_;
+  stats.max_queue_depth = max_queued_;
+  stats.submitted = submitted_;
+  for (const auto& worker : workers_) {
+    auto executor_stats = worker->stats;
+    if (lifetime_us > 0) {
+      executor_stats.utilization =
+          static_cast<double>(executor_stats.busy_us) / lifetime_us;
+    }
+    stats.executors.push_back(executor_stats);
+  }
+  return stats;
+}
+
+Dispatcher::Request DispatcherImpl::Take(size_t index, bool& stolen) {
+  auto& own = workers_[index]->queue;
+  Request request;
+  stolen = own.empty();
+  if (!stolen) {
+    request = std::move(own.front());
+    own.pop_front();
+  } else {
+    Worker* victim = nullptr;
+    for (auto& worker : workers_) {
+      if (!victim || worker->queue.size() > victim->queue.size()) {
+        victim = worker.get();
+      }
+    }
+    request = std::move(victim->queue.back());
+    victim->queue.pop_back();
+  }
+  --queued_;
+  return request;
+}
+
+bool DispatcherImpl::Run(Worker& worker, const Request& request) {
+  for (size_t i = 0; i < worker.inputs.size(); ++i) {
+    if (!worker.inputs[i]->CopyDataToTensor(request.inputs[i],
+                                            request.input_bytes[i])) {
+      return false;
+    }
+  }
+  if (!worker.executable->Trigger()) {
+    return false;
+  }
+  for (size_t i = 0; i < worker.outputs.size(); ++i) {
+    if (!worker.outputs[i]->CopyDataFromTensor(request.outputs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DispatcherImpl::WorkerLoop(size_t index,
+                                std::weak_ptr<DispatcherImpl> self) {
+  auto& worker = *workers_[index];
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_cv_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+    if (0 == queued_) {
+      break;
+    }
+    bool stolen = false;
+    auto request = Take(index, stolen);
+    ++running_;
+    // Keeps the dispatcher alive while `done` drops references. Without it
+    // the destructor already runs elsewhere and joins this worker.
+    auto keep_alive = self.lock();
+    lock.unlock();
+
+    auto start = Clock::now();
+    bool status = Run(worker, request);
+    auto busy_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                       Clock::now() - start)
+                       .count();
+    // Run the callback before going idle so Wait() covers it
+    if (request.done) {
+      request.done(status);
+    }
+
+    lock.lock();
+    --running_;
+    status_ = status_ && status;
+    worker.stats.completed += status ? 1 : 0;
+    worker.stats.failed += status ? 0 : 1;
+    worker.stats.stolen += stolen ? 1 : 0;
+    worker.stats.busy_us += busy_us;
+    if (0 == queued_ && 0 == running_) {
+      idle_cv_.notify_all();
+    }
+    if (keep_alive) {
+      lock.unlock();
+      request = Request();
+      // May run the destructor on this thread, then this is gone
+      keep_alive.reset();
+      if (self.expired()) {
+        return;
+      }
+      lock.lock();
+    }
+  }
+}
+
+}  // namespace platform
+}  // namespace vx
+}  // namespace tim
@@ -0,0 +1,99 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_PLATFORM_DISPATCHER_PRIVATE_H_
+#define TIM_VX_PLATFORM_DISPATCHER_PRIVATE_H_
+#include "tim/vx/platform/dispatcher.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "tim/vx/platform/platform.h"
+
+namespace tim {
+namespace vx {
+namespace platform {
+
+class DispatcherImpl : public Dispatcher,
+                       public std::enable_shared_from_this<DispatcherImpl> {
+ public:
+  DispatcherImpl(const std::shared_ptr<Graph>& graph,
+                 const std::vector<std::shared_ptr<IExecutor>>& executors);
+  ~DispatcherImpl();
+
+  /// Compile the graph for every executor and start the workers, false on
+  /// failure
+  bool Init();
+
+  bool Submit(const Request& request) override;
+  bool Wait() override;
+  void Close() override;
+  Stats GetStats() const override;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Worker {
+    std::shared_ptr<IExecutor> executor;
+    std::shared_ptr<IExecutable> executable;
+    std::vector<std::shared_ptr<ITensorHandle>> inputs;
+    std::vector<std::shared_ptr<ITensorHandle>> outputs;
+    std::deque<Request> queue;
+    ExecutorStats stats;
+    std::thread thread;
+  };
+
+  void WorkerLoop(size_t index, std::weak_ptr<DispatcherImpl> self);
+  /// Pop the oldest request of worker `index` or steal the newest one of the
+  /// longest other queue. Called with mutex_ held and requests queued
+  Request Take(size_t index, bool& stolen);
+  /// Copy inputs in, run and copy outputs back on the calling thread
+  bool Run(Worker& worker, const Request& request);
+
+  std::shared_ptr<Graph> graph_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  Clock::time_point created_;
+
+  // One lock guards all queues, a request runs far longer than it is queued
+  mutable std::mutex mutex_;
+  /// Wakes workers on new requests or stop
+  std::condition_variable work_cv_;
+  /// Wakes Wait() once every request completed
+  std::condition_variable idle_cv_;
+  size_t queued_{0};
+  size_t max_queued_{0};
+  size_t running_{0};
+  uint64_t submitted_{0};
+  bool closed_{false};
+  bool stop_{false};
+  bool status_{true};
+};
+
+}  // namespace platform
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_PLATFORM_DISPATCHER_PRIVATE_H_ */
@@ -0,0 +1,177 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/vx/platform/dispatcher.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "tim/vx/platform/platform.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+using tim::vx::platform::Dispatcher;
+
+const tim::vx::ShapeType kShape({2, 2});
+const uint32_t kBytes = 4 * sizeof(float);
+
+/// Two executors on the first device, empty without a device
+std::vector<std::shared_ptr<tim::vx::platform::IExecutor>> CreateExecutors() {
+  auto devices = tim::vx::platform::IDevice::Enumerate();
+  if (devices.empty() || 0 == devices[0]->CoreCount()) {
+    return {};
+  }
+  return {devices[0]->CreateExecutor(0, -1), devices[0]->CreateExecutor(0, -1)};
+}
+
+/// output = input0 + input1
+std::shared_ptr<tim::vx::Graph> AddGraph(
+    const std::shared_ptr<tim::vx::Context>& ctx) {
+  auto graph = ctx->CreateGraph();
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, kShape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, kShape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto input_t0 = graph->CreateTensor(input_spec);
+  auto input_t1 = graph->CreateTensor(input_spec);
+  auto output_t = graph->CreateTensor(output_spec);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({input_t0, input_t1})
+      .BindOutput(output_t);
+  return graph;
+}
+
+/// Buffers of one request, output = 2 * value
+struct Buffers {
+  explicit Buffers(float value) : input(4, value), output(4, 0.0f) {}
+  Dispatcher::Request Request() {
+    Dispatcher::Request request;
+    request.inputs = {input.data(), input.data()};
+    request.input_bytes = {kBytes, kBytes};
+    request.outputs = {output.data()};
+    return request;
+  }
+  std::vector<float> input;
+  std::vector<float> output;
+};
+
+}  // namespace
+
+TEST(dispatcher, routes_requests) {
+  auto executors = CreateExecutors();
+  if (executors.empty()) {
+    GTEST_SKIP();
+  }
+  auto ctx = tim::vx::Context::Create();
+  auto dispatcher = Dispatcher::Create(AddGraph(ctx), executors);
+  ASSERT_TRUE(dispatcher);
+
+  const size_t kRequests = 16;
+  std::vector<Buffers> buffers;
+  for (size_t i = 0; i < kRequests; ++i) {
+    buffers.emplace_back(static_cast<float>(i));
+  }
+  for (auto& request : buffers) {
+    EXPECT_TRUE(dispatcher->Submit(request.Request()));
+  }
+  EXPECT_TRUE(dispatcher->Wait());
+  for (size_t i = 0; i < kRequests; ++i) {
+    EXPECT_EQ(buffers[i].output, std::vector<float>(4, 2.0f * i));
+  }
+
+  auto stats = dispatcher->GetStats();
+  EXPECT_EQ(stats.submitted, kRequests);
+  EXPECT_EQ(stats.queue_depth, 0u);
+  EXPECT_GE(stats.max_queue_depth, 1u);
+  ASSERT_EQ(stats.executors.size(), executors.size());
+  uint64_t completed = 0;
+  for (const auto& executor : stats.executors) {
+    EXPECT_EQ(executor.failed, 0u);
+    EXPECT_GE(executor.utilization, 0.0);
+    EXPECT_LE(executor.utilization, 1.0);
+    completed += executor.completed;
+  }
+  EXPECT_EQ(completed, kRequests);
+
+  // Buffers have to match the graph IO
+  Dispatcher::Request missing_output = buffers[0].Request();
+  missing_output.outputs.clear();
+  EXPECT_FALSE(dispatcher->Submit(missing_output));
+  dispatcher->Close();
+  EXPECT_FALSE(dispatcher->Submit(buffers[0].Request()));
+  EXPECT_EQ(dispatcher->GetStats().submitted, kRequests);
+}
+
+TEST(dispatcher, release_while_running) {
+  auto executors = CreateExecutors();
+  if (executors.empty()) {
+    GTEST_SKIP();
+  }
+  auto ctx = tim::vx::Context::Create();
+  auto dispatcher = Dispatcher::Create(AddGraph(ctx), executors);
+  ASSERT_TRUE(dispatcher);
+
+  const size_t kRequests = 8;
+  std::vector<Buffers> buffers;
+  for (size_t i = 0; i < kRequests; ++i) {
+    buffers.emplace_back(static_cast<float>(i));
+  }
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t done = 0;
+  size_t succeeded = 0;
+  for (auto& request_buffers : buffers) {
+    auto request = request_buffers.Request();
+    // The callbacks hold the only references once the test dropped its own,
+    // the last one to finish destroys the dispatcher on its worker
+    request.done = [dispatcher, &mutex, &cv, &done, &succeeded](bool status) {
+      std::lock_guard<std::mutex> lock(mutex);
+      done++;
+      succeeded += status ? 1 : 0;
+      cv.notify_all();
+    };
+    EXPECT_TRUE(dispatcher->Submit(request));
+  }
+  std::weak_ptr<Dispatcher> weak = dispatcher;
+  dispatcher.reset();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  EXPECT_TRUE(cv.wait_for(lock, std::chrono::seconds(30),
+                          [&done]() { return done == kRequests; }));
+  EXPECT_EQ(succeeded, kRequests);
+  lock.unlock();
+  for (size_t i = 0; i < 100 && !weak.expired(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(weak.expired());
+  for (size_t i = 0; i < kRequests; ++i) {
+    EXPECT_EQ(buffers[i].output, std::vector<float>(4, 2.0f * i));
+  }
+}
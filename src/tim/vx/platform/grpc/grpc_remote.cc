@@ -89,11 +89,12 @@ std::shared_ptr<IExecutable> GRPCRemoteExecutor::Compile(
     const std::shared_ptr<Graph>& graph) {
   size_t inputs_num = graph->InputsTensor().size();
   size_t outputs_num = graph->OutputsTensor().size();
-  size_t nbg_size = -1;
-
-  graph->CompileToBinary(nullptr, &nbg_size);
-  std::vector<char> nbg_buf(nbg_size);
-  graph->CompileToBinary(nbg_buf.data(), &nbg_size);
+  std::vector<char> nbg_buf;
+  VectorBinarySink sink(nbg_buf);
+  if (!graph->CompileToBinary(sink)) {
+    std::cout << "Compile graph to binary fail." << std::endl;
+    return nullptr;
+  }
 
   int32_t executable_id =
       std::dynamic_pointer_cast<GRPCRemoteDevice>(device_)
@@ -256,31 +256,45 @@ bool LiteNativeExecutorImpl::Trigger(bool async) {
 
 std::shared_ptr<IExecutable> LiteNativeExecutorImpl::Compile(
     const std::shared_ptr<Graph>& graph) {
-  size_t bin_size = -1;
   std::vector<char> nb_buf;
 #ifdef VSI_DEVICE_SUPPORT
   GraphImpl* graphimp = dynamic_cast<GraphImpl*>(graph.get());
   vsi_nn_BindDevices(graphimp->graph(), 1, &sub_device_);
 #endif
-  auto ret = graph->CompileToBinary(nullptr, &bin_size);
-  nb_buf.resize(bin_size);
-  ret |= graph->CompileToBinary(nb_buf.data(), &bin_size);
+  VectorBinarySink sink(nb_buf);
+  auto ret = graph->CompileToBinary(sink);
   if(!ret) {
     VSILOGE("Compile fail");
     return nullptr;
   }
 
+  return CreateExecutable(NBGBuffer::Create(std::move(nb_buf)),
+                          graph->InputsTensor().size(),
+                          graph->OutputsTensor().size());
+}
+
+std::shared_ptr<IExecutable> LiteNativeExecutorImpl::CreateExecutable(
+    const std::shared_ptr<const NBGBuffer>& nbg, size_t input_count,
+    size_t output_count) {
+  // The network reports its own IO count
+  (void)input_count;
+  (void)output_count;
+  if (!nbg || 0 == nbg->Size()) {
+    VSILOGE("Binary graph is empty");
+    return nullptr;
+  }
   std::shared_ptr<IExecutor> this_sp = shared_from_this();
-  auto executable = std::make_shared<LiteNativeExecutableImpl>(this_sp, nb_buf);
+  auto executable = std::make_shared<LiteNativeExecutableImpl>(this_sp, nbg);
   return executable;
 }
 
 LiteNativeExecutableImpl::LiteNativeExecutableImpl(
     const std::shared_ptr<IExecutor>& executor,
-    const std::vector<char>& nb_buf) {
+    const std::shared_ptr<const NBGBuffer>& nbg) {
   executor_ = executor;
   context_ = nullptr;
   nb_graph_ = nullptr;
+  nbg_ = nbg;
   vip_status_e  status = VIP_SUCCESS;
   vip_create_network_param_t net_param;
   device_id_ = executor_.lock()->Device()->Id();
@@ -288,8 +302,10 @@ LiteNativeExecutableImpl::LiteNativeExecutableImpl(
   net_param.device_index = device_id_;
   net_param.prop = VIP_NET_CREATE_PROP_FROM_NBG;
   net_param.nbg.type = VIP_NET_CREATE_NBG_FROM_MEMORY;
-  net_param.nbg.memory.nbg_memory = (void*)nb_buf.data();
-  net_param.nbg.memory.nbg_size = nb_buf.size();
+  // Handed to the driver as is, it may patch the binary in place. Loaded
+  // binaries are mapped copy-on-write, borrowed ones have to be writable
+  net_param.nbg.memory.nbg_memory = const_cast<char*>(nbg_->Data());
+  net_param.nbg.memory.nbg_size = nbg_->Size();
 
   auto network(std::make_unique<LiteNetwork>(net_param));
 
@@ -501,6 +517,23 @@ bool LiteNativeTensorHandleImpl::CopyDataFromTensor(void* data) {
   return ret;
 }
 
+void* LiteNativeTensorHandleImpl::Map() {
+  if (!Invalidate()) {
+    return nullptr;
+  }
+  if(memory_type_ == ALLOC_MEM_VIDEOMEM) {
+    return vip_map_buffer(tensor_buffer_);
+  }
+  return handle_;
+}
+
+void LiteNativeTensorHandleImpl::Unmap() {
+  if(memory_type_ == ALLOC_MEM_VIDEOMEM) {
+    vip_unmap_buffer(tensor_buffer_);
+  }
+  Flush();
+}
+
 bool LiteNativeTensorHandleImpl::Flush() {
   vip_status_e status = vip_flush_buffer(tensor_buffer_,VIP_BUFFER_OPER_TYPE_FLUSH);
   if (status != VIP_SUCCESS) {
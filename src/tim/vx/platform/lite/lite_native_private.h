@@ -84,6 +84,9 @@ class LiteNativeExecutorImpl
               bool after = true) override;
   bool Trigger(bool async = false) override;
   std::shared_ptr<IExecutable> Compile(const std::shared_ptr<Graph>& graph) override;
+  std::shared_ptr<IExecutable> CreateExecutable(
+      const std::shared_ptr<const NBGBuffer>& nbg, size_t input_count,
+      size_t output_count) override;
   static int executor_count;
 
 private:
@@ -95,7 +98,7 @@ private:
 class LiteNativeExecutableImpl : public LiteNativeExecutable {
  public:
   LiteNativeExecutableImpl(const std::shared_ptr<IExecutor>& executor,
-                           const std::vector<char>& nb_buf);
+                           const std::shared_ptr<const NBGBuffer>& nbg);
   virtual ~LiteNativeExecutableImpl() {};
   void SetInput(const std::shared_ptr<ITensorHandle>& th) override;
   void SetOutput(const std::shared_ptr<ITensorHandle>& th) override;
@@ -129,6 +132,8 @@ class LiteNativeTensorHandleImpl : public LiteNativeTensorHandle {
   virtual ~LiteNativeTensorHandleImpl();
   bool CopyDataToTensor(const void* data, uint32_t size_in_bytes) override;
   bool CopyDataFromTensor(void* data) override;
+  void* Map() override;
+  void Unmap() override;
   bool Flush();
   bool Invalidate();
   vip_buffer GetBuffer() {return tensor_buffer_;};
@@ -29,6 +29,14 @@
 #include "tim/vx/platform/lite/lite_native.h"
 #endif
 
+#include <fcntl.h>
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cassert>
 namespace tim {
 namespace vx {
@@ -40,10 +48,47 @@ std::shared_ptr<IExecutable> Compile(
   return executor->Compile(graph);
 }
 
+std::shared_ptr<const NBGBuffer> NBGBuffer::Load(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    VSILOGE("Failed to open %s", path.c_str());
+    return nullptr;
+  }
+  struct stat st;
+  void* addr = MAP_FAILED;
+  size_t size = 0;
+  if (0 == fstat(fd, &st) && st.st_size > 0) {
+    size = static_cast<size_t>(st.st_size);
+    // Copy-on-write, the driver may patch the binary in place
+    addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  // The mapping stays valid after the descriptor is closed
+  close(fd);
+  if (MAP_FAILED == addr) {
+    VSILOGE("Failed to map %s", path.c_str());
+    return nullptr;
+  }
+  std::shared_ptr<const void> storage(
+      addr, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+  return std::shared_ptr<const NBGBuffer>(
+      new NBGBuffer(static_cast<const char*>(addr), size, std::move(storage)));
+}
+
 NativeDeviceImpl::NativeDeviceImpl(device_id_t id, uint32_t core_count) {
   device_id_ = id;
   core_count_ = core_count;
 }
+
+NativeDeviceImpl::~NativeDeviceImpl() {
+  if (callback_thread_.joinable()) {
+    // The callback thread may drop the last reference to this device
+    if (callback_thread_.get_id() == std::this_thread::get_id()) {
+      callback_thread_.detach();
+    } else {
+      callback_thread_.join();
+    }
+  }
+}
 std::vector<std::shared_ptr<IDevice>> IDevice::Enumerate() {
 #ifdef ENABLE_PLATFORM_LITE
   auto devices = tim::vx::platform::LiteNativeDevice::Enumerate();
@@ -55,18 +100,67 @@ std::vector<std::shared_ptr<IDevice>> IDevice::Enumerate() {
 
 void IDevice::RemoteReset() {}
 
+std::shared_ptr<ITensorHandle> IExecutor::AcquireTensor(
+    const std::shared_ptr<IExecutable>& executable,
+    const TensorSpec& tensor_spec) {
+  return executable->AllocateTensor(tensor_spec);
+}
+
 bool NativeDeviceImpl::Submit(const std::shared_ptr<Graph>& graph) {
   (void)graph;
   return true;
 }
 
+std::vector<std::shared_ptr<IExecutor>> NativeDeviceImpl::Executors() {
+  std::vector<std::shared_ptr<IExecutor>> executors;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& weak : executors_) {
+    auto executor = weak.lock();
+    if (executor) {
+      executors.push_back(executor);
+    }
+  }
+  return executors;
+}
+
 bool NativeDeviceImpl::Trigger(bool async, async_callback cb) {
-  (void)async;
-  (void)cb;
-  return true;
+  auto executors = Executors();
+  bool status = true;
+  for (auto& executor : executors) {
+    status = executor->Trigger(async) && status;
+  }
+  if (!async) {
+    if (cb) {
+      cb(&status);
+    }
+    return status;
+  }
+  if (cb) {
+    // One waiter at a time keeps callbacks in trigger order
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (callback_thread_.joinable()) {
+      callback_thread_.join();
+    }
+    callback_thread_ = std::thread([executors, cb, status]() {
+      bool done = status;
+      for (auto& executor : executors) {
+        done = executor->Wait() && done;
+      }
+      cb(&done);
+    });
+  }
+  return status;
 }
 
-void NativeDeviceImpl::WaitDeviceIdle() {}
+void NativeDeviceImpl::WaitDeviceIdle() {
+  for (auto& executor : Executors()) {
+    executor->Wait();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (callback_thread_.joinable()) {
+    callback_thread_.join();
+  }
+}
 
 bool NativeDeviceImpl::DeviceExit() { return true; }
 
@@ -75,6 +169,8 @@ std::shared_ptr<IExecutor> NativeDeviceImpl::CreateExecutor(const int32_t core_i
                                                     const std::shared_ptr<Context>& context) {
   std::shared_ptr<IDevice> this_sp = shared_from_this();
   auto  executor = std::make_shared<NativeExecutorImpl>(this_sp, core_count,core_index,context);
+  std::lock_guard<std::mutex> lock(mutex_);
+  executors_.push_back(executor);
   return executor;
 }
 
@@ -111,16 +207,16 @@ std::vector<std::shared_ptr<IDevice>> NativeDevice::Enumerate() {
   return device_v;
 }
 
-NativeExecutableImpl::NativeExecutableImpl(const std::shared_ptr<IExecutor>& executor,
-                                   const std::vector<char>& nb_buf,
-                                   size_t inputs, size_t outputs) {
-
+NativeExecutableImpl::NativeExecutableImpl(
+    const std::shared_ptr<IExecutor>& executor,
+    const std::shared_ptr<const NBGBuffer>& nbg, size_t inputs,
+    size_t outputs) {
   executor_ = executor;
   context_ = executor->Contex();
   nb_graph_ = context_->CreateGraph();
 
-  nb_buf_ = nb_buf;
-  nb_node_ = nb_graph_->CreateOperation<tim::vx::ops::NBG>(nb_buf_.data(),
+  nbg_ = nbg;
+  nb_node_ = nb_graph_->CreateOperation<tim::vx::ops::NBG>(nbg_->Data(),
                                                            inputs, outputs);
 }
 
@@ -157,11 +253,54 @@ bool NativeExecutableImpl::Submit(const std::shared_ptr<IExecutable>& ref,
 }
 
 bool NativeExecutableImpl::Trigger(bool async) {
-  (void)async;
-  bool status = nb_graph_->Run();
+  if (async) {
+    auto executor =
+        std::dynamic_pointer_cast<NativeExecutorImpl>(executor_.lock());
+    if (!executor) {
+      VSILOGE("Executor of executable is released");
+      return false;
+    }
+    return executor->Enqueue(shared_from_this());
+  }
+  BeginRun();
+  return Execute();
+}
+
+bool NativeExecutableImpl::Wait() {
+  std::unique_lock<std::mutex> lock(run_mutex_);
+  run_cv_.wait(lock, [this]() { return 0 == pending_runs_; });
+  return last_status_;
+}
+
+void NativeExecutableImpl::BeginRun() {
+  std::lock_guard<std::mutex> lock(run_mutex_);
+  pending_runs_++;
+}
+
+bool NativeExecutableImpl::Execute() {
+  bool status = false;
+  {
+    std::lock_guard<std::mutex> lock(execute_mutex_);
+    status = nb_graph_->Run();
+  }
+  EndRun(status);
   return status;
 }
 
+void NativeExecutableImpl::Abort() { EndRun(false); }
+
+void NativeExecutableImpl::EndRun(bool status) {
+  {
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    pending_runs_--;
+    last_status_ = status;
+  }
+  run_cv_.notify_all();
+  if (callback_) {
+    callback_(status);
+  }
+}
+
 std::shared_ptr<ITensorHandle> NativeExecutableImpl::AllocateTensor(const TensorSpec& tensor_spec,
                                                                     void* data, uint32_t size) {
   (void)size;
@@ -169,6 +308,16 @@ std::shared_ptr<ITensorHandle> NativeExecutableImpl::AllocateTensor(const Tensor
   return std::make_shared<NativeTensorHandleImpl>(tensor);
 }
 
+std::shared_ptr<ITensorHandle> NativeExecutableImpl::AllocateDmaBufTensor(
+    const TensorSpec& tensor_spec, const DmaBufferDesc& dmabuf) {
+  auto tensor = nb_graph_->CreateTensor(tensor_spec, dmabuf);
+  if (VSI_NN_TENSOR_ID_NA == tensor->GetId()) {
+    VSILOGE("Failed to import dma-buf %d", static_cast<int>(dmabuf.fd));
+    return nullptr;
+  }
+  return std::make_shared<NativeTensorHandleImpl>(tensor, dmabuf.fd);
+}
+
 bool NativeExecutableImpl::Verify() {
   std::shared_ptr<NativeExecutorImpl> executor = std::dynamic_pointer_cast<NativeExecutorImpl>(executor_.lock());
   bool success = executor->BindDevices(NBGraph());
@@ -211,6 +360,7 @@ NativeExecutorImpl::NativeExecutorImpl(const std::shared_ptr<IDevice>& device,
   }
   core_index_ = (uint32_t)fixed_core_index;
   core_count_ = (uint32_t)fixed_core_count;
+  max_workers_ = std::max<size_t>(2, std::thread::hardware_concurrency());
 #ifdef VSI_DEVICE_SUPPORT
   vsi_nn_device_t  vsi_devices[VSI_MAX_DEVICES] = {0};
   vsi_size_t num_devices = 0;
@@ -221,50 +371,304 @@ NativeExecutorImpl::NativeExecutorImpl(const std::shared_ptr<IDevice>& device,
 #endif
 }
 
+NativeExecutorImpl::~NativeExecutorImpl() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  // No worker is spawned once stop_ is set
+  for (auto& worker : workers_) {
+    // A worker may drop the last reference to this executor, it leaves its
+    // loop without touching the executor again
+    if (worker.get_id() == std::this_thread::get_id()) {
+      worker.detach();
+    } else {
+      worker.join();
+    }
+  }
+  // Work the workers left behind can't run anymore, complete it as failed
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  serial_running_ = false;
+  while (HasJobLocked()) {
+    Job job;
+    if (!ready_.empty()) {
+      job = std::move(ready_.front());
+      ready_.pop_front();
+    } else {
+      job = std::move(serial_.front());
+      serial_.pop_front();
+    }
+    lock.unlock();
+    job.executable->Abort();
+    lock.lock();
+    FinishJobLocked(job, false);
+  }
+}
+
+bool NativeExecutorImpl::AddTask(const std::shared_ptr<IExecutable>& executable,
+                                 size_t& index) {
+  if (!executable->Verify()) {
+    VSILOGE("Executable NBG compile failed");
+    return false;
+  }
+  index = nodes_.size();
+  nodes_.push_back(TaskNode{executable, {}});
+  node_index_[executable.get()] = index;
+  return true;
+}
+
 bool NativeExecutorImpl::Submit(const std::shared_ptr<IExecutable>& executable,
                             const std::shared_ptr<IExecutable>& ref,
                             bool after) {
-  bool success = false;
-  success = executable->Verify();
-  if(success == false) {
-    VSILOGE("Executable NBG compile failed");
+  size_t pos = chain_.size();
+  if (executable != ref) {
+    auto it = node_index_.find(ref.get());
+    auto ref_pos = node_index_.end() == it
+                       ? chain_.end()
+                       : std::find(chain_.begin(), chain_.end(), it->second);
+    if (chain_.end() == ref_pos) {
+      VSILOGE("Reference executable is not submitted");
+      return false;
+    }
+    pos = (ref_pos - chain_.begin()) + (after ? 1 : 0);
+  }
+  size_t index = 0;
+  if (!AddTask(executable, index)) {
     return false;
   }
-  if(executable == ref) {
-    tasks_.push_back(executable);
-    return true;
+  chain_.insert(chain_.begin() + pos, index);
+  return true;
+}
+
+bool NativeExecutorImpl::SubmitAfter(
+    const std::shared_ptr<IExecutable>& executable,
+    const std::vector<std::shared_ptr<IExecutable>>& depends_on) {
+  std::vector<size_t> depends;
+  for (const auto& dependency : depends_on) {
+    auto it = node_index_.find(dependency.get());
+    if (node_index_.end() == it) {
+      VSILOGE("Dependency of executable is not submitted");
+      return false;
+    }
+    depends.push_back(it->second);
+  }
+  size_t index = 0;
+  if (!AddTask(executable, index)) {
+    return false;
+  }
+  nodes_[index].depends_on = std::move(depends);
+  return true;
+}
+
+std::shared_ptr<NativeExecutorImpl::TaskRun> NativeExecutorImpl::StartRun(
+    bool async) {
+  auto run = std::make_shared<TaskRun>();
+  run->async = async;
+  const size_t count = nodes_.size();
+  run->successors.resize(count);
+  run->waiting.resize(count, 0);
+  run->failed.resize(count, false);
+  for (size_t i = 0; i < count; ++i) {
+    auto executable = std::dynamic_pointer_cast<NativeExecutableImpl>(
+        nodes_[i].executable.lock());
+    if (!executable) {
+      VSILOGE("Task unable to lock weak_ptr");
+      return nullptr;
+    }
+    run->executables.push_back(executable);
+  }
+  std::vector<std::vector<size_t>> depends_on(count);
+  for (size_t i = 0; i < count; ++i) {
+    depends_on[i] = nodes_[i].depends_on;
+  }
+  for (size_t i = 1; i < chain_.size(); ++i) {
+    depends_on[chain_[i]].push_back(chain_[i - 1]);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t dependency : depends_on[i]) {
+      run->successors[dependency].push_back(i);
+      run->waiting[i]++;
+    }
   }
-  for(size_t i = 0; i < tasks_.size(); i++) {
-    if(tasks_[i].lock() == ref) {
-      if(after == true) {
-        tasks_.insert(tasks_.begin() + i + 1, executable);
-        success = true;
-        break;
-      } else {
-        tasks_.insert(tasks_.begin() + i, executable);
-        success = true;
-        break;
+
+  // Dependencies only point to earlier nodes, except for executables placed
+  // before their reference by Submit. Check the graph drains before running.
+  std::vector<size_t> waiting = run->waiting;
+  std::vector<size_t> ready;
+  for (size_t i = 0; i < count; ++i) {
+    if (0 == waiting[i]) {
+      ready.push_back(i);
+    }
+  }
+  for (size_t i = 0; i < ready.size(); ++i) {
+    for (size_t successor : run->successors[ready[i]]) {
+      if (0 == --waiting[successor]) {
+        ready.push_back(successor);
       }
     }
   }
-  return success;
+  if (ready.size() != count) {
+    VSILOGE("Submitted executables depend on each other in a cycle");
+    return nullptr;
+  }
+  // Submissions are only taken once they are known to run
+  nodes_.clear();
+  chain_.clear();
+  node_index_.clear();
+
+  for (auto& executable : run->executables) {
+    executable->BeginRun();
+  }
+  run->remaining = count;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    self_ = shared_from_this();
+    pending_ += count;
+    for (size_t i = 0; i < count; ++i) {
+      if (0 == run->waiting[i]) {
+        ready_.push_back(Job{run->executables[i], run, i});
+      }
+    }
+    SpawnWorkersLocked();
+  }
+  queue_cv_.notify_all();
+  return run;
 }
 
 bool NativeExecutorImpl::Trigger(bool async) {
-  (void)async;
-  bool ret = false;
-  while(!tasks_.empty()) {
-    auto task = tasks_.front();
-    tasks_.erase(tasks_.begin());
-    auto task_tmp = task.lock();
-    if(!task_tmp) {
-      VSILOGE("Task unable to lock weak_ptr");
-       return false;
+  if (!async) {
+    // A synchronous trigger keeps submission order behind work which is
+    // still queued on the workers. Their status is left to Wait().
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    idle_cv_.wait(lock, [this]() { return 0 == pending_; });
+  }
+  auto run = StartRun(async);
+  if (!run) {
+    return false;
+  }
+  if (async) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  idle_cv_.wait(lock, [&run]() { return 0 == run->remaining; });
+  return run->status;
+}
+
+bool NativeExecutorImpl::Wait() {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  idle_cv_.wait(lock, [this]() { return 0 == pending_; });
+  bool status = async_status_;
+  async_status_ = true;
+  return status;
+}
+
+bool NativeExecutorImpl::Enqueue(
+    const std::shared_ptr<IExecutable>& executable) {
+  auto native = std::dynamic_pointer_cast<NativeExecutableImpl>(executable);
+  if (!native) {
+    VSILOGE("Only native executables can run on a native executor");
+    return false;
+  }
+  native->BeginRun();
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    self_ = shared_from_this();
+    pending_++;
+    serial_.push_back(Job{native, nullptr, 0});
+    SpawnWorkersLocked();
+  }
+  queue_cv_.notify_one();
+  return true;
+}
+
+bool NativeExecutorImpl::HasJobLocked() const {
+  return !ready_.empty() || (!serial_.empty() && !serial_running_);
+}
+
+void NativeExecutorImpl::SpawnWorkersLocked() {
+  size_t runnable = ready_.size();
+  if (!serial_.empty() && !serial_running_) {
+    runnable++;
+  }
+  while (!stop_ && idle_workers_ < runnable &&
+         workers_.size() < max_workers_) {
+    idle_workers_++;
+    workers_.emplace_back(&NativeExecutorImpl::WorkerLoop, this, self_);
+  }
+}
+
+void NativeExecutorImpl::FinishJobLocked(const Job& job, bool status) {
+  pending_--;
+  if (!job.run || job.run->async) {
+    async_status_ = async_status_ && status;
+  }
+  if (!job.run) {
+    serial_running_ = false;
+    return;
+  }
+  auto& run = *job.run;
+  run.status = run.status && status;
+  run.remaining--;
+  for (size_t successor : run.successors[job.node]) {
+    if (!status) {
+      run.failed[successor] = true;
+    }
+    if (0 == --run.waiting[successor]) {
+      ready_.push_back(Job{run.executables[successor], job.run, successor});
     }
-    ret = task_tmp->Trigger();
   }
-  device_->WaitDeviceIdle();
-  return ret;
+}
+
+void NativeExecutorImpl::WorkerLoop(std::weak_ptr<NativeExecutorImpl> self) {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  while (true) {
+    queue_cv_.wait(lock, [this]() {
+      return HasJobLocked() || (stop_ && 0 == pending_);
+    });
+    if (!HasJobLocked()) {
+      break;
+    }
+    Job job;
+    if (!ready_.empty()) {
+      job = std::move(ready_.front());
+      ready_.pop_front();
+    } else {
+      job = std::move(serial_.front());
+      serial_.pop_front();
+      serial_running_ = true;
+    }
+    idle_workers_--;
+    bool aborted = job.run && job.run->failed[job.node];
+    // Keeps the executor alive while callbacks of the job drop references.
+    // Without it the destructor already runs elsewhere and joins this worker.
+    auto keep_alive = self.lock();
+    lock.unlock();
+    bool status = false;
+    if (aborted) {
+      job.executable->Abort();
+    } else {
+      status = job.executable->Execute();
+    }
+    lock.lock();
+    idle_workers_++;
+    FinishJobLocked(job, status);
+    SpawnWorkersLocked();
+    // Released successors, the next serial job or stop may be waiting
+    queue_cv_.notify_all();
+    idle_cv_.notify_all();
+    lock.unlock();
+    // Drop references to finished work outside the lock
+    job = Job();
+    if (keep_alive) {
+      // May run the destructor on this thread, then this is gone
+      keep_alive.reset();
+      if (self.expired()) {
+        return;
+      }
+    }
+    lock.lock();
+  }
 }
 
 std::shared_ptr<IExecutable> NativeExecutorImpl::Compile(
@@ -273,22 +677,90 @@ std::shared_ptr<IExecutable> NativeExecutorImpl::Compile(
   if(!ret) {
     return nullptr;
   }
-  size_t bin_size = -1;
-  ret = graph->CompileToBinary(nullptr, &bin_size);
+  std::vector<char> nb_buf;
+  VectorBinarySink sink(nb_buf);
+  ret = graph->CompileToBinary(sink);
   if(!ret) {
     return nullptr;
   }
-  std::vector<char> nb_buf;
-  nb_buf.resize(bin_size);
   size_t inputs = graph->InputsTensor().size();
   size_t outputs = graph->OutputsTensor().size();
-  ret = graph->CompileToBinary(nb_buf.data(), &bin_size);
-  if(!ret) {
+  return CreateExecutable(NBGBuffer::Create(std::move(nb_buf)), inputs,
+                          outputs);
+}
+
+std::shared_ptr<ITensorHandle> NativeExecutorImpl::AcquireTensor(
+    const std::shared_ptr<IExecutable>& executable,
+    const TensorSpec& tensor_spec) {
+  std::shared_ptr<ITensorHandle> handle;
+  PooledTensor entry;
+  entry.executable = executable;
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    // Handles of executables which are gone can't be bound anymore
+    auto expired = [](const PooledTensor& pooled) {
+      return pooled.executable.expired();
+    };
+    free_tensors_.erase(std::remove_if(free_tensors_.begin(),
+                                       free_tensors_.end(), expired),
+                        free_tensors_.end());
+    for (auto it = lent_tensors_.begin(); it != lent_tensors_.end();) {
+      it = expired(it->second) ? lent_tensors_.erase(it) : std::next(it);
+    }
+
+    auto found = free_tensors_.end();
+    for (auto it = free_tensors_.begin(); it != free_tensors_.end(); ++it) {
+      if (it->executable.lock() == executable &&
+          it->handle->GetSpec() == tensor_spec &&
+          (found == free_tensors_.end() || it->sequence < found->sequence)) {
+        found = it;
+      }
+    }
+    if (found != free_tensors_.end()) {
+      handle = std::move(found->handle);
+      entry.sequence = found->sequence;
+      free_tensors_.erase(found);
+    } else {
+      entry.sequence = pooled_tensors_++;
+    }
+  }
+  if (!handle) {
+    handle = executable->AllocateTensor(tensor_spec);
+    if (!handle) {
+      return nullptr;
+    }
+  }
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  lent_tensors_[handle.get()] = entry;
+  return handle;
+}
+
+bool NativeExecutorImpl::ReleaseTensor(
+    const std::shared_ptr<ITensorHandle>& handle) {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  auto it = lent_tensors_.find(handle.get());
+  if (!handle || it == lent_tensors_.end()) {
+    return false;
+  }
+  PooledTensor entry = std::move(it->second);
+  lent_tensors_.erase(it);
+  if (!entry.executable.expired()) {
+    entry.handle = handle;
+    free_tensors_.push_back(std::move(entry));
+  }
+  return true;
+}
+
+std::shared_ptr<IExecutable> NativeExecutorImpl::CreateExecutable(
+    const std::shared_ptr<const NBGBuffer>& nbg, size_t input_count,
+    size_t output_count) {
+  if (!nbg || 0 == nbg->Size()) {
+    VSILOGE("Binary graph is empty");
     return nullptr;
   }
   std::shared_ptr<NativeExecutorImpl> this_sp = shared_from_this();
-  auto  executable = std::make_shared<NativeExecutableImpl>(this_sp, nb_buf,inputs,outputs);
-  return executable;
+  return std::make_shared<NativeExecutableImpl>(this_sp, nbg, input_count,
+                                                output_count);
 }
 
 
@@ -311,11 +783,19 @@ bool NativeExecutorImpl::BindDevices(const std::shared_ptr<Graph>& graph){
 }
 
 
-NativeTensorHandleImpl::NativeTensorHandleImpl(const std::shared_ptr<Tensor>& tensor) {
+NativeTensorHandleImpl::NativeTensorHandleImpl(
+    const std::shared_ptr<Tensor>& tensor, int64_t dmabuf_fd)
+    : dmabuf_fd_(dmabuf_fd) {
   tensor_ = tensor;
   spec_ = tensor->GetSpec();
 }
 
+NativeTensorHandleImpl::~NativeTensorHandleImpl() {
+  if (dmabuf_addr_) {
+    munmap(dmabuf_addr_, dmabuf_size_);
+  }
+}
+
 bool NativeTensorHandleImpl::CopyDataToTensor(const void* data,
                                           uint32_t size_in_bytes) {
   return tensor_->CopyDataToTensor(data, size_in_bytes);
@@ -325,6 +805,47 @@ bool NativeTensorHandleImpl::CopyDataFromTensor(void* data) {
   return tensor_->CopyDataFromTensor(data);
 }
 
+void* NativeTensorHandleImpl::Map() {
+  if (-1 == dmabuf_fd_) {
+    // Invalidates the CPU cache, the device may have written the tensor
+    return tensor_->map(true);
+  }
+  int fd = static_cast<int>(dmabuf_fd_);
+  if (!dmabuf_addr_) {
+    size_t size = static_cast<size_t>(spec_.GetByteSize());
+    void* addr =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == addr) {
+      VSILOGE("Failed to map dma-buf %d", fd);
+      return nullptr;
+    }
+    dmabuf_addr_ = addr;
+    dmabuf_size_ = size;
+  }
+  struct dma_buf_sync sync = {DMA_BUF_SYNC_START | DMA_BUF_SYNC_RW};
+  if (0 != ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync)) {
+    VSILOGW("Failed to begin CPU access of dma-buf %d", fd);
+  }
+  return dmabuf_addr_;
+}
+
+void NativeTensorHandleImpl::Unmap() {
+  if (-1 == dmabuf_fd_) {
+    // Inputs written through the mapping have to reach the device
+    if (spec_.attr_ & TensorAttribute::INPUT) {
+      tensor_->FlushCacheForHandle();
+    }
+    return;
+  }
+  if (dmabuf_addr_) {
+    int fd = static_cast<int>(dmabuf_fd_);
+    struct dma_buf_sync sync = {DMA_BUF_SYNC_END | DMA_BUF_SYNC_RW};
+    if (0 != ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync)) {
+      VSILOGW("Failed to end CPU access of dma-buf %d", fd);
+    }
+  }
+}
+
 }  // namespace platform
 }  // namespace vx
 }  // namespace tim
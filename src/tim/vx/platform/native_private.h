@@ -24,6 +24,12 @@
 #ifndef TIM_VX_NATIVE_DEVICE_PRIVATE_H_
 #define TIM_VX_NATIVE_DEVICE_PRIVATE_H_
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 #include "tim/vx/platform/native.h"
 #include "vip/virtual_device.h"
 #include "graph_private.h"
@@ -39,7 +45,7 @@ class NativeDeviceImpl : public NativeDevice,
                          public std::enable_shared_from_this<NativeDeviceImpl>{
  public:
   NativeDeviceImpl(device_id_t id,uint32_t core_count);
-  ~NativeDeviceImpl(){};
+  ~NativeDeviceImpl();
 
   bool Submit(const std::shared_ptr<tim::vx::Graph>& graph) override;
   bool Trigger(bool async = false, async_callback cb = NULL) override;
@@ -48,13 +54,22 @@ class NativeDeviceImpl : public NativeDevice,
   std::shared_ptr<IExecutor> CreateExecutor(const int32_t core_index = 0,
                                             const int32_t core_count = -1,
                                             const std::shared_ptr<Context>& context = nullptr) override;
+
+ private:
+  /// Live executors of this device
+  std::vector<std::shared_ptr<IExecutor>> Executors();
+
+  std::mutex mutex_;
+  std::vector<std::weak_ptr<IExecutor>> executors_;
+  /// Waits for an asynchronous Trigger and fires its callback
+  std::thread callback_thread_;
 };
 
 class NativeExecutableImpl : public NativeExecutable {
  public:
   NativeExecutableImpl(const std::shared_ptr<IExecutor>& executor,
-                   const std::vector<char>& nb_buf, size_t inputs,
-                   size_t outputs);
+                       const std::shared_ptr<const NBGBuffer>& nbg,
+                       size_t inputs, size_t outputs);
   ~NativeExecutableImpl() {};
   void SetInput(const std::shared_ptr<ITensorHandle>& th) override;
   void SetOutput(const std::shared_ptr<ITensorHandle>& th) override;
@@ -62,13 +77,33 @@ class NativeExecutableImpl : public NativeExecutable {
   void SetOutputs(const std::vector<std::shared_ptr<ITensorHandle>>& ths) override;
   bool Submit(const std::shared_ptr<IExecutable>& ref, bool after = true) override;
   bool Trigger(bool async = false) override;
+  bool Wait() override;
   std::shared_ptr<ITensorHandle> AllocateTensor(const TensorSpec& tensor_spec,
                                                 void* data = nullptr, uint32_t size = 0) override;
+  std::shared_ptr<ITensorHandle> AllocateDmaBufTensor(
+      const TensorSpec& tensor_spec, const DmaBufferDesc& dmabuf) override;
   bool Verify() override;
 
+  /// Account a run which is about to be queued or executed
+  void BeginRun();
+  /// Run the graph on the calling thread, then complete the run begun last
+  bool Execute();
+  /// Complete the run begun last as failed without running the graph
+  void Abort();
+
  protected:
   std::shared_ptr<tim::vx::ops::NBG> nb_node_;
-  std::vector<char> nb_buf_;
+
+ private:
+  /// Complete the run begun last with status
+  void EndRun(bool status);
+
+  /// Serializes runs of the graph, workers may pick the same executable
+  std::mutex execute_mutex_;
+  std::mutex run_mutex_;
+  std::condition_variable run_cv_;
+  uint32_t pending_runs_{0};
+  bool last_status_{true};
 };
 
 class NativeExecutorImpl : public NativeExecutor,
@@ -78,25 +113,129 @@ class NativeExecutorImpl : public NativeExecutor,
                  const int32_t core_count = -1,
                  const int32_t core_index = 0,
                  const std::shared_ptr<Context>& context = nullptr);
-  ~NativeExecutorImpl(){};
+  ~NativeExecutorImpl();
   bool Submit(const std::shared_ptr<IExecutable>& executable,
               const std::shared_ptr<IExecutable>& ref,
               bool after = true) override;
+  bool SubmitAfter(
+      const std::shared_ptr<IExecutable>& executable,
+      const std::vector<std::shared_ptr<IExecutable>>& depends_on) override;
   bool Trigger(bool async = false) override;
+  bool Wait() override;
   std::shared_ptr<IExecutable> Compile(const std::shared_ptr<Graph>& graph) override;
+  std::shared_ptr<IExecutable> CreateExecutable(
+      const std::shared_ptr<const NBGBuffer>& nbg, size_t input_count,
+      size_t output_count) override;
+  std::shared_ptr<ITensorHandle> AcquireTensor(
+      const std::shared_ptr<IExecutable>& executable,
+      const TensorSpec& tensor_spec) override;
+  bool ReleaseTensor(const std::shared_ptr<ITensorHandle>& handle) override;
   bool BindDevices(const std::shared_ptr<Graph>& graph);
+  /// Queue executable on the workers, runs queued this way are executed one
+  /// at a time in queue order
+  bool Enqueue(const std::shared_ptr<IExecutable>& executable);
 
 private:
+  /// An executable submitted since the last Trigger
+  struct TaskNode {
+    std::weak_ptr<IExecutable> executable;
+    /// Nodes which have to finish first
+    std::vector<size_t> depends_on;
+  };
+  /// Task graph of one Trigger, shared by its jobs
+  struct TaskRun {
+    std::vector<std::shared_ptr<NativeExecutableImpl>> executables;
+    std::vector<std::vector<size_t>> successors;
+    /// Unfinished dependencies of each node
+    std::vector<size_t> waiting;
+    /// A dependency of the node failed, it is aborted instead of run
+    std::vector<bool> failed;
+    size_t remaining{0};
+    bool status{true};
+    /// Triggered asynchronously, its status is reported by Wait()
+    bool async{false};
+  };
+  /// An IO handle of the pool, lent out or free
+  struct PooledTensor {
+    std::weak_ptr<IExecutable> executable;
+    /// Allocation order among the handles of the pool
+    uint64_t sequence{0};
+    /// Only held while the handle is free
+    std::shared_ptr<ITensorHandle> handle;
+  };
+  struct Job {
+    std::shared_ptr<NativeExecutableImpl> executable;
+    /// nullptr for a run queued by Enqueue
+    std::shared_ptr<TaskRun> run;
+    size_t node{0};
+  };
+
+  /// Add a node for executable, false if it doesn't verify
+  bool AddTask(const std::shared_ptr<IExecutable>& executable, size_t& index);
+  /// Take the submitted nodes and hand the task graph to the workers,
+  /// nullptr without taking them if they can't run
+  std::shared_ptr<TaskRun> StartRun(bool async);
+  /// Release the successors of a finished job, called with queue_mutex_ held
+  void FinishJobLocked(const Job& job, bool status);
+  /// Start workers until every runnable job has one, called with
+  /// queue_mutex_ held
+  void SpawnWorkersLocked();
+  bool HasJobLocked() const;
+  void WorkerLoop(std::weak_ptr<NativeExecutorImpl> self);
+
 #ifdef VSI_DEVICE_SUPPORT
   vsi_nn_device_t  sub_device_;
 #endif
+  std::vector<TaskNode> nodes_;
+  /// Nodes added by Submit, in the order they run
+  std::vector<size_t> chain_;
+  /// Latest node of each submitted executable
+  std::unordered_map<const IExecutable*, size_t> node_index_;
+
+  std::vector<std::thread> workers_;
+  /// Handed to workers, set by the callers which queue work
+  std::weak_ptr<NativeExecutorImpl> self_;
+  /// Runs of different executables mostly wait for the device, so the pool
+  /// may be wider than the host
+  size_t max_workers_;
+  size_t idle_workers_{0};
+  std::mutex queue_mutex_;
+  /// Wakes workers on new jobs or stop
+  std::condition_variable queue_cv_;
+  /// Wakes Wait() and synchronous Trigger() when jobs finished
+  std::condition_variable idle_cv_;
+  /// Jobs whose dependencies finished
+  std::deque<Job> ready_;
+  /// Jobs queued by Enqueue
+  std::deque<Job> serial_;
+  bool serial_running_{false};
+  /// Jobs triggered but not finished, including ones not ready yet
+  size_t pending_{0};
+  bool stop_{false};
+  bool async_status_{true};
+
+  std::mutex pool_mutex_;
+  std::unordered_map<const ITensorHandle*, PooledTensor> lent_tensors_;
+  std::vector<PooledTensor> free_tensors_;
+  uint64_t pooled_tensors_{0};
 };
 
 class NativeTensorHandleImpl : public NativeTensorHandle {
  public:
-  NativeTensorHandleImpl(const std::shared_ptr<Tensor>& tensor);
+  /// dmabuf_fd is the dma-buf behind tensor, -1 for memory of the driver
+  NativeTensorHandleImpl(const std::shared_ptr<Tensor>& tensor,
+                         int64_t dmabuf_fd = -1);
+  ~NativeTensorHandleImpl();
   bool CopyDataToTensor(const void* data, uint32_t size_in_bytes) override;
   bool CopyDataFromTensor(void* data) override;
+  void* Map() override;
+  void Unmap() override;
+
+ private:
+  int64_t dmabuf_fd_;
+  /// CPU mapping of the dma-buf, kept until the handle is gone
+  void* dmabuf_addr_{nullptr};
+  size_t dmabuf_size_{0};
 };
 
 }  // namespace platform
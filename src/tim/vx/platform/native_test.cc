@@ -0,0 +1,449 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/vx/platform/native.h"
+
+#include <fcntl.h>
+#include <linux/dma-heap.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::shared_ptr<tim::vx::platform::IExecutor> CreateExecutor() {
+  auto devices = tim::vx::platform::IDevice::Enumerate();
+  if (devices.empty() || 0 == devices[0]->CoreCount()) {
+    return nullptr;
+  }
+  return devices[0]->CreateExecutor(0, -1);
+}
+
+struct AddExecutable {
+  std::shared_ptr<tim::vx::platform::IExecutable> executable;
+  std::shared_ptr<tim::vx::platform::ITensorHandle> output;
+};
+
+const tim::vx::TensorSpec kAddInputSpec(tim::vx::DataType::FLOAT32, {2, 2},
+                                        tim::vx::TensorAttribute::INPUT);
+const tim::vx::TensorSpec kAddOutputSpec(tim::vx::DataType::FLOAT32, {2, 2},
+                                         tim::vx::TensorAttribute::OUTPUT);
+
+/// Executable of output = input0 + input1 without IO bound
+std::shared_ptr<tim::vx::platform::IExecutable> CompileAddGraph(
+    const std::shared_ptr<tim::vx::platform::IExecutor>& executor) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  auto input_t0 = graph->CreateTensor(kAddInputSpec);
+  auto input_t1 = graph->CreateTensor(kAddInputSpec);
+  auto output_t = graph->CreateTensor(kAddOutputSpec);
+  graph->CreateOperation<tim::vx::ops::Add>()
+      ->BindInputs({input_t0, input_t1})
+      .BindOutputs({output_t});
+  return executor->Compile(graph);
+}
+
+AddExecutable CompileAdd(
+    const std::shared_ptr<tim::vx::platform::IExecutor>& executor,
+    float in) {
+  AddExecutable add;
+  add.executable = CompileAddGraph(executor);
+  auto input0 = add.executable->AllocateTensor(kAddInputSpec);
+  auto input1 = add.executable->AllocateTensor(kAddInputSpec);
+  add.output = add.executable->AllocateTensor(kAddOutputSpec);
+  add.executable->SetInputs({input0, input1});
+  add.executable->SetOutput(add.output);
+  std::vector<float> data(4, in);
+  input0->CopyDataToTensor(data.data(), data.size() * sizeof(float));
+  input1->CopyDataToTensor(data.data(), data.size() * sizeof(float));
+  return add;
+}
+
+/// Resident set size of this process in bytes
+size_t ResidentBytes() {
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  statm >> total_pages >> resident_pages;
+  return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+}  // namespace
+
+TEST(native_executor, instances_share_binary) {
+  auto executor = CreateExecutor();
+  if (!executor) {
+    GTEST_SKIP();
+  }
+  // Weights of 1024x1024 floats make the binary dominate host memory
+  const uint32_t kUnits = 1024;
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, {kUnits, 1},
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec weight_spec(tim::vx::DataType::FLOAT32,
+                                  {kUnits, kUnits},
+                                  tim::vx::TensorAttribute::CONSTANT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, {kUnits, 1},
+                                  tim::vx::TensorAttribute::OUTPUT);
+  // Row i of the weights is all (i % 4), output i is (i % 4) * sum(input)
+  std::vector<float> weights(kUnits * kUnits);
+  for (uint32_t i = 0; i < kUnits; ++i) {
+    std::fill(weights.begin() + i * kUnits, weights.begin() + (i + 1) * kUnits,
+              static_cast<float>(i % 4));
+  }
+  auto input_t = graph->CreateTensor(input_spec);
+  auto weight_t = graph->CreateTensor(weight_spec, weights.data());
+  auto output_t = graph->CreateTensor(output_spec);
+  graph->CreateOperation<tim::vx::ops::FullyConnected>(0, kUnits)
+      ->BindInputs({input_t, weight_t})
+      .BindOutputs({output_t});
+
+  auto compiled = executor->Compile(graph);
+  ASSERT_TRUE(compiled);
+  auto nbg = compiled->Binary();
+  ASSERT_TRUE(nbg);
+
+  const size_t kInstances = 8;
+  std::vector<std::shared_ptr<tim::vx::platform::IExecutable>> instances;
+  std::vector<std::shared_ptr<tim::vx::platform::ITensorHandle>> inputs;
+  std::vector<std::shared_ptr<tim::vx::platform::ITensorHandle>> outputs;
+  size_t rss_before = ResidentBytes();
+  for (size_t i = 0; i < kInstances; ++i) {
+    instances.push_back(executor->CreateExecutable(nbg, 1, 1));
+    ASSERT_TRUE(instances.back());
+    EXPECT_EQ(instances.back()->Binary(), nbg);
+    // Every instance has its own IO bindings
+    inputs.push_back(instances[i]->AllocateTensor(input_spec));
+    outputs.push_back(instances[i]->AllocateTensor(output_spec));
+    instances[i]->SetInput(inputs.back());
+    instances[i]->SetOutput(outputs.back());
+    // The driver imports the binary here
+    EXPECT_TRUE(instances[i]->Verify());
+  }
+  size_t rss_after = ResidentBytes();
+  // A copy per instance would grow by kInstances * nbg->Size() on its own
+  EXPECT_LT(rss_after - std::min(rss_before, rss_after),
+            kInstances * nbg->Size())
+      << "Host memory grows with a binary copy per instance";
+
+  outputs.resize(2);
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    std::vector<float> data(kUnits, i + 1.0f / kUnits);
+    EXPECT_TRUE(
+        inputs[i]->CopyDataToTensor(data.data(), kUnits * sizeof(float)));
+    EXPECT_TRUE(instances[i]->Trigger());
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    std::vector<float> output(kUnits);
+    EXPECT_TRUE(outputs[i]->CopyDataFromTensor(output.data()));
+    float sum = kUnits * i + 1.0f;
+    for (uint32_t unit = 0; unit < 8; ++unit) {
+      EXPECT_NEAR(output[unit], (unit % 4) * sum, 1e-2f * sum);
+    }
+  }
+}
+
+TEST(native_executor, load_binary_from_file) {
+  auto executor = CreateExecutor();
+  if (!executor) {
+    GTEST_SKIP();
+  }
+  auto add = CompileAdd(executor, 1.0f);
+  auto compiled = add.executable->Binary();
+  ASSERT_TRUE(compiled);
+
+  char path[] = "/tmp/native_test_nbg_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  std::ofstream(path, std::ios::binary)
+      .write(compiled->Data(), compiled->Size());
+  auto mapped = tim::vx::platform::NBGBuffer::Load(path);
+  unlink(path);
+  ASSERT_TRUE(mapped);
+  EXPECT_EQ(std::vector<char>(mapped->Data(), mapped->Data() + mapped->Size()),
+            std::vector<char>(compiled->Data(),
+                              compiled->Data() + compiled->Size()));
+  EXPECT_FALSE(tim::vx::platform::NBGBuffer::Load(path));
+
+  // Borrowed data keeps its owner alive
+  auto borrowed = tim::vx::platform::NBGBuffer::Borrow(
+      compiled->Data(), compiled->Size(), compiled);
+  EXPECT_EQ(borrowed->Data(), compiled->Data());
+
+  tim::vx::TensorSpec spec(tim::vx::DataType::FLOAT32, {2, 2},
+                           tim::vx::TensorAttribute::INPUT);
+  for (const auto& nbg : {mapped, borrowed}) {
+    auto executable = executor->CreateExecutable(nbg, 2, 1);
+    ASSERT_TRUE(executable);
+    auto input0 = executable->AllocateTensor(spec);
+    auto input1 = executable->AllocateTensor(spec);
+    auto output = executable->AllocateTensor(spec);
+    executable->SetInputs({input0, input1});
+    executable->SetOutput(output);
+    std::vector<float> data = {1.0f, 2.0f, 3.0f, 4.0f};
+    EXPECT_TRUE(input0->CopyDataToTensor(data.data(), 4 * sizeof(float)));
+    EXPECT_TRUE(input1->CopyDataToTensor(data.data(), 4 * sizeof(float)));
+    EXPECT_TRUE(executable->Verify());
+    EXPECT_TRUE(executable->Trigger());
+    std::vector<float> result(4);
+    EXPECT_TRUE(output->CopyDataFromTensor(result.data()));
+    EXPECT_EQ(result, std::vector<float>({2.0f, 4.0f, 6.0f, 8.0f}));
+  }
+}
+
+TEST(native_executor, pooled_tensors_are_mappable) {
+  auto executor = CreateExecutor();
+  if (!executor) {
+    GTEST_SKIP();
+  }
+  auto executable = CompileAddGraph(executor);
+  ASSERT_TRUE(executable);
+  using Handles =
+      std::vector<std::shared_ptr<tim::vx::platform::ITensorHandle>>;
+  auto acquire = [&executor, &executable]() {
+    return Handles({executor->AcquireTensor(executable, kAddInputSpec),
+                    executor->AcquireTensor(executable, kAddInputSpec),
+                    executor->AcquireTensor(executable, kAddOutputSpec)});
+  };
+
+  Handles first = acquire();
+  executable->SetInputs({first[0], first[1]});
+  executable->SetOutput(first[2]);
+  ASSERT_TRUE(executable->Verify());
+  for (int request = 0; request < 3; ++request) {
+    Handles handles = request ? acquire() : first;
+    // Recycled in allocation order, so they keep their bindings
+    EXPECT_EQ(handles, first);
+    for (size_t i = 0; i < 2; ++i) {
+      auto input = static_cast<float*>(handles[i]->Map());
+      ASSERT_NE(input, nullptr);
+      std::fill(input, input + 4, request + i + 1.0f);
+      handles[i]->Unmap();
+    }
+    EXPECT_TRUE(executable->Trigger());
+    auto output = static_cast<float*>(handles[2]->Map());
+    ASSERT_NE(output, nullptr);
+    EXPECT_EQ(std::vector<float>(output, output + 4),
+              std::vector<float>(4, 2.0f * request + 3.0f));
+    handles[2]->Unmap();
+    for (auto& handle : handles) {
+      EXPECT_TRUE(executor->ReleaseTensor(handle));
+    }
+  }
+  EXPECT_FALSE(executor->ReleaseTensor(first[0]));
+
+  // Handles are never shared between executables
+  auto other = CompileAddGraph(executor);
+  auto other_input = executor->AcquireTensor(other, kAddInputSpec);
+  EXPECT_NE(other_input, first[0]);
+  EXPECT_NE(other_input, first[1]);
+}
+
+TEST(native_executor, dmabuf_tensor) {
+  auto executor = CreateExecutor();
+  int heap = open("/dev/dma_heap/system", O_RDONLY | O_CLOEXEC);
+  if (!executor || heap < 0) {
+    GTEST_SKIP();
+  }
+  struct dma_heap_allocation_data alloc = {};
+  alloc.len = kAddInputSpec.GetByteSize();
+  alloc.fd_flags = O_RDWR | O_CLOEXEC;
+  int ret = ioctl(heap, DMA_HEAP_IOCTL_ALLOC, &alloc);
+  close(heap);
+  ASSERT_EQ(ret, 0);
+  int dmabuf = static_cast<int>(alloc.fd);
+
+  auto executable = CompileAddGraph(executor);
+  auto input = executable->AllocateDmaBufTensor(kAddInputSpec, {dmabuf});
+  if (!input) {
+    close(dmabuf);
+    GTEST_SKIP() << "Driver can't import dma-bufs";
+  }
+  auto data = static_cast<float*>(input->Map());
+  ASSERT_NE(data, nullptr);
+  std::fill(data, data + 4, 1.5f);
+  input->Unmap();
+  auto output = executable->AllocateTensor(kAddOutputSpec);
+  executable->SetInputs({input, input});
+  executable->SetOutput(output);
+  EXPECT_TRUE(executable->Verify());
+  EXPECT_TRUE(executable->Trigger());
+  std::vector<float> result(4);
+  EXPECT_TRUE(output->CopyDataFromTensor(result.data()));
+  EXPECT_EQ(result, std::vector<float>(4, 3.0f));
+  input.reset();
+  executable.reset();
+  close(dmabuf);
+}
+
+TEST(native_executor, independent_tasks_complete_concurrently) {
+  auto executor = CreateExecutor();
+  if (!executor) {
+    GTEST_SKIP();
+  }
+  auto branch_a = CompileAdd(executor, 1.0f);
+  auto branch_b = CompileAdd(executor, 2.0f);
+  auto join = CompileAdd(executor, 3.0f);
+
+  // Each branch holds its worker in the completion callback until the other
+  // one completed as well, or gives up after a timeout. Completed one after
+  // the other on a single worker the callback windows don't overlap. This
+  // shows the branches are handed to workers concurrently, not that the
+  // device ran them at the same time.
+  struct Window {
+    Clock::time_point begin;
+    Clock::time_point end;
+  };
+  std::mutex mutex;
+  std::condition_variable cv;
+  int finished = 0;
+  auto hold = [&](Window* window) {
+    return [&, window](bool status) {
+      EXPECT_TRUE(status);
+      std::unique_lock<std::mutex> lock(mutex);
+      window->begin = Clock::now();
+      finished++;
+      cv.notify_all();
+      cv.wait_for(lock, std::chrono::seconds(2),
+                  [&finished]() { return finished >= 2; });
+      window->end = Clock::now();
+    };
+  };
+  Window window_a, window_b;
+  Clock::time_point join_begin;
+  branch_a.executable->SetCompletionCallback(hold(&window_a));
+  branch_b.executable->SetCompletionCallback(hold(&window_b));
+  join.executable->SetCompletionCallback([&](bool status) {
+    EXPECT_TRUE(status);
+    std::lock_guard<std::mutex> lock(mutex);
+    join_begin = Clock::now();
+  });
+
+  EXPECT_TRUE(executor->SubmitAfter(branch_a.executable, {}));
+  EXPECT_TRUE(executor->SubmitAfter(branch_b.executable, {}));
+  EXPECT_TRUE(executor->SubmitAfter(
+      join.executable, {branch_a.executable, branch_b.executable}));
+  EXPECT_TRUE(executor->Trigger());
+
+  auto overlap = std::min(window_a.end, window_b.end) -
+                 std::max(window_a.begin, window_b.begin);
+  EXPECT_GT(overlap.count(), 0)
+      << "Independent tasks completed one after the other";
+  EXPECT_GE(join_begin, std::max(window_a.end, window_b.end));
+
+  std::vector<float> output(4);
+  EXPECT_TRUE(join.output->CopyDataFromTensor(output.data()));
+  EXPECT_EQ(output, std::vector<float>(4, 6.0f));
+}
+
+TEST(native_executor, submit_keeps_order) {
+  auto executor = CreateExecutor();
+  if (!executor) {
+    GTEST_SKIP();
+  }
+  auto first = CompileAdd(executor, 1.0f);
+  auto second = CompileAdd(executor, 2.0f);
+  auto third = CompileAdd(executor, 3.0f);
+  std::vector<int> order;
+  auto record = [&order](int id) {
+    return [&order, id](bool) { order.push_back(id); };
+  };
+  first.executable->SetCompletionCallback(record(1));
+  second.executable->SetCompletionCallback(record(2));
+  third.executable->SetCompletionCallback(record(3));
+
+  EXPECT_TRUE(third.executable->Submit(third.executable));
+  EXPECT_TRUE(first.executable->Submit(third.executable, false));
+  EXPECT_TRUE(second.executable->Submit(first.executable));
+  EXPECT_TRUE(executor->Trigger(true));
+  EXPECT_TRUE(executor->Wait());
+  EXPECT_EQ(order, std::vector<int>({1, 2, 3}));
+}
+
+TEST(native_executor, async_trigger) {
+  auto executor = CreateExecutor();
+  if (!executor) {
+    GTEST_SKIP();
+  }
+  auto add = CompileAdd(executor, 1.0f);
+  std::mutex mutex;
+  int runs = 0;
+  bool run_status = false;
+  std::thread::id run_thread;
+  add.executable->SetCompletionCallback([&](bool status) {
+    std::lock_guard<std::mutex> lock(mutex);
+    runs++;
+    run_status = status;
+    run_thread = std::this_thread::get_id();
+  });
+
+  // The run is handed to the worker of the executor, the callback fires there
+  EXPECT_TRUE(add.executable->Trigger(true));
+  EXPECT_TRUE(add.executable->Wait());
+  EXPECT_TRUE(executor->Wait());
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(runs, 1);
+    EXPECT_TRUE(run_status);
+    EXPECT_NE(run_thread, std::this_thread::get_id());
+  }
+  std::vector<float> output(4);
+  EXPECT_TRUE(add.output->CopyDataFromTensor(output.data()));
+  EXPECT_EQ(output, std::vector<float>(4, 2.0f));
+
+#ifndef __ANDROID_NDK__
+  // The device triggers work submitted to its executors and reports the
+  // combined status through async_callback
+  int device_callbacks = 0;
+  bool device_status = false;
+  EXPECT_TRUE(add.executable->Submit(add.executable));
+  auto device = executor->Device();
+  EXPECT_TRUE(device->Trigger(true, [&](const void* data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    device_callbacks++;
+    device_status = *static_cast<const bool*>(data);
+    return true;
+  }));
+  device->WaitDeviceIdle();
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(device_callbacks, 1);
+  EXPECT_TRUE(device_status);
+  EXPECT_EQ(runs, 2);
+#endif
+}
@@ -0,0 +1,293 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "stream_pipeline_private.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "graph_private.h"
+#include "tim/vx/graph.h"
+#include "vsi_nn_pub.h"
+
+namespace tim {
+namespace vx {
+
+std::shared_ptr<StreamPipeline> StreamPipeline::Create(
+    const std::shared_ptr<Graph>& graph, size_t depth) {
+  if (!graph || 0 == depth) {
+    VSILOGE("Stream pipeline needs a graph and at least one buffer set");
+    return nullptr;
+  }
+  auto pipeline = std::make_shared<StreamPipelineImpl>(graph, depth);
+  if (!pipeline->Init()) {
+    return nullptr;
+  }
+  return pipeline;
+}
+
+StreamPipelineImpl::StreamPipelineImpl(const std::shared_ptr<Graph>& graph,
+                                       size_t depth)
+    : graph_(graph),
+      graph_impl_(dynamic_cast<GraphImpl*>(graph.get())),
+      depth_(depth),
+      inputs_(graph->InputsTensor()),
+      outputs_(graph->OutputsTensor()) {}
+
+StreamPipelineImpl::~StreamPipelineImpl() {
+  Close();
+  if (runner_.joinable()) {
+    runner_.join();
+  }
+
+  // Give the graph its own handles back before the buffers go away
+  void* old_ptr = nullptr;
+  for (size_t i = 0; i < origin_inputs_.size(); ++i) {
+    inputs_[i]->SwapHandle(origin_inputs_[i].ptr,
+                           origin_inputs_[i].malloc_by_ovxlib, &old_ptr);
+  }
+  for (size_t i = 0; i < origin_outputs_.size(); ++i) {
+    outputs_[i]->SwapHandle(origin_outputs_[i].ptr,
+                            origin_outputs_[i].malloc_by_ovxlib, &old_ptr);
+  }
+  for (auto& slot : slots_) {
+    for (auto buf : slot->inputs) {
+      vsi_nn_FreeAlignedBuffer(static_cast<uint8_t*>(buf));
+    }
+    for (auto buf : slot->outputs) {
+      vsi_nn_FreeAlignedBuffer(static_cast<uint8_t*>(buf));
+    }
+  }
+}
+
+size_t StreamPipelineImpl::HandleBytes(
+    const std::shared_ptr<Tensor>& tensor) const {
+  vsi_nn_tensor_t* vsi_tensor =
+      vsi_nn_GetTensor(graph_impl_->graph(), tensor->GetId());
+  if (!vsi_tensor || !vsi_tensor->attr.is_created_from_handle) {
+    return 0;
+  }
+  vsi_size_t stride[VSI_NN_MAX_DIM_NUM] = {0};
+  return vsi_nn_GetStrideSize(&vsi_tensor->attr, stride);
+}
+
+bool StreamPipelineImpl::Init() {
+  if (!graph_impl_ || !graph_->Compile()) {
+    VSILOGE("Compile graph for stream pipeline fail");
+    return false;
+  }
+
+  std::vector<size_t> input_bytes, output_bytes;
+  for (const auto& tensor : inputs_) {
+    input_bytes.push_back(HandleBytes(tensor));
+  }
+  for (const auto& tensor : outputs_) {
+    output_bytes.push_back(HandleBytes(tensor));
+  }
+  if (std::count(input_bytes.begin(), input_bytes.end(), 0) ||
+      std::count(output_bytes.begin(), output_bytes.end(), 0)) {
+    VSILOGE("Stream pipeline needs graph IO tensors created from handle");
+    return false;
+  }
+
+  vsi_nn_graph_t* graph = graph_impl_->graph();
+  auto align_start = graph->handle_manager.align_start_size;
+  auto align_block = graph->handle_manager.align_block_size;
+  auto allocate = [align_start, align_block](size_t bytes) -> void* {
+    return vsi_nn_MallocAlignedBuffer(bytes, align_start, align_block);
+  };
+  for (size_t i = 0; i < depth_; ++i) {
+    std::unique_ptr<Slot> slot(new Slot);
+    slot->input_bytes = input_bytes;
+    slot->output_bytes = output_bytes;
+    for (auto bytes : input_bytes) {
+      slot->inputs.push_back(allocate(bytes));
+    }
+    for (auto bytes : output_bytes) {
+      slot->outputs.push_back(allocate(bytes));
+    }
+    bool allocated =
+        std::count(slot->inputs.begin(), slot->inputs.end(), nullptr) == 0 &&
+        std::count(slot->outputs.begin(), slot->outputs.end(), nullptr) == 0;
+    free_.push_back(slot.get());
+    slots_.push_back(std::move(slot));
+    if (!allocated) {
+      VSILOGE("Allocate stream pipeline buffers fail");
+      return false;
+    }
+  }
+
+  // Remember the handles the graph came with, they are restored on exit
+  for (const auto& tensor : inputs_) {
+    vsi_nn_tensor_t* vsi_tensor = vsi_nn_GetTensor(graph, tensor->GetId());
+    origin_inputs_.push_back(
+        {nullptr, vsi_tensor->attr.is_handle_malloc_by_ovxlib != 0});
+  }
+  for (const auto& tensor : outputs_) {
+    vsi_nn_tensor_t* vsi_tensor = vsi_nn_GetTensor(graph, tensor->GetId());
+    origin_outputs_.push_back(
+        {nullptr, vsi_tensor->attr.is_handle_malloc_by_ovxlib != 0});
+  }
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    if (!inputs_[i]->SwapHandle(slots_[0]->inputs[i], false,
+                                &origin_inputs_[i].ptr)) {
+      origin_inputs_.resize(i);
+      origin_outputs_.clear();
+      return false;
+    }
+  }
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    if (!outputs_[i]->SwapHandle(slots_[0]->outputs[i], false,
+                                 &origin_outputs_[i].ptr)) {
+      origin_outputs_.resize(i);
+      return false;
+    }
+  }
+
+  runner_ = std::thread(&StreamPipelineImpl::RunLoop, this);
+  return true;
+}
+
+void StreamPipelineImpl::Record(StageLatency& stage, Clock::time_point from,
+                                Clock::time_point to) {
+  uint64_t us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(to - from)
+          .count());
+  stage.count++;
+  stage.total_us += us;
+  stage.max_us = std::max(stage.max_us, us);
+}
+
+StreamPipeline::Frame* StreamPipelineImpl::AcquireInput() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto begin = Clock::now();
+  free_cv_.wait(lock, [this]() { return closed_ || !free_.empty(); });
+  if (closed_) {
+    return nullptr;
+  }
+  Slot* slot = free_.front();
+  free_.pop_front();
+  slot->acquired = Clock::now();
+  Record(stats_.producer_stall, begin, slot->acquired);
+  return slot;
+}
+
+bool StreamPipelineImpl::SubmitInput(Frame* frame) {
+  Slot* slot = static_cast<Slot*>(frame);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) {
+    free_.push_back(slot);
+    return false;
+  }
+  slot->submitted = Clock::now();
+  slot->sequence = next_sequence_++;
+  Record(stats_.fill, slot->acquired, slot->submitted);
+  ready_.push_back(slot);
+  ready_cv_.notify_one();
+  return true;
+}
+
+bool StreamPipelineImpl::Bind(Slot* slot) {
+  void* old_ptr = nullptr;
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    if (!inputs_[i]->SwapHandle(slot->inputs[i], false, &old_ptr) ||
+        !inputs_[i]->FlushCacheForHandle()) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    if (!outputs_[i]->SwapHandle(slot->outputs[i], false, &old_ptr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void StreamPipelineImpl::RunLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    ready_cv_.wait(lock, [this]() { return closed_ || !ready_.empty(); });
+    if (ready_.empty()) {
+      break;
+    }
+    Slot* slot = ready_.front();
+    ready_.pop_front();
+    slot->started = Clock::now();
+    Record(stats_.queue, slot->submitted, slot->started);
+    lock.unlock();
+
+    slot->status = Bind(slot) && graph_->Run();
+    for (auto& tensor : outputs_) {
+      slot->status = tensor->InvalidateCacheForHandle() && slot->status;
+    }
+    if (!slot->status) {
+      VSILOGE("Stream pipeline frame %" PRIu64 " run fail", slot->sequence);
+    }
+
+    lock.lock();
+    slot->finished = Clock::now();
+    Record(stats_.execute, slot->started, slot->finished);
+    done_.push_back(slot);
+    done_cv_.notify_one();
+  }
+  drained_ = true;
+  done_cv_.notify_all();
+}
+
+StreamPipeline::Frame* StreamPipelineImpl::AcquireOutput() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto begin = Clock::now();
+  done_cv_.wait(lock, [this]() { return drained_ || !done_.empty(); });
+  if (done_.empty()) {
+    return nullptr;
+  }
+  Slot* slot = done_.front();
+  done_.pop_front();
+  slot->consumed = Clock::now();
+  Record(stats_.consumer_stall, begin, slot->consumed);
+  Record(stats_.drain, slot->finished, slot->consumed);
+  return slot;
+}
+
+void StreamPipelineImpl::ReleaseOutput(Frame* frame) {
+  Slot* slot = static_cast<Slot*>(frame);
+  std::lock_guard<std::mutex> lock(mutex_);
+  Record(stats_.readback, slot->consumed, Clock::now());
+  free_.push_back(slot);
+  free_cv_.notify_one();
+}
+
+void StreamPipelineImpl::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+  free_cv_.notify_all();
+  ready_cv_.notify_all();
+}
+
+StreamPipeline::Stats StreamPipelineImpl::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace vx
+}  // namespace tim
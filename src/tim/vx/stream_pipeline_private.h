@@ -0,0 +1,107 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_STREAM_PIPELINE_PRIVATE_H_
+#define TIM_VX_STREAM_PIPELINE_PRIVATE_H_
+#include "tim/vx/stream_pipeline.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "tim/vx/tensor.h"
+
+namespace tim {
+namespace vx {
+
+class GraphImpl;
+
+class StreamPipelineImpl : public StreamPipeline {
+ public:
+  StreamPipelineImpl(const std::shared_ptr<Graph>& graph, size_t depth);
+  ~StreamPipelineImpl();
+
+  /// Allocate buffer sets and start the runner, false on failure
+  bool Init();
+
+  Frame* AcquireInput() override;
+  bool SubmitInput(Frame* frame) override;
+  Frame* AcquireOutput() override;
+  void ReleaseOutput(Frame* frame) override;
+  void Close() override;
+  Stats GetStats() const override;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Slot : public Frame {
+    Clock::time_point acquired;
+    Clock::time_point submitted;
+    Clock::time_point started;
+    Clock::time_point finished;
+    Clock::time_point consumed;
+  };
+
+  /// Handle bound to an IO tensor before the pipeline took it over
+  struct OriginHandle {
+    void* ptr{nullptr};
+    bool malloc_by_ovxlib{false};
+  };
+
+  void RunLoop();
+  /// Point the graph IO tensors at the buffers of slot
+  bool Bind(Slot* slot);
+  /// Size of the buffer backing tensor, 0 if it isn't created from handle
+  size_t HandleBytes(const std::shared_ptr<Tensor>& tensor) const;
+  static void Record(StageLatency& stage, Clock::time_point from,
+                     Clock::time_point to);
+
+  std::shared_ptr<Graph> graph_;
+  GraphImpl* graph_impl_;
+  size_t depth_;
+  std::vector<std::shared_ptr<Tensor>> inputs_;
+  std::vector<std::shared_ptr<Tensor>> outputs_;
+  std::vector<OriginHandle> origin_inputs_;
+  std::vector<OriginHandle> origin_outputs_;
+  std::vector<std::unique_ptr<Slot>> slots_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable free_cv_;
+  std::condition_variable ready_cv_;
+  std::condition_variable done_cv_;
+  std::deque<Slot*> free_;
+  std::deque<Slot*> ready_;
+  std::deque<Slot*> done_;
+  bool closed_{false};
+  bool drained_{false};
+  uint64_t next_sequence_{0};
+  Stats stats_;
+  std::thread runner_;
+};
+
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_STREAM_PIPELINE_PRIVATE_H_ */
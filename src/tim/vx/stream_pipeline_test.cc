@@ -0,0 +1,97 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tim/vx/stream_pipeline.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "tim/vx/ops.h"
+
+#if (ENABLE_TENSOR_HNDL)
+TEST(stream_pipeline, double_buffered_relu) {
+  auto ctx = tim::vx::Context::Create();
+  auto graph = ctx->CreateGraph();
+
+  tim::vx::ShapeType io_shape({4, 4});
+  tim::vx::TensorSpec input_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                 tim::vx::TensorAttribute::INPUT);
+  tim::vx::TensorSpec output_spec(tim::vx::DataType::FLOAT32, io_shape,
+                                  tim::vx::TensorAttribute::OUTPUT);
+  auto input_t = graph->CreateIOTensor(input_spec);
+  auto output_t = graph->CreateIOTensor(output_spec);
+  graph->CreateOperation<tim::vx::ops::Relu>()->BindInput(input_t).BindOutput(
+      output_t);
+
+  auto pipeline = tim::vx::StreamPipeline::Create(graph, 2);
+  ASSERT_TRUE(pipeline);
+
+  const size_t num = 16;
+  const uint64_t frames = 8;
+  // frame f feeds i - f, relu keeps the non negative part. The producer
+  // always closes the pipeline so the consumer loop below ends, failures are
+  // asserted once it is joined
+  bool producer_ok = true;
+  std::thread producer([&]() {
+    for (uint64_t f = 0; f < frames; ++f) {
+      auto frame = pipeline->AcquireInput();
+      if (!frame || frame->input_bytes[0] < num * sizeof(float)) {
+        producer_ok = false;
+        break;
+      }
+      float* data = static_cast<float*>(frame->inputs[0]);
+      for (size_t i = 0; i < num; ++i) {
+        data[i] = static_cast<float>(i) - f;
+      }
+      EXPECT_TRUE(pipeline->SubmitInput(frame));
+    }
+    pipeline->Close();
+  });
+
+  uint64_t consumed = 0;
+  while (auto frame = pipeline->AcquireOutput()) {
+    EXPECT_TRUE(frame->status);
+    EXPECT_EQ(frame->sequence, consumed);
+    const float* data = static_cast<const float*>(frame->outputs[0]);
+    for (size_t i = 0; i < num; ++i) {
+      float in = static_cast<float>(i) - frame->sequence;
+      EXPECT_EQ(data[i], in > 0 ? in : 0.0f);
+    }
+    pipeline->ReleaseOutput(frame);
+    consumed++;
+  }
+  producer.join();
+  ASSERT_TRUE(producer_ok);
+  EXPECT_EQ(consumed, frames);
+
+  auto stats = pipeline->GetStats();
+  EXPECT_EQ(stats.fill.count, frames);
+  EXPECT_EQ(stats.execute.count, frames);
+  EXPECT_EQ(stats.readback.count, frames);
+  EXPECT_EQ(pipeline->AcquireInput(), nullptr);
+}
+#endif
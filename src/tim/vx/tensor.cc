@@ -136,6 +136,39 @@ TensorImpl::TensorImpl(Graph* graph, const TensorSpec& spec, void* data)
   data_ = data;
 }
 
+TensorImpl::TensorImpl(Graph* graph, const TensorSpec& spec,
+                       const BorrowedBufferDesc& buffer)
+    : graph_(reinterpret_cast<GraphImpl*>(graph)),
+      id_(VSI_NN_TENSOR_ID_NA),
+      spec_(spec),
+      data_(nullptr) {
+  auto release = buffer.release;
+  std::shared_ptr<const void> borrowed(
+      buffer.data, [release](const void* p) {
+        if (release) release(p);
+      });
+  if (!(spec_.attr_ & TensorAttribute::CONSTANT) || !buffer.data) {
+    VSILOGE("TensorImpl with a borrowed buffer got unexpected attr or data");
+    return;
+  }
+  uint8_t* ptr = static_cast<uint8_t*>(const_cast<void*>(buffer.data));
+  if (!vsi_nn_IsBufferAligned(
+          ptr, graph_->graph()->handle_manager.align_start_size)) {
+    VSILOGW("Borrowed buffer is misaligned, copy it into the tensor");
+    // borrowed_ stays empty so Init allocates the tensor and copies data_,
+    // the local handle gives the buffer back once Init has returned
+    data_ = ptr;
+    Init();
+    data_ = nullptr;
+    return;
+  }
+  borrowed_ = std::move(borrowed);
+  if (Init()) {
+    graph_->RetainBorrowedBuffer(borrowed_);
+  }
+  data_ = ptr;
+}
+
 TensorImpl::~TensorImpl() {}
 
 bool TensorImpl::SaveTensorToTextByFp32(std::string filename) {
@@ -156,6 +189,10 @@ bool TensorImpl::CopyDataToTensor(const void* data, uint32_t size_in_bytes) {
   if (!IsWriteable()) {
     return false;
   }
+  if (borrowed_) {
+    VSILOGE("Can't write a tensor backed by a borrowed buffer");
+    return false;
+  }
 
   bool retn = true;
   if (data && VSI_NN_TENSOR_ID_NA != id_) {
@@ -177,14 +214,12 @@ bool TensorImpl::CopyDataToTensor(const void* data, uint32_t size_in_bytes) {
         }
       } else {
         /*
-        argument `data` of vsi_nn_CopyDataToTensor is non-const
-        convert it from const data to non-const, will be fixed in ovxlib
+        argument `data` of vsi_nn_CopyDataToTensor is non-const but it's
+        only read, pass it through instead of staging another copy of it
         */
-        const uint8_t* end = static_cast<const uint8_t*>(data) + tensor_bytes;
-        std::vector<uint8_t> data_copy(static_cast<const uint8_t*>(data), end);
-
-        retn = (VSI_SUCCESS == vsi_nn_CopyDataToTensor(graph_->graph(), tensor,
-                                                       data_copy.data()));
+        retn = (VSI_SUCCESS ==
+                vsi_nn_CopyDataToTensor(graph_->graph(), tensor,
+                                        const_cast<void*>(data)));
       }
     }
   }
@@ -388,7 +423,7 @@ void TensorImpl::unmap() {
   // TODO: unmap fd_
 }
 
-bool TensorImpl::Init(void* external_cache) {
+bool TensorImpl::Init(void* external_cache, vsi_nn_tensor_id_t id) {
   vsi_nn_tensor_attr_t attr;
 
 #if (!ENABLE_TENSOR_HNDL)
@@ -422,14 +457,14 @@ bool TensorImpl::Init(void* external_cache) {
 
     id_ = vsi_nn_AddTensorFromHandle(
         graph_->graph(),
-        VSI_NN_TENSOR_ID_AUTO,  // DMABUF's fd is created by TensorFromHandle as input or output,
+        id,  // DMABUF's fd is created by TensorFromHandle as input or output,
         &attr,
         fd_ != -1 ? (uint8_t*)fd_
                   : (uint8_t*)external_cache);  // and cannot be set to const
 #else
     if (-1 == fd_) {
-      id_ = vsi_nn_AddTensorFromHandle(graph_->graph(), VSI_NN_TENSOR_ID_AUTO,
-                                       &attr, (uint8_t*)external_cache);
+      id_ = vsi_nn_AddTensorFromHandle(graph_->graph(), id, &attr,
+                                       (uint8_t*)external_cache);
     } else {
       id_ = 0xFFFFFFFF;
       VSILOGE("Create tensor fail: low-level driver doesn't support dmabuffer");
@@ -438,9 +473,13 @@ bool TensorImpl::Init(void* external_cache) {
 
   } else
 #endif
-  {
-    id_ = vsi_nn_AddTensor(graph_->graph(), VSI_NN_TENSOR_ID_AUTO, &attr,
-                           nullptr);
+  if (borrowed_) {
+    // Wrap the caller's memory, ovxlib neither copies nor frees it
+    id_ = vsi_nn_AddTensorFromHandle(
+        graph_->graph(), id, &attr,
+        static_cast<uint8_t*>(const_cast<void*>(borrowed_.get())));
+  } else {
+    id_ = vsi_nn_AddTensor(graph_->graph(), id, &attr, nullptr);
   }
 
   if (VSI_NN_TENSOR_ID_NA == id_) {
@@ -458,6 +497,17 @@ bool TensorImpl::Init(void* external_cache) {
   return true;
 }
 
+bool TensorImpl::Rebind() {
+  // Keep data_ out of Init, it only holds external IO memory at this point
+  void* external_cache = data_;
+  vsi_nn_tensor_id_t id = id_;
+  data_ = nullptr;
+  bool retn = Init(external_cache, id) && id == id_;
+  data_ = external_cache;
+  id_ = id;
+  return retn;
+}
+
 uint32_t TensorImpl::GetId() { return id_; }
 
 bool TensorImpl::IsWriteable() {
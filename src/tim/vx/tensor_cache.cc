@@ -0,0 +1,99 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tensor_cache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "type_utils.h"
+#include "vsi_nn_pub.h"
+
+namespace tim {
+namespace vx {
+
+namespace {
+// Sweep expired entries after this many inserts
+constexpr size_t kPruneInterval = 256;
+}  // namespace
+
+uint64_t ConstantTensorCache::NewScope() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return next_scope_++;
+}
+
+size_t ConstantTensorCache::DataBytes(const TensorSpec& spec) {
+  // Same size ovxlib copies in and out, 4-bit types pack two per byte
+  std::vector<vsi_size_t> shape(spec.shape_.begin(), spec.shape_.end());
+  return vsi_nn_GetTensorSize(shape.data(), shape.size(),
+                              TranslateDataType(spec.datatype_));
+}
+
+std::shared_ptr<Tensor> ConstantTensorCache::Lookup(uint64_t scope,
+                                                    const TensorSpec& spec,
+                                                    const void* data,
+                                                    size_t bytes,
+                                                    uint64_t hash) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto range = entries_.equal_range(hash);
+  for (auto it = range.first; it != range.second;) {
+    auto tensor = it->second.tensor.lock();
+    if (!tensor) {
+      it = entries_.erase(it);
+      continue;
+    }
+    if (it->second.scope == scope && tensor->GetSpec() == spec) {
+      // Equal hashes are not proof, compare with what the tensor holds
+      std::unique_ptr<uint8_t[]> cached(new uint8_t[bytes]);
+      if (tensor->CopyDataFromTensor(cached.get()) &&
+          0 == memcmp(cached.get(), data, bytes)) {
+        return tensor;
+      }
+    }
+    ++it;
+  }
+  return nullptr;
+}
+
+void ConstantTensorCache::Insert(uint64_t scope, uint64_t hash,
+                                 const std::shared_ptr<Tensor>& tensor) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.emplace(hash, Entry{scope, tensor});
+  if (++inserts_since_prune_ >= kPruneInterval) {
+    Prune();
+  }
+}
+
+void ConstantTensorCache::Prune() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.tensor.expired()) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  inserts_since_prune_ = 0;
+}
+
+}  // namespace vx
+}  // namespace tim
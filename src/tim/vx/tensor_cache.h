@@ -0,0 +1,75 @@
+/****************************************************************************
+*
+*    Copyright (c) 2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#ifndef TIM_VX_TENSOR_CACHE_H_
+#define TIM_VX_TENSOR_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "tim/vx/tensor.h"
+
+namespace tim {
+namespace vx {
+
+/// Content addressed store of constant tensors, owned by a context.
+/// Tensors are keyed by a hash over their full contents and verified byte
+/// by byte on a hit, so equal hashes never alias different weights.
+/// A low-level tensor belongs to a single graph, lookups only return
+/// tensors created in the graph identified by `scope`.
+class ConstantTensorCache {
+ public:
+  /// Unique scope id for a new graph
+  uint64_t NewScope();
+
+  /// Return the cached tensor of scope equal to spec/data, or nullptr.
+  std::shared_ptr<Tensor> Lookup(uint64_t scope, const TensorSpec& spec,
+                                 const void* data, size_t bytes,
+                                 uint64_t hash);
+  void Insert(uint64_t scope, uint64_t hash,
+              const std::shared_ptr<Tensor>& tensor);
+
+  /// Byte size of the data of a tensor with spec
+  static size_t DataBytes(const TensorSpec& spec);
+
+ private:
+  struct Entry {
+    uint64_t scope;
+    std::weak_ptr<Tensor> tensor;
+  };
+  /// Drop entries whose tensor is gone, caller holds mutex_
+  void Prune();
+
+  std::mutex mutex_;
+  uint64_t next_scope_{0};
+  size_t inserts_since_prune_{0};
+  std::unordered_multimap<uint64_t, Entry> entries_;
+};
+
+}  // namespace vx
+}  // namespace tim
+
+#endif /* TIM_VX_TENSOR_CACHE_H_ */
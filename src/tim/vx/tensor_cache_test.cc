@@ -0,0 +1,73 @@
+/****************************************************************************
+*
+*    Copyright (c) 2020-2023 Vivante Corporation
+*
+*    Permission is hereby granted, free of charge, to any person obtaining a
+*    copy of this software and associated documentation files (the "Software"),
+*    to deal in the Software without restriction, including without limitation
+*    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*    and/or sell copies of the Software, and to permit persons to whom the
+*    Software is furnished to do so, subject to the following conditions:
+*
+*    The above copyright notice and this permission notice shall be included in
+*    all copies or substantial portions of the Software.
+*
+*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+*    DEALINGS IN THE SOFTWARE.
+*
+*****************************************************************************/
+#include "tensor_cache.h"
+
+#include <vector>
+
+#include "hash_utils.h"
+#include "tim/vx/context.h"
+#include "tim/vx/graph.h"
+#include "gtest/gtest.h"
+
+TEST(ConstantTensorCache, data_bytes) {
+    using tim::vx::ConstantTensorCache;
+    tim::vx::TensorSpec f32_spec(tim::vx::DataType::FLOAT32, {3, 2},
+                                 tim::vx::TensorAttribute::CONSTANT);
+    EXPECT_EQ(ConstantTensorCache::DataBytes(f32_spec), 24u);
+    // 4-bit rows are packed and padded to whole bytes
+    tim::vx::TensorSpec int4_spec(tim::vx::DataType::INT4, {3, 2},
+                                  tim::vx::TensorAttribute::CONSTANT);
+    EXPECT_EQ(ConstantTensorCache::DataBytes(int4_spec), 4u);
+    tim::vx::TensorSpec uint4_spec(tim::vx::DataType::UINT4, {4, 2},
+                                   tim::vx::TensorAttribute::CONSTANT);
+    EXPECT_EQ(ConstantTensorCache::DataBytes(uint4_spec), 4u);
+}
+
+TEST(ConstantTensorCache, int4_lookup_compares_contents) {
+    auto ctx = tim::vx::Context::Create();
+    auto graph = ctx->CreateGraph();
+    tim::vx::Quantization quant(tim::vx::QuantType::ASYMMETRIC, 1.0f, 0);
+    tim::vx::TensorSpec spec(tim::vx::DataType::INT4, {4, 2},
+                             tim::vx::TensorAttribute::CONSTANT, quant);
+    std::vector<uint8_t> data0 = {0x12, 0x34, 0x56, 0x07};
+    std::vector<uint8_t> data1 = {0x12, 0x34, 0x56, 0x01};
+    size_t bytes = tim::vx::ConstantTensorCache::DataBytes(spec);
+    ASSERT_EQ(bytes, data0.size());
+
+    tim::vx::ConstantTensorCache cache;
+    uint64_t scope = cache.NewScope();
+    uint64_t hash0 = tim::vx::HashBytes(data0.data(), bytes);
+    uint64_t hash1 = tim::vx::HashBytes(data1.data(), bytes);
+    EXPECT_NE(hash0, hash1);
+    auto t0 = graph->CreateTensor(spec, data0.data());
+    cache.Insert(scope, hash0, t0);
+
+    EXPECT_EQ(cache.Lookup(scope, spec, data0.data(), bytes, hash0), t0);
+    EXPECT_EQ(cache.Lookup(scope, spec, data1.data(), bytes, hash1), nullptr);
+    // A colliding hash is still told apart by the contents
+    EXPECT_EQ(cache.Lookup(scope, spec, data1.data(), bytes, hash0), nullptr);
+    // Tensors of another graph are never handed out
+    EXPECT_EQ(cache.Lookup(cache.NewScope(), spec, data0.data(), bytes, hash0),
+              nullptr);
+}
@@ -35,9 +35,14 @@ class TensorImpl : public Tensor {
   TensorImpl(Graph* graph, const TensorSpec& spec, const void* data = nullptr);
   TensorImpl(Graph* graph, const TensorSpec& spec, const DmaBufferDesc& dmafd);
   TensorImpl(Graph* graph, const TensorSpec& spec, void* data = nullptr);
+  TensorImpl(Graph* graph, const TensorSpec& spec,
+             const BorrowedBufferDesc& buffer);
   ~TensorImpl();
 
-  bool Init(void* external_cache = nullptr);
+  bool Init(void* external_cache = nullptr,
+            vsi_nn_tensor_id_t id = VSI_NN_TENSOR_ID_AUTO);
+  /// Re-create this tensor under the same id in the current low-level graph
+  bool Rebind();
   bool IsWriteable();
   bool IsReadable();
 
@@ -73,6 +78,8 @@ class TensorImpl : public Tensor {
   TensorSpec spec_;
   void* data_;
   int64_t fd_{-1};
+  /// Caller's memory a constant tensor references, see BorrowedBufferDesc
+  std::shared_ptr<const void> borrowed_;
 };
 
 class TensorPlaceholder : public Tensor {